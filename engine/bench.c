@@ -0,0 +1,486 @@
+// A native benchmark of the engine's rendering and flush paths, drawing into a
+// headless framebuffer. `python3 build.py bench [options]` builds it for the
+// host as `built/bench` and runs it.
+//
+// Each scenario is run several times, and the fastest run is reported, as:
+//   ms/run: the wall time of the run, less any time spent waiting for the
+//     SlowBuffer's delayed pixels to become due.
+//   ns/pixel: the time per pixel of the display updates it requested.
+//   updates/s: the display update requests per second of that time.
+//   allocs/run: the calls to malloc, calloc and realloc (including Lua's).
+// Every scenario must request some display update, or the benchmark fails.
+//
+// `--save <file>` records the results as a baseline, which a later run with
+// `--compare <file>` reports the change in ms/run against, flagging each
+// metric which got worse.
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "clock.h"
+#include "font.h"
+#include "fractal.h"
+#include "framebuffer.h"
+#include "input.h"
+#include "interpreter.h"
+#include "raster.h"
+#include "slowbuffer.h"
+#include "stroke.h"
+#include "touch.h"
+
+// A change in ms/run or updates/s of more than this fraction, for the worse,
+// is flagged as a regression when comparing with a baseline.
+#define REGRESSION_THRESHOLD 0.05
+
+// The build links with `-Wl,--wrap=malloc` (and likewise for calloc and
+// realloc), so every allocation in the engine and in Lua is counted.
+static size_t s_allocations = 0;
+
+void *__real_malloc(size_t bytes);
+void *__real_calloc(size_t count, size_t bytes);
+void *__real_realloc(void *p, size_t bytes);
+
+void *__wrap_malloc(size_t bytes)
+{
+	__atomic_fetch_add(&s_allocations, 1, __ATOMIC_RELAXED);
+	return __real_malloc(bytes);
+}
+
+void *__wrap_calloc(size_t count, size_t bytes)
+{
+	__atomic_fetch_add(&s_allocations, 1, __ATOMIC_RELAXED);
+	return __real_calloc(count, bytes);
+}
+
+void *__wrap_realloc(void *p, size_t bytes)
+{
+	__atomic_fetch_add(&s_allocations, 1, __ATOMIC_RELAXED);
+	return __real_realloc(p, bytes);
+}
+
+typedef struct
+{
+	FrameBuffer *fb;
+	SlowBuffer *sb;
+	Font *font;
+
+	// The directory containing the Lua apps and library.
+	char const *luaapps;
+
+	// The time spent waiting for delayed pixels, which isn't counted.
+	double waitedSeconds;
+} Bench;
+
+typedef struct
+{
+	char const *name;
+	void (*run)(Bench *bench);
+} Scenario;
+
+typedef struct
+{
+	double seconds;
+	size_t updates;
+	size_t pixels;
+	size_t allocations;
+} Result;
+
+/// Clears the whole screen to alternating colors, flushing each clear.
+static void Bench_clear(Bench *bench)
+{
+	Rectangle screen = FrameBuffer_size(bench->fb);
+	for (int i = 0; i < 8; i++)
+	{
+		FrameBuffer_setRect(bench->fb, screen, i % 2 == 0 ? 0 : 0xffff);
+		FrameBuffer_flush(bench->fb, screen, 1);
+	}
+}
+
+/// Sleeps for `seconds`, which aren't counted.
+static void Bench_wait(Bench *bench, double seconds)
+{
+	Clock clock = Clock_monotonic();
+	double began = Clock_getSeconds(&clock);
+	struct timespec delay = {(time_t)seconds, (long)((seconds - (time_t)seconds) * 1.0e9)};
+	nanosleep(&delay, NULL);
+	bench->waitedSeconds += Clock_getSeconds(&clock) - began;
+}
+
+/// Waits until the SlowBuffer's delayed pixels are due, and flushes them,
+/// until none are delayed.
+static void Bench_commitDelayed(Bench *bench)
+{
+	double seconds;
+	while ((seconds = SlowBuffer_secondsUntilNext(bench->sb)) >= 0)
+	{
+		Bench_wait(bench, seconds);
+		SlowBuffer_ping(bench->sb);
+	}
+}
+
+/// Clears the whole SlowBuffer to alternating colors, flushing each clear, so
+/// that `SlowBuffer_tryflush` diffs every tile. The clear is delayed, having
+/// come within a pulse of the previous one, and is then committed.
+static void Bench_slowClear(Bench *bench)
+{
+	Rectangle screen = SlowBuffer_size(bench->sb);
+	for (int i = 0; i < 8; i++)
+	{
+		SlowBuffer_setRect(bench->sb, screen, i % 2 == 0 ? 0 : 31);
+		SlowBuffer_flush(bench->sb, screen);
+		Bench_commitDelayed(bench);
+	}
+}
+
+/// Clears the whole SlowBuffer to alternating colors, waiting out the pulse
+/// before flushing each clear so that every pixel is committed at once.
+static void Bench_slowCommit(Bench *bench)
+{
+	Rectangle screen = SlowBuffer_size(bench->sb);
+	for (int i = 0; i < 8; i++)
+	{
+		SlowBuffer_setRect(bench->sb, screen, i % 2 == 0 ? 0 : 31);
+		Bench_wait(bench, MIN_PULSE_SECONDS + 0.01);
+		SlowBuffer_flush(bench->sb, screen);
+	}
+}
+
+/// Draws a long looping pen stroke with varying pressure, flushing every few
+/// samples as the interpreter's `rm_fb:stroke` batches would.
+static void Bench_stroke(Bench *bench)
+{
+	Rectangle screen = FrameBuffer_size(bench->fb);
+	FrameBuffer_setRect(bench->fb, screen, 0xffff);
+
+	Brush brush = {1, 3, 0.5};
+	StrokePoint previous = {0, 0, 0};
+	Rectangle dirty = {0, 0, 0, 0};
+	for (int i = 0; i < 4000; i++)
+	{
+		double t = i / 4000.0;
+		double x = screen.width * (0.5 + 0.4 * sin(2 * M_PI * 3 * t) * cos(2 * M_PI * t));
+		double y = screen.height * (0.5 + 0.4 * sin(2 * M_PI * 2 * t));
+		StrokePoint point = {x, y, Brush_radius(brush, 0.5 + 0.5 * sin(40 * t), 0.2)};
+		Stroke_segment(Raster_frameBuffer(bench->fb), i == 0 ? point : previous, point, 0, &dirty);
+		previous = point;
+
+		if (i % 8 == 7 && dirty.width != 0)
+		{
+			FrameBuffer_flush(bench->fb, dirty, 1);
+			dirty = (Rectangle){0, 0, 0, 0};
+		}
+	}
+}
+
+/// Fills the screen with lines of text and flushes it as one page.
+static void Bench_text(Bench *bench)
+{
+	static char const line[] = "The quick brown fox jumps over the lazy dog; "
+							   "PACK MY BOX WITH FIVE DOZEN LIQUOR JUGS (0123456789).";
+
+	Rectangle screen = FrameBuffer_size(bench->fb);
+	FrameBuffer_setRect(bench->fb, screen, 0xffff);
+
+	Rectangle dirty = {0, 0, 0, 0};
+	Raster raster = Raster_frameBuffer(bench->fb);
+	for (long y = 24; y < (long)screen.height; y += 20)
+	{
+		for (long x = 8; x < (long)screen.width;)
+		{
+			x += Font_draw(bench->font, raster, x, y, line, sizeof(line) - 1, 0, &dirty);
+		}
+	}
+	FrameBuffer_flush(bench->fb, screen, 1);
+}
+
+/// Renders the Mandelbrot set natively, refining from 32x32 squares down to
+/// single pixels, in 16 grays.
+static void Bench_fractal(Bench *bench)
+{
+	Rectangle screen = FrameBuffer_size(bench->fb);
+	uint16_t palette[16];
+	for (int i = 0; i < 16; i++)
+	{
+		uint16_t r = (uint16_t)((i * 31 + 7) / 15);
+		uint16_t g = (uint16_t)((i * 63 + 7) / 15);
+		palette[i] = (uint16_t)(r << 11 | g << 5 | r);
+	}
+
+	FractalView view = {-0.5, 0, 3.0 / screen.width, 256};
+	for (size_t cell = 32; cell >= 1; cell /= 2)
+	{
+		Rectangle dirty = {0, 0, 0, 0};
+		Fractal_render(Raster_frameBuffer(bench->fb), screen, &view, cell, palette, 16, &dirty);
+		FrameBuffer_flush(bench->fb, dirty, 2);
+	}
+}
+
+/// Runs the Lua script at `path` (within the Lua apps directory).
+static void Bench_script(Bench *bench, char const *path)
+{
+	char script[1024];
+	snprintf(script, sizeof(script), "%s/%s", bench->luaapps, path);
+
+	// The scripts have no pen input.
+	PenInput penInput;
+	if (PenInput_initReplay(&penInput, "/dev/null", 0))
+	{
+		return;
+	}
+	TouchInput touchInput;
+	TouchInput_init(&touchInput, NULL);
+	run_script(script, &penInput, &touchInput, bench->fb, bench->sb);
+	PenInput_free(&penInput);
+}
+
+static void Bench_mandel(Bench *bench)
+{
+	Bench_script(bench, "mandel.lua");
+}
+
+/// Drags faster than the SlowBuffer's pulse, so most of each render is
+/// delayed, and then commits the final sketch.
+static void Bench_cadDrag(Bench *bench)
+{
+	Bench_script(bench, "bench/caddrag.lua");
+	Bench_commitDelayed(bench);
+}
+
+static Scenario const s_scenarios[] = {
+	{"clear", Bench_clear},
+	{"sb-clear", Bench_slowClear},
+	{"sb-commit", Bench_slowCommit},
+	{"stroke", Bench_stroke},
+	{"text", Bench_text},
+	{"fractal", Bench_fractal},
+	{"mandel", Bench_mandel},
+	{"cad-drag", Bench_cadDrag},
+};
+
+#define SCENARIO_COUNT (sizeof(s_scenarios) / sizeof(s_scenarios[0]))
+
+/// RETURNS the fastest of `repeats` runs of the scenario.
+static Result Bench_measure(Bench *bench, Scenario const *scenario, int repeats)
+{
+	Clock clock = Clock_monotonic();
+	Result best = {-1, 0, 0, 0};
+	for (int i = 0; i < repeats; i++)
+	{
+		size_t updates = FrameBuffer_updateCount(bench->fb);
+		size_t pixels = FrameBuffer_updatePixels(bench->fb);
+		size_t allocations = __atomic_load_n(&s_allocations, __ATOMIC_RELAXED);
+		bench->waitedSeconds = 0;
+		double began = Clock_getSeconds(&clock);
+
+		scenario->run(bench);
+
+		Result result = {
+			Clock_getSeconds(&clock) - began - bench->waitedSeconds,
+			FrameBuffer_updateCount(bench->fb) - updates,
+			FrameBuffer_updatePixels(bench->fb) - pixels,
+			__atomic_load_n(&s_allocations, __ATOMIC_RELAXED) - allocations,
+		};
+		if (best.seconds < 0 || result.seconds < best.seconds)
+		{
+			best = result;
+		}
+	}
+	return best;
+}
+
+/// Finds the baseline's result for the scenario `name`.
+/// RETURNS `false` if the baseline has no result for it.
+static bool Bench_baseline(FILE *baseline, char const *name, Result *saved)
+{
+	if (baseline == NULL)
+	{
+		return false;
+	}
+
+	rewind(baseline);
+	char savedName[64];
+	double milliseconds;
+	size_t updates, pixels, allocations;
+	while (fscanf(baseline, "%63s %lf %zu %zu %zu", savedName, &milliseconds, &updates, &pixels, &allocations) == 5)
+	{
+		if (strcmp(savedName, name) == 0)
+		{
+			*saved = (Result){milliseconds * 1.0e-3, updates, pixels, allocations};
+			return true;
+		}
+	}
+	return false;
+}
+
+/// Appends `metric` to the list of regressions when `worse` holds.
+static void Bench_flag(char *regressions, size_t size, bool worse, char const *metric)
+{
+	if (worse)
+	{
+		size_t length = strlen(regressions);
+		snprintf(regressions + length, size - length, "%s%s", length == 0 ? "" : ", ", metric);
+	}
+}
+
+static void usage(void)
+{
+	fprintf(stderr, "usage: bench [options] [scenario...]\n");
+	fprintf(stderr, "\t--repeats <n>       run each scenario n times and report the fastest (default 5)\n");
+	fprintf(stderr, "\t--luaapps <dir>     the directory of the Lua apps (default ../luaapps)\n");
+	fprintf(stderr, "\t--save <file>       record the results as a baseline\n");
+	fprintf(stderr, "\t--compare <file>    report the change in ms/run against a saved baseline, and any regressions\n");
+	fprintf(stderr, "scenarios:");
+	for (size_t i = 0; i < SCENARIO_COUNT; i++)
+	{
+		fprintf(stderr, " %s", s_scenarios[i].name);
+	}
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char **argv)
+{
+	int repeats = 5;
+	char const *luaapps = "../luaapps";
+	char const *savePath = NULL;
+	char const *comparePath = NULL;
+	bool selected[SCENARIO_COUNT] = {false};
+	bool anySelected = false;
+
+	for (int i = 1; i < argc; i++)
+	{
+		char const *arg = argv[i];
+		int hasValue = i + 1 < argc;
+		if (strcmp(arg, "--repeats") == 0 && hasValue)
+		{
+			repeats = atoi(argv[++i]);
+		}
+		else if (strcmp(arg, "--luaapps") == 0 && hasValue)
+		{
+			luaapps = argv[++i];
+		}
+		else if (strcmp(arg, "--save") == 0 && hasValue)
+		{
+			savePath = argv[++i];
+		}
+		else if (strcmp(arg, "--compare") == 0 && hasValue)
+		{
+			comparePath = argv[++i];
+		}
+		else
+		{
+			size_t s = 0;
+			while (s < SCENARIO_COUNT && strcmp(arg, s_scenarios[s].name) != 0)
+			{
+				s++;
+			}
+			if (s == SCENARIO_COUNT)
+			{
+				usage();
+				return 1;
+			}
+			selected[s] = true;
+			anySelected = true;
+		}
+	}
+	if (repeats < 1)
+	{
+		usage();
+		return 1;
+	}
+
+	FILE *baseline = NULL;
+	if (comparePath != NULL && (baseline = fopen(comparePath, "r")) == NULL)
+	{
+		fprintf(stderr, "bench: could not open `%s`.\n", comparePath);
+		return 1;
+	}
+
+	// Run Lua scripts with the library on their path, as on the device.
+	char luaPath[1024];
+	snprintf(luaPath, sizeof(luaPath), "%s/?.lua;;", luaapps);
+	setenv("LUA_PATH", luaPath, 1);
+
+	char fontPath[1024];
+	snprintf(fontPath, sizeof(fontPath), "%s/library/fonts/cmu16.rmf", luaapps);
+
+	// The reMarkable 2's display.
+	Bench bench;
+	bench.fb = FrameBuffer_allocateFile(NULL, 1404, 1872);
+	bench.sb = bench.fb == NULL ? NULL : SlowBuffer_allocate(bench.fb);
+	bench.font = Font_load(fontPath);
+	bench.luaapps = luaapps;
+	bench.waitedSeconds = 0;
+	if (bench.sb == NULL || bench.font == NULL)
+	{
+		return 1;
+	}
+
+	printf("%-10s %10s %10s %10s %10s %12s\n", "scenario", "ms/run", "ns/pixel", "updates/s", "allocs/run", "vs baseline");
+	FILE *save = NULL;
+	bool idle = false;
+	for (size_t s = 0; s < SCENARIO_COUNT; s++)
+	{
+		if (anySelected && !selected[s])
+		{
+			continue;
+		}
+
+		Scenario const *scenario = &s_scenarios[s];
+		Result result = Bench_measure(&bench, scenario, repeats);
+		double milliseconds = result.seconds * 1.0e3;
+
+		char perPixel[32] = "-";
+		if (result.pixels != 0)
+		{
+			snprintf(perPixel, sizeof(perPixel), "%.3f", result.seconds * 1.0e9 / result.pixels);
+		}
+
+		char change[32] = "-";
+		char regressions[64] = "";
+		Result saved;
+		if (Bench_baseline(baseline, scenario->name, &saved) && saved.seconds > 0)
+		{
+			snprintf(change, sizeof(change), "%+.1f%%", 100 * (result.seconds - saved.seconds) / saved.seconds);
+			Bench_flag(regressions, sizeof(regressions), result.seconds > saved.seconds * (1 + REGRESSION_THRESHOLD), "ms/run");
+			Bench_flag(regressions, sizeof(regressions), result.updates / result.seconds < saved.updates / saved.seconds * (1 - REGRESSION_THRESHOLD), "updates/s");
+			Bench_flag(regressions, sizeof(regressions), result.allocations > saved.allocations, "allocs/run");
+		}
+
+		printf("%-10s %10.3f %10s %10.1f %10zu %12s%s%s\n",
+			   scenario->name, milliseconds, perPixel,
+			   result.updates / result.seconds, result.allocations, change,
+			   regressions[0] != '\0' ? "  worse: " : "", regressions);
+		fflush(stdout);
+
+		if (result.updates == 0)
+		{
+			fprintf(stderr, "bench: `%s` requested no display updates.\n", scenario->name);
+			idle = true;
+		}
+
+		if (savePath != NULL)
+		{
+			if (save == NULL && (save = fopen(savePath, "w")) == NULL)
+			{
+				fprintf(stderr, "bench: could not write `%s`.\n", savePath);
+				return 1;
+			}
+			fprintf(save, "%s %.6f %zu %zu %zu\n", scenario->name, milliseconds, result.updates, result.pixels, result.allocations);
+		}
+	}
+
+	if (save != NULL)
+	{
+		fclose(save);
+	}
+	if (baseline != NULL)
+	{
+		fclose(baseline);
+	}
+	return idle ? 1 : 0;
+}
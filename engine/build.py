@@ -1,6 +1,7 @@
 import glob
 import os
 import subprocess
+import sys
 
 # N.B.:
 # In case your cross compiler's shared libraries differ slightly from the
@@ -12,39 +13,89 @@ CC = "arm-linux-gnueabihf-gcc"
 AR = "arm-linux-gnueabihf-ar"
 LUA_SRC = "../../lua-5.3.6/src"
 
+# The compiler for benchmarks, which run on this machine.
+HOST_CC = "cc"
+HOST_AR = "ar"
+
 LUA_MAINS = set(["lua.c", "luac.c"])
 source_files = [
     "framebuffer.c",
+    "region.c",
     "input.c",
     "main.c",
     "interpreter.c",
     "clock.c",
     "slowbuffer.c",
+    "flushscheduler.c",
+    "eventloop.c",
+    "raster.c",
+    "stroke.c",
+    "draw.c",
+    "font.c",
+    "surface.c",
+    "scene.c",
+    "profile.c",
+    "tiles.c",
+    "fractal.c",
+    "zygote.c",
+    "chunkcache.c",
+    "collector.c",
+    "touch.c",
+    "provisional.c",
 ]
 intermediates = ["built/luas/all.a"]
-libraries = ["dl", "rt"]
+libraries = ["dl", "rt", "pthread"]
 exe = "built/engine"
+bench_exe = "built/bench"
 
 ################################################################################
 
-# Build Lua 5.3.6.
+def build_lua(cc, ar, directory):
+    """Builds Lua 5.3.6 into the static library `directory/all.a`."""
+    library = directory + "/all.a"
+    if not os.path.exists(library):
+        os.makedirs(directory, exist_ok=True)
+        for c_path in glob.glob(LUA_SRC + "/*.c"):
+            c_directory, c_file = os.path.split(c_path)
+            target = directory + "/" + c_file + ".o"
+            if c_file not in LUA_MAINS and not os.path.exists(target):
+                subprocess.run([cc]
+                               + ["-Wall", "-Wextra",  "-O3"]
+                               + ["-c", c_path]
+                               + ["-o", target]
+                               + ["-lm"])
+        subprocess.run([ar, "rcs"]
+                       + [library]
+                       + glob.glob(directory + "/*.o"))
+    return library
+
+
+# `python3 build.py bench [options]` instead builds the benchmarks (bench.c)
+# for this machine, against a headless framebuffer, and runs them with the
+# given options.
+if sys.argv[1:2] == ["bench"]:
+    bench_command = ([HOST_CC]
+                     + ["-O3"]
+                     + ["-o", bench_exe]
+                     + ["-I" + LUA_SRC]
+                     + [f for f in source_files if f != "main.c"]
+                     + ["bench.c"]
+                     + [build_lua(HOST_CC, HOST_AR, "built/host-luas")]
+                     # Count every allocation, including Lua's.
+                     + ["-Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc"]
+                     + ["-lm"]
+                     + ["-l" + lib for lib in libraries])
+    if subprocess.run(bench_command).returncode != 0:
+        sys.exit(1)
+    sys.exit(subprocess.run([bench_exe] + sys.argv[2:]).returncode)
+
 # Build Lua into a static library.
-if not os.path.exists("built/luas/all.a"):
-    for c_path in glob.glob(LUA_SRC + "/*.c"):
-        c_directory, c_file = os.path.split(c_path)
-        target = "built/luas/" + c_file + ".o"
-        if c_file not in LUA_MAINS and not os.path.exists(target):
-            subprocess.run(["arm-linux-gnueabihf-gcc"]
-                           + ["-Wall", "-Wextra",  "-O3"]
-                           + ["-c", c_path]
-                           + ["-o", target]
-                           + ["-lm"])
-    subprocess.run([AR, "rcs"]
-                   + ["built/luas/all.a"]
-                   + glob.glob("built/luas/*.o"))
+build_lua(CC, AR, "built/luas")
 
 command = ([CC]
            + ["-O3", "-flto"]
+           # The reMarkable 2's i.MX7 has Cortex-A7 cores with NEON.
+           + ["-mcpu=cortex-a7", "-mfpu=neon-vfpv4"]
            + ["-o", exe]
            + ["-I" + LUA_SRC]
            + source_files
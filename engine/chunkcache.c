@@ -0,0 +1,220 @@
+#include "chunkcache.h"
+
+#include <limits.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "lauxlib.h"
+
+#include "profile.h"
+
+// Precedes the bytecode in a cache file, identifying the source it was
+// compiled from.
+typedef struct
+{
+	char magic[8];
+	uint32_t version;
+	uint32_t reserved;
+	int64_t seconds;
+	int64_t nanoseconds;
+	int64_t size;
+} ChunkHeader;
+
+static ChunkHeader ChunkCache_header(struct stat const *source)
+{
+	ChunkHeader header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, "rm-luac", 8);
+	header.version = LUA_VERSION_NUM;
+	header.seconds = source->st_mtim.tv_sec;
+	header.nanoseconds = source->st_mtim.tv_nsec;
+	header.size = source->st_size;
+	return header;
+}
+
+/// Loads the bytecode of the cache at `cachePath` if its header is `expected`.
+/// RETURNS nonzero, leaving the stack as it was, if the cache is missing,
+/// stale or unreadable.
+static int ChunkCache_read(lua_State *L, char const *cachePath, ChunkHeader const *expected, char const *chunkName)
+{
+	FILE *file = fopen(cachePath, "rb");
+	if (file == NULL)
+	{
+		return 1;
+	}
+
+	ChunkHeader header;
+	struct stat cache;
+	if (fread(&header, sizeof(header), 1, file) != 1 || memcmp(&header, expected, sizeof(header)) != 0 || fstat(fileno(file), &cache) != 0 || cache.st_size <= (off_t)sizeof(header))
+	{
+		fclose(file);
+		return 1;
+	}
+
+	size_t length = (size_t)cache.st_size - sizeof(header);
+	char *bytecode = malloc(length);
+	int failed = bytecode == NULL || fread(bytecode, 1, length, file) != length;
+	fclose(file);
+
+	// A cache from an interpreter with different sizes of types is rejected
+	// by `lua_load`.
+	if (!failed && luaL_loadbufferx(L, bytecode, length, chunkName, "b") != LUA_OK)
+	{
+		lua_pop(L, 1);
+		failed = 1;
+	}
+	free(bytecode);
+	return failed;
+}
+
+static int ChunkCache_writer(lua_State *L, void const *data, size_t size, void *file)
+{
+	(void)L;
+	return fwrite(data, 1, size, file) != size;
+}
+
+/// Writes the function on the top of the stack to the cache at `cachePath`,
+/// through a temporary file so that other processes never read part of it.
+static void ChunkCache_write(lua_State *L, char const *cachePath, ChunkHeader const *header)
+{
+	char temporaryPath[PATH_MAX];
+	if (snprintf(temporaryPath, sizeof(temporaryPath), "%s.%ld", cachePath, (long)getpid()) >= (int)sizeof(temporaryPath))
+	{
+		return;
+	}
+
+	FILE *file = fopen(temporaryPath, "wb");
+	if (file == NULL)
+	{
+		return;
+	}
+
+	// Debug information is kept, so errors still name lines of the source.
+	int failed = fwrite(header, sizeof(*header), 1, file) != 1;
+	failed |= lua_dump(L, ChunkCache_writer, file, 0) != 0;
+	failed |= fclose(file) != 0;
+	if (failed || rename(temporaryPath, cachePath) != 0)
+	{
+		unlink(temporaryPath);
+	}
+}
+
+int ChunkCache_load(lua_State *L, char const *path)
+{
+	uint64_t began = Profile_begin();
+
+	char cachePath[PATH_MAX];
+	struct stat source;
+	if (snprintf(cachePath, sizeof(cachePath), "%sc", path) >= (int)sizeof(cachePath) || stat(path, &source) != 0)
+	{
+		return luaL_loadfile(L, path);
+	}
+
+	lua_pushfstring(L, "@%s", path);
+	char const *chunkName = lua_tostring(L, -1);
+
+	ChunkHeader header = ChunkCache_header(&source);
+	int status = LUA_OK;
+	if (ChunkCache_read(L, cachePath, &header, chunkName) == 0)
+	{
+		Profile_end("ChunkCache_load hit", began);
+	}
+	else
+	{
+		status = luaL_loadfile(L, path);
+		if (status == LUA_OK)
+		{
+			ChunkCache_write(L, cachePath, &header);
+		}
+		Profile_end("ChunkCache_load miss", began);
+	}
+
+	// Remove the chunk name from below the function or error.
+	lua_remove(L, -2);
+	return status;
+}
+
+int ChunkCache_compile(char const *path)
+{
+	lua_State *L = luaL_newstate();
+	if (L == NULL)
+	{
+		return 1;
+	}
+
+	int failed = ChunkCache_load(L, path) != LUA_OK;
+	if (failed)
+	{
+		fprintf(stderr, "ChunkCache_compile: %s\n", lua_tostring(L, -1));
+	}
+	else
+	{
+		// Check that the cache was written by loading it again.
+		char cachePath[PATH_MAX];
+		struct stat source;
+		snprintf(cachePath, sizeof(cachePath), "%sc", path);
+		ChunkHeader header;
+		failed = stat(path, &source) != 0;
+		if (!failed)
+		{
+			header = ChunkCache_header(&source);
+			failed = ChunkCache_read(L, cachePath, &header, path);
+		}
+		if (failed)
+		{
+			fprintf(stderr, "ChunkCache_compile: could not write `%s`.\n", cachePath);
+		}
+	}
+
+	lua_close(L);
+	return failed;
+}
+
+/// A searcher for `package.searchers`, with the `package` table as its upvalue.
+/// RETURNS the loader and file name of the module named by its argument, or a
+/// message saying where it looked.
+static int ChunkCache_search(lua_State *L)
+{
+	char const *name = luaL_checkstring(L, 1);
+
+	lua_getfield(L, lua_upvalueindex(1), "searchpath");
+	lua_pushvalue(L, 1);
+	lua_getfield(L, lua_upvalueindex(1), "path");
+	lua_call(L, 2, 2);
+	if (lua_isnil(L, -2))
+	{
+		return 1;
+	}
+	lua_pop(L, 1);
+
+	char const *filename = lua_tostring(L, -1);
+	if (ChunkCache_load(L, filename) != LUA_OK)
+	{
+		return luaL_error(L, "error loading module '%s' from file '%s':\n\t%s", name, filename, lua_tostring(L, -1));
+	}
+	lua_pushvalue(L, -2);
+	return 2;
+}
+
+void ChunkCache_install(lua_State *L)
+{
+	lua_getglobal(L, "package");
+	lua_getfield(L, -1, "searchers");
+
+	// Make room at index 2, after the searcher for `package.preload`.
+	for (lua_Integer i = (lua_Integer)lua_rawlen(L, -1); i >= 2; i--)
+	{
+		lua_rawgeti(L, -1, i);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	lua_pushvalue(L, -2);
+	lua_pushcclosure(L, ChunkCache_search, 1);
+	lua_rawseti(L, -2, 2);
+	lua_pop(L, 2);
+}
@@ -0,0 +1,32 @@
+#ifndef _CF_CHUNKCACHE
+#define _CF_CHUNKCACHE
+
+#include "lua.h"
+
+// The chunk cache keeps the compiled bytecode of each Lua file next to it (as
+// `font.lua` -> `font.luac`), so that loading it again skips lexing and
+// parsing. A cached chunk is only used while the file's modification time and
+// size and the Lua version match the ones it was compiled from; otherwise the
+// file is compiled again and the cache rewritten.
+//
+// Bytecode depends on the sizes of the interpreter's types, so caches are
+// written by the engine which uses them (see `engine --compile`).
+
+/// Loads the Lua file at `path` as a function on the top of the stack, like
+/// `luaL_loadfile`, from its cache when it is up to date. Writing the cache
+/// is best-effort; a file in a read-only directory is loaded from source.
+/// RETURNS the status of the load, leaving the error message on the stack
+/// if it is not `LUA_OK`.
+int ChunkCache_load(lua_State *L, char const *path);
+
+/// Brings the cache of the Lua file at `path` up to date, in a Lua state of
+/// its own.
+/// RETURNS nonzero (after printing the error) if the file could not be
+/// compiled or its cache could not be written.
+int ChunkCache_compile(char const *path);
+
+/// Adds a searcher for Lua modules on `package.path` which loads them with
+/// `ChunkCache_load`, before the standard Lua searcher.
+void ChunkCache_install(lua_State *L);
+
+#endif
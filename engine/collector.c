@@ -0,0 +1,145 @@
+#include "collector.h"
+
+#include <stdlib.h>
+
+#include "profile.h"
+
+// A cycle is started once the heap is this many times its size at the end of
+// the previous cycle, and forced to finish at once past the ceiling.
+#define COLLECTOR_PAUSE 2
+#define COLLECTOR_CEILING 4
+
+// Heaps smaller than this are treated as this size, so that small scripts
+// aren't collected constantly.
+#define MINIMUM_KILOBYTES 256
+
+// The time is checked after this many of the collector's basic steps.
+#define STEPS_PER_CHECK 16
+
+struct Collector
+{
+	lua_State *L;
+	double budget;
+
+	// Whether a cycle has been started and not yet finished.
+	bool collecting;
+
+	// The heap's size at the end of the previous cycle.
+	int liveKilobytes;
+
+	CollectorStats stats;
+};
+
+Collector *Collector_allocate(lua_State *L)
+{
+	Collector *collector = (Collector *)malloc(sizeof(Collector));
+	if (collector == NULL)
+	{
+		return NULL;
+	}
+
+	lua_gc(L, LUA_GCSTOP, 0);
+	collector->L = L;
+	collector->budget = COLLECTOR_BUDGET;
+	collector->collecting = false;
+	collector->liveKilobytes = lua_gc(L, LUA_GCCOUNT, 0);
+	collector->stats = (CollectorStats){0, 0, 0, 0, 0};
+	return collector;
+}
+
+void Collector_deallocate(Collector *collector)
+{
+	free(collector);
+}
+
+void Collector_setBudget(Collector *collector, double seconds)
+{
+	collector->budget = seconds > 0 ? seconds : 0;
+}
+
+double Collector_budget(Collector const *collector)
+{
+	return collector->budget;
+}
+
+/// RETURNS the size of the heap after the previous cycle, for the thresholds.
+static int Collector_base(Collector const *collector)
+{
+	return collector->liveKilobytes > MINIMUM_KILOBYTES ? collector->liveKilobytes : MINIMUM_KILOBYTES;
+}
+
+bool Collector_hasWork(Collector const *collector)
+{
+	return collector->collecting || lua_gc(collector->L, LUA_GCCOUNT, 0) >= COLLECTOR_PAUSE * Collector_base(collector);
+}
+
+/// Records a pause of the script which started at `began`.
+static void Collector_record(Collector *collector, uint64_t began)
+{
+	uint64_t ended = Profile_clock();
+	double seconds = (ended - began) * 1.0e-9;
+	collector->stats.pauses += 1;
+	collector->stats.totalSeconds += seconds;
+	if (seconds > collector->stats.longestSeconds)
+	{
+		collector->stats.longestSeconds = seconds;
+	}
+	if (profileEnabled)
+	{
+		Profile_end("Collector_step", began);
+	}
+}
+
+void Collector_stepFor(Collector *collector, double seconds)
+{
+	if (!Collector_hasWork(collector))
+	{
+		return;
+	}
+
+	lua_State *L = collector->L;
+	uint64_t began = Profile_clock();
+	int kilobytes = lua_gc(L, LUA_GCCOUNT, 0);
+	if (kilobytes >= COLLECTOR_CEILING * Collector_base(collector))
+	{
+		lua_gc(L, LUA_GCCOLLECT, 0);
+		collector->collecting = false;
+		collector->liveKilobytes = lua_gc(L, LUA_GCCOUNT, 0);
+		collector->stats.cycles += 1;
+		collector->stats.forced += 1;
+		Collector_record(collector, began);
+		return;
+	}
+
+	double budget = seconds >= 0 && seconds < collector->budget ? seconds : collector->budget;
+	uint64_t deadline = began + (uint64_t)(budget * 1.0e9);
+	collector->collecting = true;
+	do
+	{
+		// A step of size 0 is a single basic step, which RETURNS 1 when it
+		// finished a cycle.
+		int finished = 0;
+		for (int i = 0; i < STEPS_PER_CHECK && !finished; i++)
+		{
+			finished = lua_gc(L, LUA_GCSTEP, 0);
+		}
+		if (finished)
+		{
+			collector->collecting = false;
+			collector->liveKilobytes = lua_gc(L, LUA_GCCOUNT, 0);
+			collector->stats.cycles += 1;
+			break;
+		}
+	} while (Profile_clock() < deadline);
+	Collector_record(collector, began);
+}
+
+void Collector_step(Collector *collector)
+{
+	Collector_stepFor(collector, collector->budget);
+}
+
+CollectorStats Collector_stats(Collector const *collector)
+{
+	return collector->stats;
+}
@@ -0,0 +1,61 @@
+#ifndef _CF_COLLECTOR
+#define _CF_COLLECTOR
+
+#include "stdbool.h"
+#include "stdint.h"
+
+#include "lua.h"
+
+// A Collector drives a Lua state's garbage collector from the engine instead
+// of letting it run whenever the script allocates, so that collection happens
+// in bounded slices at times when a pause is not visible: while waiting for
+// input, and after display updates are sent.
+//
+// A collection cycle is started once the heap has doubled since the end of the
+// previous one, and advanced a slice at a time. If the slices can't keep up
+// and the heap grows past four times its size after the previous cycle, a full
+// collection is run at once.
+
+// The default time for a slice, in seconds.
+#define COLLECTOR_BUDGET 0.001
+
+struct Collector;
+typedef struct Collector Collector;
+
+typedef struct
+{
+	// Calls which did some collection, and how long they took.
+	uint64_t pauses;
+	double totalSeconds;
+	double longestSeconds;
+
+	// Cycles completed, including full collections forced by the heap outgrowing
+	// the slices.
+	uint64_t cycles;
+	uint64_t forced;
+} CollectorStats;
+
+/// Stops the state's automatic collection.
+/// RETURNS `NULL` if there was a problem allocating the Collector.
+Collector *Collector_allocate(lua_State *L);
+
+void Collector_deallocate(Collector *collector);
+
+/// Sets the longest time, in seconds, that a slice may take.
+void Collector_setBudget(Collector *collector, double seconds);
+
+double Collector_budget(Collector const *collector);
+
+/// RETURNS whether a cycle is in progress or due.
+bool Collector_hasWork(Collector const *collector);
+
+/// Runs the collector for up to the budget, if it has work.
+void Collector_step(Collector *collector);
+
+/// Runs the collector for up to `seconds` (when that is less than the budget,
+/// and not negative), if it has work.
+void Collector_stepFor(Collector *collector, double seconds);
+
+CollectorStats Collector_stats(Collector const *collector);
+
+#endif
@@ -0,0 +1,313 @@
+#include "draw.h"
+
+#include <math.h>
+#include <stdbool.h>
+
+#include "stroke.h"
+
+/// Clips the segment from (x1, y1) to (x2, y2) to the given bounds, using the
+/// Liang-Barsky algorithm.
+/// RETURNS false if no part of the segment is within the bounds.
+static bool Draw_clipSegment(double *x1, double *y1, double *x2, double *y2, double left, double top, double right, double bottom)
+{
+	double dx = *x2 - *x1;
+	double dy = *y2 - *y1;
+	double p[4] = {-dx, dx, -dy, dy};
+	double q[4] = {*x1 - left, right - *x1, *y1 - top, bottom - *y1};
+	double t0 = 0;
+	double t1 = 1;
+	for (int i = 0; i < 4; i++)
+	{
+		if (p[i] == 0)
+		{
+			if (q[i] < 0)
+			{
+				return false;
+			}
+			continue;
+		}
+
+		double t = q[i] / p[i];
+		if (p[i] < 0)
+		{
+			if (t > t1)
+			{
+				return false;
+			}
+			t0 = t > t0 ? t : t0;
+		}
+		else
+		{
+			if (t < t0)
+			{
+				return false;
+			}
+			t1 = t < t1 ? t : t1;
+		}
+	}
+
+	double ox = *x1;
+	double oy = *y1;
+	*x1 = ox + t0 * dx;
+	*y1 = oy + t0 * dy;
+	*x2 = ox + t1 * dx;
+	*y2 = oy + t1 * dy;
+	return true;
+}
+
+void Draw_line(Raster raster, long x1, long y1, long x2, long y2, double width, uint16_t color, Rectangle *dirty)
+{
+	if (width > 1)
+	{
+		StrokePoint a = {x1 + 0.5, y1 + 0.5, width / 2};
+		StrokePoint b = {x2 + 0.5, y2 + 0.5, width / 2};
+		Stroke_segment(raster, a, b, color, dirty);
+		return;
+	}
+
+	// Avoid stepping through pixels far outside of the clipping rectangle.
+	double left = raster.clip.left - 1.0;
+	double top = raster.clip.top - 1.0;
+	double right = (double)(raster.clip.left + raster.clip.width);
+	double bottom = (double)(raster.clip.top + raster.clip.height);
+	if (x1 < left || x1 > right || y1 < top || y1 > bottom || x2 < left || x2 > right || y2 < top || y2 > bottom)
+	{
+		double fx1 = x1, fy1 = y1, fx2 = x2, fy2 = y2;
+		if (!Draw_clipSegment(&fx1, &fy1, &fx2, &fy2, left, top, right, bottom))
+		{
+			return;
+		}
+		x1 = lround(fx1);
+		y1 = lround(fy1);
+		x2 = lround(fx2);
+		y2 = lround(fy2);
+	}
+
+	long dx = x2 > x1 ? x2 - x1 : x1 - x2;
+	long dy = y2 > y1 ? y1 - y2 : y2 - y1;
+	long sx = x1 < x2 ? 1 : -1;
+	long sy = y1 < y2 ? 1 : -1;
+	long err = dx + dy;
+
+	// Consecutive pixels in the same row are filled as a single span.
+	long x = x1;
+	long y = y1;
+	long runStart = x1;
+	while (1)
+	{
+		long nx = x;
+		long ny = y;
+		bool done = x == x2 && y == y2;
+		if (!done)
+		{
+			long e2 = 2 * err;
+			if (e2 >= dy)
+			{
+				err += dy;
+				nx += sx;
+			}
+			if (e2 <= dx)
+			{
+				err += dx;
+				ny += sy;
+			}
+		}
+
+		if (done || ny != y)
+		{
+			long runLeft = runStart < x ? runStart : x;
+			long runRight = runStart < x ? x : runStart;
+			Raster_fillSpan(raster, runLeft, runRight + 1, y, color, dirty);
+			runStart = nx;
+		}
+		if (done)
+		{
+			break;
+		}
+		x = nx;
+		y = ny;
+	}
+}
+
+void Draw_polyline(Raster raster, long const *xy, size_t count, double width, uint16_t color, Rectangle *dirty)
+{
+	if (count == 1)
+	{
+		Draw_line(raster, xy[0], xy[1], xy[0], xy[1], width, color, dirty);
+	}
+	for (size_t i = 1; i < count; i++)
+	{
+		Draw_line(raster, xy[2 * i - 2], xy[2 * i - 1], xy[2 * i], xy[2 * i + 1], width, color, dirty);
+	}
+}
+
+void Draw_fillCircle(Raster raster, long cx, long cy, double radius, uint16_t color, Rectangle *dirty)
+{
+	StrokePoint center = {cx + 0.5, cy + 0.5, radius};
+	Stroke_segment(raster, center, center, color, dirty);
+}
+
+void Draw_circle(Raster raster, long cx, long cy, double radius, double width, uint16_t color, Rectangle *dirty)
+{
+	double inner = radius - width;
+	if (inner < 0)
+	{
+		Draw_fillCircle(raster, cx, cy, radius, color, dirty);
+		return;
+	}
+
+	long extent = (long)floor(radius);
+	for (long dy = -extent; dy <= extent; dy++)
+	{
+		// The pixels at horizontal offsets up to `outer` are within the circle,
+		// and those up to `hole` are within the hole in its middle.
+		long outer = (long)floor(sqrt(radius * radius - (double)(dy * dy)));
+		double holeSquared = inner * inner - (double)(dy * dy);
+		if (holeSquared < 0)
+		{
+			Raster_fillSpan(raster, cx - outer, cx + outer + 1, cy + dy, color, dirty);
+			continue;
+		}
+
+		long hole = (long)floor(sqrt(holeSquared));
+		Raster_fillSpan(raster, cx - outer, cx - hole, cy + dy, color, dirty);
+		Raster_fillSpan(raster, cx + hole + 1, cx + outer + 1, cy + dy, color, dirty);
+	}
+}
+
+void Draw_rectangle(Raster raster, long left, long top, long right, long bottom, long width, uint16_t color, Rectangle *dirty)
+{
+	if (right <= left || bottom <= top || width <= 0)
+	{
+		return;
+	}
+
+	// Avoid stepping through rows far outside of the clipping rectangle.
+	long clipTop = (long)raster.clip.top;
+	long clipBottom = (long)(raster.clip.top + raster.clip.height);
+	long firstRow = top > clipTop ? top : clipTop;
+	long lastRow = bottom < clipBottom ? bottom : clipBottom;
+	for (long y = firstRow; y < lastRow; y++)
+	{
+		if (y < top + width || y >= bottom - width)
+		{
+			Raster_fillSpan(raster, left, right, y, color, dirty);
+		}
+		else
+		{
+			Raster_fillSpan(raster, left, left + width, y, color, dirty);
+			Raster_fillSpan(raster, right - width > left + width ? right - width : left + width, right, y, color, dirty);
+		}
+	}
+}
+
+// Blits move rows through a buffer on the stack, this many pixels at a time.
+#define DRAW_CHUNK 256
+
+/// RETURNS the number of leading `colors` which are zero (`set` false) or
+/// nonzero (`set` true).
+static size_t Draw_run(uint16_t const *colors, size_t count, bool set)
+{
+	size_t i = 0;
+	while (i < count && (colors[i] != 0) == set)
+	{
+		i++;
+	}
+	return i;
+}
+
+void Draw_blit(Raster raster, Raster source, Rectangle from, long x, long y, Raster const *mask, Rectangle *dirty)
+{
+	// Limit the copied area to the source (and the mask), then to the
+	// destination's clipping rectangle.
+	Rectangle bounds = {0, 0, source.width, source.height};
+	if (mask != NULL)
+	{
+		bounds.width = bounds.width < mask->width + from.left ? bounds.width : mask->width + from.left;
+		bounds.height = bounds.height < mask->height + from.top ? bounds.height : mask->height + from.top;
+	}
+	long left = (long)from.left;
+	long top = (long)from.top;
+	long right = left + (long)from.width;
+	long bottom = top + (long)from.height;
+	right = right < (long)bounds.width ? right : (long)bounds.width;
+	bottom = bottom < (long)bounds.height ? bottom : (long)bounds.height;
+
+	long dx = x - (long)from.left;
+	long dy = y - (long)from.top;
+	long clipLeft = (long)raster.clip.left - dx;
+	long clipTop = (long)raster.clip.top - dy;
+	left = left > clipLeft ? left : clipLeft;
+	top = top > clipTop ? top : clipTop;
+	right = right < clipLeft + (long)raster.clip.width ? right : clipLeft + (long)raster.clip.width;
+	bottom = bottom < clipTop + (long)raster.clip.height ? bottom : clipTop + (long)raster.clip.height;
+	if (right <= left || bottom <= top)
+	{
+		return;
+	}
+
+	// When copying within one target, visit rows and chunks in the order
+	// which never reads a pixel after it has been overwritten.
+	bool same = raster.target == source.target;
+	bool upwards = same && dy > 0;
+	bool leftwards = same && dy == 0 && dx > 0;
+
+	uint16_t colors[DRAW_CHUNK];
+	uint16_t masked[DRAW_CHUNK];
+	for (long row = 0; row < bottom - top; row++)
+	{
+		long sy = upwards ? bottom - 1 - row : top + row;
+		for (long done = 0; done < right - left; done += DRAW_CHUNK)
+		{
+			size_t count = right - left - done < DRAW_CHUNK ? (size_t)(right - left - done) : DRAW_CHUNK;
+			long sx = leftwards ? right - done - (long)count : left + done;
+			source.readSpan(source.target, (size_t)sx, (size_t)sy, count, colors);
+			if (mask == NULL)
+			{
+				Raster_writeSpan(raster, sx + dx, sy + dy, colors, count, dirty);
+				continue;
+			}
+
+			mask->readSpan(mask->target, (size_t)(sx - (long)from.left), (size_t)(sy - (long)from.top), count, masked);
+			size_t i = Draw_run(masked, count, false);
+			while (i < count)
+			{
+				size_t run = Draw_run(masked + i, count - i, true);
+				Raster_writeSpan(raster, sx + dx + (long)i, sy + dy, colors + i, run, dirty);
+				i += run;
+				i += Draw_run(masked + i, count - i, false);
+			}
+		}
+	}
+}
+
+void Draw_stamp(Raster raster, Raster mask, long x, long y, uint16_t color, Rectangle *dirty)
+{
+	// Only the part of the mask within the clipping rectangle is read.
+	long left = (long)raster.clip.left - x;
+	long top = (long)raster.clip.top - y;
+	long right = left + (long)raster.clip.width;
+	long bottom = top + (long)raster.clip.height;
+	left = left > 0 ? left : 0;
+	top = top > 0 ? top : 0;
+	right = right < (long)mask.width ? right : (long)mask.width;
+	bottom = bottom < (long)mask.height ? bottom : (long)mask.height;
+
+	uint16_t masked[DRAW_CHUNK];
+	for (long my = top; my < bottom; my++)
+	{
+		for (long mx = left; mx < right; mx += DRAW_CHUNK)
+		{
+			size_t count = right - mx < DRAW_CHUNK ? (size_t)(right - mx) : DRAW_CHUNK;
+			mask.readSpan(mask.target, (size_t)mx, (size_t)my, count, masked);
+			size_t i = Draw_run(masked, count, false);
+			while (i < count)
+			{
+				size_t run = Draw_run(masked + i, count - i, true);
+				Raster_fillSpan(raster, x + mx + (long)i, x + mx + (long)(i + run), y + my, color, dirty);
+				i += run;
+				i += Draw_run(masked + i, count - i, false);
+			}
+		}
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef _CF_DRAW
+#define _CF_DRAW
+
+#include "stddef.h"
+#include "stdint.h"
+
+#include "raster.h"
+
+// Shape primitives. Coordinates are in whole pixels; each primitive is clipped
+// to the Raster and MODIFIES `dirty` to contain every pixel which it filled.
+
+/// Draws a line between the pixels (x1, y1) and (x2, y2), inclusive.
+/// Lines with a `width` of at most 1 are drawn with Bresenham's algorithm;
+/// wider lines have round caps.
+void Draw_line(Raster raster, long x1, long y1, long x2, long y2, double width, uint16_t color, Rectangle *dirty);
+
+/// Draws lines between each consecutive pair of the `count` points in `xy`,
+/// which holds x and y coordinates alternately.
+void Draw_polyline(Raster raster, long const *xy, size_t count, double width, uint16_t color, Rectangle *dirty);
+
+/// Fills the pixels whose centers are within `radius` of the center of the
+/// pixel (cx, cy).
+void Draw_fillCircle(Raster raster, long cx, long cy, double radius, uint16_t color, Rectangle *dirty);
+
+/// Draws the outline of `Draw_fillCircle`'s circle, `width` pixels thick.
+void Draw_circle(Raster raster, long cx, long cy, double radius, double width, uint16_t color, Rectangle *dirty);
+
+/// Draws the outline of the rectangle `[left, right) x [top, bottom)`, `width`
+/// pixels thick, inside the rectangle.
+void Draw_rectangle(Raster raster, long left, long top, long right, long bottom, long width, uint16_t color, Rectangle *dirty);
+
+/// Copies the pixels of `from` in `source` (limited to its bounds) so that the
+/// top left of `from` lands on (x, y), clipped to the Raster. The Rasters may
+/// be the same, and the areas may overlap.
+/// When `mask` is not `NULL`, only the pixels where it is nonzero are copied;
+/// its top left corresponds to the top left of `from`.
+/// N.B.: Colors are copied as they are, not rescaled between Rasters of
+/// different depths.
+void Draw_blit(Raster raster, Raster source, Rectangle from, long x, long y, Raster const *mask, Rectangle *dirty);
+
+/// Fills with `color` the pixels where `mask` is nonzero, with the top left of
+/// the mask at (x, y).
+void Draw_stamp(Raster raster, Raster mask, long x, long y, uint16_t color, Rectangle *dirty);
+
+#endif
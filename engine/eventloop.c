@@ -0,0 +1,135 @@
+#include "eventloop.h"
+
+#include <errno.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+struct EventLoop
+{
+	int epoll;
+	int timer;
+};
+
+/// Creates the epoll and the timer.
+/// RETURNS nonzero if there was a problem, having closed whichever was created.
+static int EventLoop_open(EventLoop *loop, char const *caller)
+{
+	loop->timer = -1;
+	loop->epoll = epoll_create1(EPOLL_CLOEXEC);
+	if (loop->epoll < 0)
+	{
+		fprintf(stderr, "%s: could not create epoll.\n", caller);
+		return 1;
+	}
+
+	loop->timer = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+	if (loop->timer < 0 || EventLoop_watch(loop, loop->timer, EVENT_TIMER))
+	{
+		fprintf(stderr, "%s: could not create timer.\n", caller);
+		if (loop->timer >= 0)
+		{
+			close(loop->timer);
+			loop->timer = -1;
+		}
+		close(loop->epoll);
+		loop->epoll = -1;
+		return 1;
+	}
+
+	return 0;
+}
+
+EventLoop *EventLoop_allocate(void)
+{
+	EventLoop *loop = (EventLoop *)malloc(sizeof(EventLoop));
+	if (loop == NULL)
+	{
+		return NULL;
+	}
+
+	if (EventLoop_open(loop, "EventLoop_allocate"))
+	{
+		free(loop);
+		return NULL;
+	}
+
+	return loop;
+}
+
+int EventLoop_reopen(EventLoop *loop)
+{
+	close(loop->timer);
+	close(loop->epoll);
+	return EventLoop_open(loop, "EventLoop_reopen");
+}
+
+void EventLoop_deallocate(EventLoop *loop)
+{
+	close(loop->timer);
+	close(loop->epoll);
+	free(loop);
+}
+
+int EventLoop_watch(EventLoop *loop, int fileDescriptor, unsigned source)
+{
+	struct epoll_event event;
+	event.events = EPOLLIN;
+	event.data.u32 = source;
+	if (epoll_ctl(loop->epoll, EPOLL_CTL_ADD, fileDescriptor, &event) != 0)
+	{
+		fprintf(stderr, "EventLoop_watch: unexpected error %d from epoll_ctl.\n", errno);
+		return 1;
+	}
+	return 0;
+}
+
+unsigned EventLoop_wait(EventLoop *loop, double seconds)
+{
+	// A zero it_value disarms the timer, so arm it for at least a nanosecond.
+	struct itimerspec spec = {{0, 0}, {0, 0}};
+	if (seconds >= 0)
+	{
+		spec.it_value.tv_sec = (time_t)seconds;
+		spec.it_value.tv_nsec = (long)((seconds - spec.it_value.tv_sec) * 1.0e9);
+		if (spec.it_value.tv_sec == 0 && spec.it_value.tv_nsec == 0)
+		{
+			spec.it_value.tv_nsec = 1;
+		}
+	}
+	timerfd_settime(loop->timer, 0, &spec, NULL);
+
+	struct epoll_event events[8];
+	int count;
+	do
+	{
+		count = epoll_wait(loop->epoll, events, 8, -1);
+	} while (count < 0 && errno == EINTR);
+
+	if (count < 0)
+	{
+		fprintf(stderr, "EventLoop_wait: unexpected error %d from epoll_wait.\n", errno);
+		return 0;
+	}
+
+	unsigned ready = 0;
+	for (int i = 0; i < count; i++)
+	{
+		ready |= events[i].data.u32;
+	}
+
+	if (ready & EVENT_TIMER)
+	{
+		uint64_t expirations;
+		if (read(loop->timer, &expirations, sizeof(expirations)) < 0)
+		{
+			// The timer was re-armed before it could be read.
+			ready &= ~EVENT_TIMER;
+		}
+	}
+	return ready;
+}
@@ -0,0 +1,37 @@
+#ifndef _CF_EVENTLOOP
+#define _CF_EVENTLOOP
+
+// An EventLoop waits on several file descriptors and a timer at once, using
+// epoll and a timerfd.
+
+struct EventLoop;
+typedef struct EventLoop EventLoop;
+
+// The timer is always a source; other sources are given their own bit by the
+// caller of `EventLoop_watch`.
+#define EVENT_TIMER 1u
+
+/// RETURNS `NULL` if there was a problem initializing the EventLoop.
+EventLoop *EventLoop_allocate(void);
+
+void EventLoop_deallocate(EventLoop *loop);
+
+/// Replaces the epoll and timer with new ones. A forked process shares its
+/// parent's, so it must call this before waiting; file descriptors other than
+/// the timer must then be watched again.
+/// RETURNS nonzero if there was a problem, after which the EventLoop can only
+/// be deallocated.
+int EventLoop_reopen(EventLoop *loop);
+
+/// Watches the file descriptor for input. `source` is the bit which is set in
+/// the result of `EventLoop_wait` when it is readable.
+/// RETURNS nonzero if the file descriptor could not be watched.
+int EventLoop_watch(EventLoop *loop, int fileDescriptor, unsigned source);
+
+/// Blocks until a watched file descriptor is readable, or until `seconds`
+/// have passed (forever, when `seconds` is negative).
+/// RETURNS the bits of the sources which are ready; `EVENT_TIMER` when the
+/// time ran out.
+unsigned EventLoop_wait(EventLoop *loop, double seconds);
+
+#endif
@@ -0,0 +1,252 @@
+#include "flushscheduler.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "clock.h"
+
+// The number of updates which can be queued or in flight at once. Requesting
+// more waits for the oldest update to complete.
+#define SCHEDULED_CAPACITY 64
+
+typedef struct
+{
+	FlushHandle handle;
+	Rectangle rectangle;
+	int waveform;
+
+	// When `inFlight`, the update has been sent with `marker` and is
+	// expected to complete at `completesAt`.
+	bool inFlight;
+	uint32_t marker;
+	double completesAt;
+} Scheduled;
+
+struct FlushScheduler
+{
+	FrameBuffer *fb;
+	Clock clock;
+
+	FlushHandle nextHandle;
+
+	// Queued updates are kept in the order they were requested.
+	size_t count;
+	Scheduled scheduled[SCHEDULED_CAPACITY];
+};
+
+FlushScheduler *FlushScheduler_allocate(FrameBuffer *fb)
+{
+	FlushScheduler *scheduler = (FlushScheduler *)malloc(sizeof(FlushScheduler));
+	if (scheduler == NULL)
+	{
+		return NULL;
+	}
+
+	scheduler->fb = fb;
+	scheduler->clock = Clock_monotonic();
+	scheduler->nextHandle = 1;
+	scheduler->count = 0;
+	return scheduler;
+}
+
+void FlushScheduler_deallocate(FlushScheduler *scheduler)
+{
+	free(scheduler);
+}
+
+static void FlushScheduler_remove(FlushScheduler *scheduler, size_t index)
+{
+	memmove(scheduler->scheduled + index, scheduler->scheduled + index + 1, sizeof(Scheduled) * (scheduler->count - index - 1));
+	scheduler->count -= 1;
+}
+
+/// RETURNS whether the rectangle overlaps an update in flight, or a queued
+/// update before `before`.
+static bool FlushScheduler_blocked(FlushScheduler const *scheduler, Rectangle rectangle, size_t before)
+{
+	for (size_t i = 0; i < scheduler->count; i++)
+	{
+		Scheduled const *other = scheduler->scheduled + i;
+		if ((other->inFlight || i < before) && Rectangle_overlaps(other->rectangle, rectangle))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+static void FlushScheduler_send(FlushScheduler *scheduler, Scheduled *scheduled)
+{
+	scheduled->marker = FrameBuffer_flush(scheduler->fb, scheduled->rectangle, scheduled->waveform);
+	scheduled->inFlight = true;
+	scheduled->completesAt = Clock_getSeconds(&scheduler->clock) + FrameBuffer_updateSeconds(scheduled->waveform);
+}
+
+void FlushScheduler_service(FlushScheduler *scheduler)
+{
+	double now = Clock_getSeconds(&scheduler->clock);
+	for (size_t i = 0; i < scheduler->count;)
+	{
+		Scheduled *scheduled = scheduler->scheduled + i;
+		if (scheduled->inFlight && scheduled->completesAt <= now)
+		{
+			FlushScheduler_remove(scheduler, i);
+		}
+		else
+		{
+			i++;
+		}
+	}
+
+	for (size_t i = 0; i < scheduler->count; i++)
+	{
+		Scheduled *scheduled = scheduler->scheduled + i;
+		if (!scheduled->inFlight && !FlushScheduler_blocked(scheduler, scheduled->rectangle, i))
+		{
+			FlushScheduler_send(scheduler, scheduled);
+		}
+	}
+}
+
+/// Blocks until the in-flight update at `index` is complete, and retires it.
+static void FlushScheduler_retire(FlushScheduler *scheduler, size_t index)
+{
+	FrameBuffer_waitForUpdate(scheduler->fb, scheduler->scheduled[index].marker);
+	FlushScheduler_remove(scheduler, index);
+}
+
+FlushHandle FlushScheduler_request(FlushScheduler *scheduler, Rectangle rectangle, int waveform)
+{
+	FlushScheduler_service(scheduler);
+
+	if (FlushScheduler_blocked(scheduler, rectangle, scheduler->count))
+	{
+		// Merge with a queued request that will be sent with the same waveform.
+		for (size_t i = 0; i < scheduler->count; i++)
+		{
+			Scheduled *queued = scheduler->scheduled + i;
+			if (!queued->inFlight && queued->waveform == waveform && Rectangle_overlaps(queued->rectangle, rectangle))
+			{
+				Rectangle_expandToContain(&queued->rectangle, rectangle);
+				return queued->handle;
+			}
+		}
+	}
+
+	while (scheduler->count == SCHEDULED_CAPACITY)
+	{
+		// The oldest in-flight update is the most likely to be complete.
+		size_t oldest = 0;
+		while (oldest < scheduler->count && !scheduler->scheduled[oldest].inFlight)
+		{
+			oldest++;
+		}
+		if (oldest == scheduler->count)
+		{
+			oldest = 0;
+			FlushScheduler_send(scheduler, scheduler->scheduled);
+		}
+		FlushScheduler_retire(scheduler, oldest);
+		FlushScheduler_service(scheduler);
+	}
+
+	Scheduled *scheduled = scheduler->scheduled + scheduler->count;
+	scheduler->count += 1;
+	scheduled->handle = scheduler->nextHandle;
+	scheduler->nextHandle = scheduler->nextHandle == UINT32_MAX ? 1 : scheduler->nextHandle + 1;
+	scheduled->rectangle = rectangle;
+	scheduled->waveform = waveform;
+	scheduled->inFlight = false;
+
+	if (!FlushScheduler_blocked(scheduler, rectangle, scheduler->count - 1))
+	{
+		FlushScheduler_send(scheduler, scheduled);
+	}
+	return scheduled->handle;
+}
+
+/// RETURNS the index of the update with the given handle, or `count` if it is
+/// no longer scheduled (i.e., it is complete).
+static size_t FlushScheduler_find(FlushScheduler const *scheduler, FlushHandle handle)
+{
+	for (size_t i = 0; i < scheduler->count; i++)
+	{
+		if (scheduler->scheduled[i].handle == handle)
+		{
+			return i;
+		}
+	}
+	return scheduler->count;
+}
+
+bool FlushScheduler_isComplete(FlushScheduler *scheduler, FlushHandle handle)
+{
+	FlushScheduler_service(scheduler);
+	return FlushScheduler_find(scheduler, handle) == scheduler->count;
+}
+
+void FlushScheduler_wait(FlushScheduler *scheduler, FlushHandle handle)
+{
+	while (1)
+	{
+		FlushScheduler_service(scheduler);
+		size_t index = FlushScheduler_find(scheduler, handle);
+		if (index == scheduler->count)
+		{
+			return;
+		}
+
+		Scheduled *scheduled = scheduler->scheduled + index;
+		if (scheduled->inFlight)
+		{
+			FlushScheduler_retire(scheduler, index);
+			return;
+		}
+
+		// Wait for an update in flight which is blocking it. Merging can grow a
+		// queued rectangle over an update sent after it, so look at them all.
+		size_t blocker = scheduler->count;
+		for (size_t i = 0; i < scheduler->count && blocker == scheduler->count; i++)
+		{
+			if (scheduler->scheduled[i].inFlight && Rectangle_overlaps(scheduler->scheduled[i].rectangle, scheduled->rectangle))
+			{
+				blocker = i;
+			}
+		}
+		if (blocker != scheduler->count)
+		{
+			FlushScheduler_retire(scheduler, blocker);
+			continue;
+		}
+
+		// Otherwise, it is waiting behind an earlier queued update.
+		for (size_t i = 0; i < index; i++)
+		{
+			if (Rectangle_overlaps(scheduler->scheduled[i].rectangle, scheduled->rectangle))
+			{
+				FlushScheduler_wait(scheduler, scheduler->scheduled[i].handle);
+				break;
+			}
+		}
+	}
+}
+
+double FlushScheduler_secondsUntilNext(FlushScheduler const *scheduler)
+{
+	double now = Clock_getSeconds(&scheduler->clock);
+	double soonest = -1;
+	for (size_t i = 0; i < scheduler->count; i++)
+	{
+		Scheduled const *scheduled = scheduler->scheduled + i;
+		if (scheduled->inFlight)
+		{
+			double remaining = scheduled->completesAt - now;
+			remaining = remaining > 0 ? remaining : 0;
+			if (soonest < 0 || remaining < soonest)
+			{
+				soonest = remaining;
+			}
+		}
+	}
+	return soonest;
+}
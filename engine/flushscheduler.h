@@ -0,0 +1,46 @@
+#ifndef _CF_FLUSHSCHEDULER
+#define _CF_FLUSHSCHEDULER
+
+#include "stdbool.h"
+#include "stdint.h"
+
+#include "framebuffer.h"
+
+// A FlushScheduler sends display updates for a FrameBuffer without blocking.
+// An update which overlaps one that is still in flight is queued until the
+// earlier update completes, and is merged with other queued updates of the
+// same waveform that it overlaps.
+
+struct FlushScheduler;
+typedef struct FlushScheduler FlushScheduler;
+
+typedef uint32_t FlushHandle;
+
+/// RETURNS `NULL` if there was a problem allocating the FlushScheduler.
+FlushScheduler *FlushScheduler_allocate(FrameBuffer *fb);
+
+void FlushScheduler_deallocate(FlushScheduler *scheduler);
+
+/// Requests that the rectangle be flushed to the display with the given
+/// waveform, as soon as it does not overlap any update in flight.
+/// RETURNS a handle for checking on or waiting for the update. Requests which
+/// are merged share a handle.
+FlushHandle FlushScheduler_request(FlushScheduler *scheduler, Rectangle rectangle, int waveform);
+
+/// Retires updates which have (by estimate) completed, and sends the queued
+/// updates which they were blocking.
+void FlushScheduler_service(FlushScheduler *scheduler);
+
+/// RETURNS whether the update with the given handle is (by estimate)
+/// complete.
+bool FlushScheduler_isComplete(FlushScheduler *scheduler, FlushHandle handle);
+
+/// Blocks until the update with the given handle has been sent and the display
+/// reports that it is complete.
+void FlushScheduler_wait(FlushScheduler *scheduler, FlushHandle handle);
+
+/// RETURNS the number of seconds until an update in flight is expected to
+/// complete, or a negative number when nothing is in flight.
+double FlushScheduler_secondsUntilNext(FlushScheduler const *scheduler);
+
+#endif
@@ -0,0 +1,411 @@
+#include "font.h"
+
+#include <fcntl.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILE_HEADER_BYTES 16
+#define FILE_GLYPH_BYTES 8
+#define FILE_KERNING_BYTES 4
+
+typedef struct
+{
+	bool present;
+
+	// The glyph's columns `[left, left + width)` are drawn.
+	uint8_t left;
+	uint8_t width;
+
+	// When nonzero, the glyph's rows have not been decoded yet, and are at
+	// this offset in the mapped file.
+	uint32_t bitmapOffset;
+} Glyph;
+
+struct Font
+{
+	size_t height;
+	size_t baseline;
+	long kern;
+	long missingAdvance;
+
+	Glyph glyphs[FONT_GLYPHS];
+
+	// `height` rows for each glyph, shifted so that bit 0 is the glyph's
+	// leftmost drawn column and masked to its width.
+	uint32_t *rows;
+
+	// For fonts loaded by `Font_load`, the mapped file, and its kerning
+	// records.
+	uint8_t const *mapped;
+	size_t mappedBytes;
+	uint8_t const *kerning;
+	size_t kerningCount;
+};
+
+Font *Font_allocate(size_t height, size_t baseline, long kern, long missingAdvance)
+{
+	Font *font = (Font *)malloc(sizeof(Font));
+	if (font == NULL)
+	{
+		return NULL;
+	}
+
+	font->rows = (uint32_t *)calloc(FONT_GLYPHS * height, sizeof(uint32_t));
+	if (font->rows == NULL)
+	{
+		free(font);
+		return NULL;
+	}
+
+	font->height = height;
+	font->baseline = baseline;
+	font->kern = kern;
+	font->missingAdvance = missingAdvance;
+	memset(font->glyphs, 0, sizeof(font->glyphs));
+	font->mapped = NULL;
+	font->mappedBytes = 0;
+	font->kerning = NULL;
+	font->kerningCount = 0;
+	return font;
+}
+
+static uint16_t Font_u16(uint8_t const *at)
+{
+	return (uint16_t)(at[0] | at[1] << 8);
+}
+
+static uint32_t Font_u32(uint8_t const *at)
+{
+	return at[0] | at[1] << 8 | at[2] << 16 | (uint32_t)at[3] << 24;
+}
+
+/// Checks the header and records of a mapped font file, and sets up the glyph
+/// table from them.
+/// RETURNS the Font, or `NULL` if the file is not a valid font.
+static Font *Font_fromFile(uint8_t const *file, size_t bytes)
+{
+	if (bytes < FILE_HEADER_BYTES || memcmp(file, "RMF1", 4) != 0)
+	{
+		return NULL;
+	}
+
+	size_t height = file[4];
+	size_t baseline = file[5];
+	long kern = (int8_t)file[6];
+	long missingAdvance = (int16_t)Font_u16(file + 8);
+	size_t glyphCount = Font_u16(file + 10);
+	size_t kerningCount = Font_u16(file + 12);
+	size_t kerningStart = FILE_HEADER_BYTES + glyphCount * FILE_GLYPH_BYTES;
+	if (height == 0 || kerningStart > bytes || kerningCount * FILE_KERNING_BYTES > bytes - kerningStart)
+	{
+		return NULL;
+	}
+
+	Font *font = Font_allocate(height, baseline, kern, missingAdvance);
+	if (font == NULL)
+	{
+		return NULL;
+	}
+
+	for (size_t i = 0; i < glyphCount; i++)
+	{
+		uint8_t const *record = file + FILE_HEADER_BYTES + i * FILE_GLYPH_BYTES;
+		uint32_t offset = Font_u32(record + 4);
+		size_t rowBytes = (record[2] + 7) / 8;
+
+		// Compare against the bytes left after `offset`, so that a huge offset
+		// can't wrap around and pass.
+		if (record[1] + record[2] > 32 || offset < kerningStart || offset > bytes || (rowBytes != 0 && height > (bytes - offset) / rowBytes))
+		{
+			Font_deallocate(font);
+			return NULL;
+		}
+
+		Glyph *glyph = &font->glyphs[record[0]];
+		glyph->present = true;
+		glyph->left = record[1];
+		glyph->width = record[2];
+		glyph->bitmapOffset = offset;
+	}
+
+	font->mapped = file;
+	font->mappedBytes = bytes;
+	font->kerning = file + kerningStart;
+	font->kerningCount = kerningCount;
+	return font;
+}
+
+Font *Font_load(char const *path)
+{
+	int fd = open(path, O_RDONLY);
+	if (fd < 0)
+	{
+		fprintf(stderr, "Font_load: could not open `%s`.\n", path);
+		return NULL;
+	}
+
+	struct stat info;
+	if (fstat(fd, &info) != 0 || info.st_size == 0)
+	{
+		fprintf(stderr, "Font_load: could not read `%s`.\n", path);
+		close(fd);
+		return NULL;
+	}
+
+	size_t bytes = (size_t)info.st_size;
+	void *file = mmap(NULL, bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (file == MAP_FAILED)
+	{
+		fprintf(stderr, "Font_load: could not map `%s`.\n", path);
+		return NULL;
+	}
+
+	Font *font = Font_fromFile(file, bytes);
+	if (font == NULL)
+	{
+		fprintf(stderr, "Font_load: `%s` is not a valid font.\n", path);
+		munmap(file, bytes);
+	}
+	return font;
+}
+
+void Font_deallocate(Font *font)
+{
+	if (font->mapped != NULL)
+	{
+		munmap((void *)font->mapped, font->mappedBytes);
+	}
+	free(font->rows);
+	free(font);
+}
+
+/// RETURNS the bits `[left, left + width)` of `row`, shifted down to bit 0.
+static uint32_t Font_extract(uint32_t row, size_t left, size_t width)
+{
+	uint64_t shifted = (uint64_t)row >> left;
+	return (uint32_t)(shifted & ((UINT64_C(1) << width) - 1));
+}
+
+void Font_setGlyph(Font *font, unsigned char character, uint32_t const *rows)
+{
+	uint32_t ink = 0;
+	for (size_t y = 0; y < font->height; y++)
+	{
+		ink |= rows[y];
+	}
+
+	Glyph *glyph = &font->glyphs[character];
+	glyph->present = true;
+	glyph->left = 0;
+	glyph->width = 0;
+	glyph->bitmapOffset = 0;
+	if (ink != 0)
+	{
+		glyph->left = (uint8_t)__builtin_ctz(ink);
+		glyph->width = (uint8_t)(32 - __builtin_clz(ink) - glyph->left);
+	}
+
+	uint32_t *to = font->rows + character * font->height;
+	for (size_t y = 0; y < font->height; y++)
+	{
+		to[y] = Font_extract(rows[y], glyph->left, glyph->width);
+	}
+}
+
+/// Decodes the rows of a glyph from the mapped file, if it has not been yet.
+static void Font_decode(Font *font, unsigned char character)
+{
+	Glyph *glyph = &font->glyphs[character];
+	if (glyph->bitmapOffset == 0)
+	{
+		return;
+	}
+
+	uint8_t const *from = font->mapped + glyph->bitmapOffset;
+	size_t rowBytes = (glyph->width + 7) / 8;
+	uint32_t *to = font->rows + character * font->height;
+	for (size_t y = 0; y < font->height; y++)
+	{
+		uint32_t row = 0;
+		for (size_t b = 0; b < rowBytes; b++)
+		{
+			row |= (uint32_t)from[b] << (8 * b);
+		}
+		to[y] = Font_extract(row, 0, glyph->width);
+		from += rowBytes;
+	}
+	glyph->bitmapOffset = 0;
+}
+
+void Font_setExtent(Font *font, unsigned char character, size_t left, size_t width)
+{
+	Font_decode(font, character);
+
+	Glyph *glyph = &font->glyphs[character];
+	uint32_t *rows = font->rows + character * font->height;
+
+	// Recover the unshifted rows, then extract the new extent.
+	for (size_t y = 0; y < font->height; y++)
+	{
+		uint32_t row = (uint32_t)((uint64_t)rows[y] << glyph->left);
+		rows[y] = Font_extract(row, left, width);
+	}
+
+	glyph->present = true;
+	glyph->left = (uint8_t)left;
+	glyph->width = (uint8_t)width;
+}
+
+/// RETURNS the kerning adjustment between a pair of consecutive characters.
+static long Font_kerning(Font const *font, unsigned char first, unsigned char second)
+{
+	size_t low = 0;
+	size_t high = font->kerningCount;
+	unsigned key = first << 8 | second;
+	while (low < high)
+	{
+		size_t middle = (low + high) / 2;
+		uint8_t const *record = font->kerning + middle * FILE_KERNING_BYTES;
+		unsigned probe = record[0] << 8 | record[1];
+		if (probe == key)
+		{
+			return (int8_t)record[2];
+		}
+		else if (probe < key)
+		{
+			low = middle + 1;
+		}
+		else
+		{
+			high = middle;
+		}
+	}
+	return 0;
+}
+
+long Font_measure(Font const *font, char const *text, size_t length)
+{
+	long advance = 0;
+	for (size_t i = 0; i < length; i++)
+	{
+		unsigned char character = (unsigned char)text[i];
+		Glyph const *glyph = &font->glyphs[character];
+		if (!glyph->present)
+		{
+			advance += font->missingAdvance;
+			continue;
+		}
+
+		if (i != 0 && font->kerningCount != 0)
+		{
+			advance += Font_kerning(font, (unsigned char)text[i - 1], character);
+		}
+		advance += glyph->width + font->kern;
+	}
+	return advance;
+}
+
+bool Font_bounds(Font const *font, long x, long y, char const *text, size_t length, long *left, long *top, long *right, long *bottom)
+{
+	bool any = false;
+	long advance = 0;
+	for (size_t i = 0; i < length; i++)
+	{
+		unsigned char character = (unsigned char)text[i];
+		Glyph const *glyph = &font->glyphs[character];
+		if (!glyph->present)
+		{
+			advance += font->missingAdvance;
+			continue;
+		}
+
+		if (i != 0 && font->kerningCount != 0)
+		{
+			advance += Font_kerning(font, (unsigned char)text[i - 1], character);
+		}
+
+		if (glyph->width != 0)
+		{
+			long glyphLeft = x + advance;
+			long glyphRight = glyphLeft + glyph->width;
+			if (!any || glyphLeft < *left)
+			{
+				*left = glyphLeft;
+			}
+			if (!any || glyphRight > *right)
+			{
+				*right = glyphRight;
+			}
+			any = true;
+		}
+		advance += glyph->width + font->kern;
+	}
+
+	if (any)
+	{
+		*top = y + 1 - (long)font->baseline;
+		*bottom = *top + (long)font->height;
+	}
+	return any;
+}
+
+long Font_draw(Font *font, Raster raster, long x, long y, char const *text, size_t length, uint16_t color, Rectangle *dirty)
+{
+	long top = y + 1 - (long)font->baseline;
+	long clipTop = (long)raster.clip.top;
+	long clipBottom = (long)(raster.clip.top + raster.clip.height);
+
+	// Only the rows within the clipping rectangle need to be visited.
+	size_t firstRow = top < clipTop ? (size_t)(clipTop - top) : 0;
+	size_t lastRow = font->height;
+	if (top + (long)lastRow > clipBottom)
+	{
+		lastRow = clipBottom > top ? (size_t)(clipBottom - top) : 0;
+	}
+
+	long advance = 0;
+	for (size_t i = 0; i < length; i++)
+	{
+		unsigned char character = (unsigned char)text[i];
+		Glyph const *glyph = &font->glyphs[character];
+		if (!glyph->present)
+		{
+			advance += font->missingAdvance;
+			continue;
+		}
+
+		if (i != 0 && font->kerningCount != 0)
+		{
+			advance += Font_kerning(font, (unsigned char)text[i - 1], character);
+		}
+
+		long left = x + advance;
+		Font_decode(font, character);
+		uint32_t const *rows = font->rows + character * font->height;
+		for (size_t r = firstRow; r < lastRow; r++)
+		{
+			// Fill each run of set bits as one span.
+			uint32_t bits = rows[r];
+			long column = 0;
+			while (bits != 0)
+			{
+				int skip = __builtin_ctz(bits);
+				bits >>= skip;
+				column += skip;
+
+				int run = __builtin_ctzll(~(uint64_t)bits);
+				Raster_fillSpan(raster, left + column, left + column + run, top + (long)r, color, dirty);
+				bits = (uint32_t)((uint64_t)bits >> run);
+				column += run;
+			}
+		}
+
+		advance += glyph->width + font->kern;
+	}
+	return advance;
+}
@@ -0,0 +1,72 @@
+#ifndef _CF_FONT
+#define _CF_FONT
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+#include "raster.h"
+
+// A Font is an atlas of 1-bit glyphs, each up to 32 pixels wide, indexed by
+// byte. Each row of a glyph is one 32-bit integer whose least significant bit
+// is the leftmost pixel.
+
+#define FONT_GLYPHS 256
+
+// Fonts can also be loaded from a binary file (conventionally `.rmf`), which is
+// memory-mapped; each glyph is only decoded the first time it is drawn.
+// All integers are little-endian.
+//
+//   header (16 bytes):
+//     char[4] magic "RMF1"
+//     u8 height, u8 baseline, i8 kern, u8 reserved
+//     i16 missingAdvance, u16 glyphCount, u16 kerningCount, u16 reserved
+//   glyphCount glyph records (8 bytes each):
+//     u8 character, u8 left, u8 width, u8 reserved, u32 bitmapOffset
+//   kerningCount kerning records (4 bytes each), sorted by (first, second):
+//     u8 first, u8 second, i8 adjustment, u8 reserved
+//   bitmaps: for each glyph, `height` rows of `ceil(width / 8)` bytes; bit 0
+//     of a row's first byte is the glyph's column `left`.
+//
+// `luaapps/tools/fontconvert.lua` converts the Lua font tables to this format.
+
+struct Font;
+typedef struct Font Font;
+
+/// `height`: the number of rows in every glyph.
+/// `baseline`: the row (counting from 1) which sits on the text's baseline.
+/// `kern`: the space between consecutive glyphs.
+/// `missingAdvance`: how far to advance past a character without a glyph.
+/// RETURNS `NULL` if there was a problem allocating the Font.
+Font *Font_allocate(size_t height, size_t baseline, long kern, long missingAdvance);
+
+/// Maps the binary font file at `path`.
+/// RETURNS `NULL` if the file could not be read or is not a valid font.
+Font *Font_load(char const *path);
+
+void Font_deallocate(Font *font);
+
+/// Sets the glyph for `character` from its `height` rows. The glyph's extent
+/// is the columns which have any ink.
+void Font_setGlyph(Font *font, unsigned char character, uint32_t const *rows);
+
+/// Overrides the extent of the glyph for `character` to be the columns
+/// `[left, left + width)`, such as to give a space its width.
+void Font_setExtent(Font *font, unsigned char character, size_t left, size_t width);
+
+/// RETURNS the distance to advance x past `text`, as though a string drawn
+/// there were concatenated to it (which would not be kerned against `text`).
+long Font_measure(Font const *font, char const *text, size_t length);
+
+/// Finds the rectangle `[*left, *right) x [*top, *bottom)` which contains every
+/// pixel that `Font_draw` could fill when drawing `text` at (x, y).
+/// RETURNS `false` (leaving the rectangle unset) if no pixel could be filled.
+bool Font_bounds(Font const *font, long x, long y, char const *text, size_t length, long *left, long *top, long *right, long *bottom);
+
+/// Draws `text` with the left of its first glyph at `x` and its baseline on the
+/// row `y`.
+/// MODIFIES `dirty` to contain every pixel which was filled.
+/// RETURNS the distance to advance x past `text`.
+long Font_draw(Font *font, Raster raster, long x, long y, char const *text, size_t length, uint16_t color, Rectangle *dirty);
+
+#endif
@@ -0,0 +1,183 @@
+#include "fractal.h"
+
+#include <stdbool.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+// The number of samples evaluated at once.
+#define LANES 4
+
+// Escape times are computed for a run of this many cells at a time.
+#define RUN_CELLS 64
+
+// Spans are written this many pixels at a time.
+#define SPAN_PIXELS 256
+
+// The thresholds of the 4x4 ordered dither, in sixteenths.
+static uint8_t const s_bayer[4][4] = {
+	{0, 8, 2, 10},
+	{12, 4, 14, 6},
+	{3, 11, 1, 9},
+	{15, 7, 13, 5},
+};
+
+/// Iterates z = z^2 + c from z = 0 for `LANES` samples c = (re, im).
+/// MODIFIES `counts` to the number of iterations (up to `iterations`) which
+/// each sample stayed within |z| <= 2.
+static void Fractal_escape(float const *re, float const *im, unsigned iterations, uint32_t *counts)
+{
+#if defined(__SSE2__)
+	__m128 cr = _mm_loadu_ps(re);
+	__m128 ci = _mm_loadu_ps(im);
+	__m128 zr = _mm_setzero_ps();
+	__m128 zi = _mm_setzero_ps();
+	__m128 four = _mm_set1_ps(4);
+	__m128 alive = _mm_castsi128_ps(_mm_set1_epi32(-1));
+	__m128i count = _mm_setzero_si128();
+	for (unsigned i = 0; i < iterations; i++)
+	{
+		__m128 zr2 = _mm_mul_ps(zr, zr);
+		__m128 zi2 = _mm_mul_ps(zi, zi);
+		alive = _mm_and_ps(alive, _mm_cmple_ps(_mm_add_ps(zr2, zi2), four));
+		if (_mm_movemask_ps(alive) == 0)
+		{
+			break;
+		}
+
+		// Live lanes are all ones, which is -1.
+		count = _mm_sub_epi32(count, _mm_castps_si128(alive));
+		zi = _mm_add_ps(_mm_mul_ps(_mm_add_ps(zr, zr), zi), ci);
+		zr = _mm_add_ps(_mm_sub_ps(zr2, zi2), cr);
+	}
+	_mm_storeu_si128((__m128i *)counts, count);
+#elif defined(__ARM_NEON)
+	float32x4_t cr = vld1q_f32(re);
+	float32x4_t ci = vld1q_f32(im);
+	float32x4_t zr = vdupq_n_f32(0);
+	float32x4_t zi = vdupq_n_f32(0);
+	float32x4_t four = vdupq_n_f32(4);
+	uint32x4_t alive = vdupq_n_u32(UINT32_MAX);
+	uint32x4_t count = vdupq_n_u32(0);
+	for (unsigned i = 0; i < iterations; i++)
+	{
+		float32x4_t zr2 = vmulq_f32(zr, zr);
+		float32x4_t zi2 = vmulq_f32(zi, zi);
+		alive = vandq_u32(alive, vcleq_f32(vaddq_f32(zr2, zi2), four));
+		uint32x2_t any = vpmax_u32(vget_low_u32(alive), vget_high_u32(alive));
+		if ((vget_lane_u32(any, 0) | vget_lane_u32(any, 1)) == 0)
+		{
+			break;
+		}
+
+		// Live lanes are all ones, which is -1.
+		count = vsubq_u32(count, alive);
+		zi = vaddq_f32(vmulq_f32(vaddq_f32(zr, zr), zi), ci);
+		zr = vaddq_f32(vsubq_f32(zr2, zi2), cr);
+	}
+	vst1q_u32(counts, count);
+#else
+	for (int lane = 0; lane < LANES; lane++)
+	{
+		float zr = 0;
+		float zi = 0;
+		uint32_t count = 0;
+		for (unsigned i = 0; i < iterations; i++)
+		{
+			float zr2 = zr * zr;
+			float zi2 = zi * zi;
+			if (!(zr2 + zi2 <= 4))
+			{
+				break;
+			}
+			count += 1;
+			zi = (zr + zr) * zi + im[lane];
+			zr = (zr2 - zi2) + re[lane];
+		}
+		counts[lane] = count;
+	}
+#endif
+}
+
+void Fractal_render(Raster raster, Rectangle area, FractalView const *view, size_t cell, uint16_t const *palette, size_t levels, Rectangle *dirty)
+{
+	size_t clipRight = raster.clip.left + raster.clip.width;
+	size_t clipBottom = raster.clip.top + raster.clip.height;
+	size_t right = area.left + area.width < clipRight ? area.left + area.width : clipRight;
+	size_t bottom = area.top + area.height < clipBottom ? area.top + area.height : clipBottom;
+	size_t left = area.left > raster.clip.left ? area.left : raster.clip.left;
+	size_t top = area.top > raster.clip.top ? area.top : raster.clip.top;
+	if (cell == 0 || levels < 2 || view->iterations == 0 || right <= left || bottom <= top)
+	{
+		return;
+	}
+
+	// The cells which intersect the clipped area.
+	size_t firstColumn = (left - area.left) / cell;
+	size_t lastColumn = (right - area.left + cell - 1) / cell;
+	size_t firstRow = (top - area.top) / cell;
+	size_t lastRow = (bottom - area.top + cell - 1) / cell;
+
+	double halfWidth = 0.5 * area.width;
+	double halfHeight = 0.5 * area.height;
+	for (size_t row = firstRow; row < lastRow; row++)
+	{
+		float im = (float)(view->centerY + ((row + 0.5) * cell - halfHeight) * view->scale);
+		size_t rowTop = area.top + row * cell;
+		size_t y1 = rowTop > top ? rowTop : top;
+		size_t y2 = rowTop + cell < bottom ? rowTop + cell : bottom;
+
+		for (size_t run = firstColumn; run < lastColumn; run += RUN_CELLS)
+		{
+			size_t count = lastColumn - run < RUN_CELLS ? lastColumn - run : RUN_CELLS;
+
+			// Pad the samples to a whole number of lanes.
+			float re[RUN_CELLS + LANES];
+			float ims[RUN_CELLS + LANES];
+			uint32_t counts[RUN_CELLS + LANES];
+			for (size_t i = 0; i < count + LANES; i++)
+			{
+				size_t column = run + (i < count ? i : count - 1);
+				re[i] = (float)(view->centerX + ((column + 0.5) * cell - halfWidth) * view->scale);
+				ims[i] = im;
+			}
+			for (size_t i = 0; i < count; i += LANES)
+			{
+				Fractal_escape(re + i, ims + i, view->iterations, counts + i);
+			}
+
+			// The shade of each cell, in 16ths of a level: 0 in the set, up to
+			// `levels - 1` for samples which escape after one iteration.
+			uint32_t shades[RUN_CELLS];
+			for (size_t i = 0; i < count; i++)
+			{
+				bool inSet = counts[i] >= view->iterations;
+				shades[i] = inSet ? 0 : (uint32_t)(16 * (levels - 1) * (uint64_t)(view->iterations - counts[i]) / (view->iterations - 1));
+			}
+
+			size_t runLeft = area.left + run * cell;
+			size_t x1 = runLeft > left ? runLeft : left;
+			size_t runRight = runLeft + count * cell;
+			size_t x2 = runRight < right ? runRight : right;
+			for (size_t y = y1; y < y2; y++)
+			{
+				for (size_t x = x1; x < x2; x += SPAN_PIXELS)
+				{
+					size_t n = x2 - x < SPAN_PIXELS ? x2 - x : SPAN_PIXELS;
+					uint16_t colors[SPAN_PIXELS];
+					for (size_t i = 0; i < n; i++)
+					{
+						size_t px = x + i;
+						uint32_t shade = shades[(px - runLeft) / cell] + s_bayer[y & 3][px & 3];
+						size_t level = shade / 16;
+						colors[i] = palette[level < levels ? level : levels - 1];
+					}
+					Raster_writeSpan(raster, (long)x, (long)y, colors, n, dirty);
+				}
+			}
+		}
+	}
+}
@@ -0,0 +1,37 @@
+#ifndef _CF_FRACTAL
+#define _CF_FRACTAL
+
+#include "stddef.h"
+#include "stdint.h"
+
+#include "raster.h"
+
+// Renders the Mandelbrot set by escape time, evaluating several samples at once
+// in SIMD lanes (NEON on the reMarkable, SSE2 on x86, and plain C otherwise).
+// Samples are single-precision, which is enough for a screen of pixels down to
+// a scale of about 1e-6.
+
+// The most gray levels a render can be dithered to.
+#define FRACTAL_LEVELS 256
+
+typedef struct
+{
+	// The point of the complex plane at the middle of the rendered area, and
+	// the distance between pixels.
+	double centerX;
+	double centerY;
+	double scale;
+
+	// A sample which has not escaped after this many iterations is in the set.
+	unsigned iterations;
+} FractalView;
+
+/// Fills the part of `area` within the Raster's clipping rectangle with
+/// `cell` x `cell` squares, aligned to the top left of `area`, each shaded by
+/// the escape time of the sample at its middle: black in the set, and lighter
+/// the sooner a sample escapes. The shades are dithered (with a 4x4 ordered
+/// dither) to the `levels` colors of `palette`, from black to white.
+/// MODIFIES `dirty` to contain every pixel which was written.
+void Fractal_render(Raster raster, Rectangle area, FractalView const *view, size_t cell, uint16_t const *palette, size_t levels, Rectangle *dirty);
+
+#endif
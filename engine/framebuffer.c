@@ -1,8 +1,12 @@
+#define _GNU_SOURCE
+
 #include "framebuffer.h"
 
 #include <assert.h>
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <string.h>
 
 #include <fcntl.h>
 #include <unistd.h>
@@ -10,33 +14,15 @@
 #include <sys/ioctl.h>
 #include <sys/mman.h>
 
+#include "clock.h"
 #include "mxcfb.h"
+#include "profile.h"
 
 #define TEMP_USE_REMARKABLE_DRAW 0x0018
 
-void Rectangle_expandToContain(Rectangle *a, Rectangle b)
-{
-	if (b.width == 0 || b.height == 0)
-	{
-		return;
-	}
-	else if (a->width == 0 || a->height == 0)
-	{
-		*a = b;
-		return;
-	}
-
-	size_t aRight = a->left + a->width;
-	size_t bRight = b.left + b.width;
-	size_t aBottom = a->top + a->height;
-	size_t bBottom = b.top + b.height;
-	size_t right = aRight > bRight ? aRight : bRight;
-	size_t bottom = aBottom > bBottom ? aBottom : bBottom;
-	a->left = a->left < b.left ? a->left : b.left;
-	a->top = a->top < b.top ? a->top : b.top;
-	a->width = right - a->left;
-	a->height = bottom - a->top;
-}
+// The number of recent updates remembered to emulate waiting for completion
+// without a display device.
+#define EMULATED_UPDATES 32
 
 struct FrameBuffer
 {
@@ -45,8 +31,72 @@ struct FrameBuffer
 	size_t heightPixels;
 	size_t colorDataBytes;
 	uint16_t *colorData;
+
+	// Whether the file descriptor is a display device which accepts
+	// MXCFB_SEND_UPDATE, rather than a plain file or memfd.
+	bool isDevice;
+
+	size_t pageBytes;
+
+	// One flag per row, set when the row has been written since it was last
+	// synced by `FrameBuffer_flush`.
+	uint8_t *dirtyRows;
+
+	// The number of update requests made by `FrameBuffer_flush`.
+	size_t updateCount;
+	size_t updatePixels;
+
+	// When not `NULL`, every update request is appended to this file.
+	FILE *updateLog;
+
+	// The marker to give the next update request.
+	uint32_t nextMarker;
+
+	// Without a display device, the most recent updates and the times at which
+	// they are considered complete.
+	struct
+	{
+		uint32_t marker;
+		double completesAt;
+	} emulatedUpdates[EMULATED_UPDATES];
+	size_t emulatedUpdatesNext;
 };
 
+/// Memory-maps the color data of a FrameBuffer whose file descriptor and size
+/// have been set.
+/// RETURNS `false` (having closed the file descriptor) if there was a problem.
+static bool FrameBuffer_map(FrameBuffer *fb)
+{
+	fb->colorDataBytes = fb->widthPixels * fb->heightPixels * sizeof(uint16_t);
+	fb->colorData = mmap(NULL, fb->colorDataBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fb->fileDescriptor, 0);
+	if (fb->colorData == MAP_FAILED)
+	{
+		close(fb->fileDescriptor);
+		fprintf(stderr, "FrameBuffer_initialize: mmap failed.\n");
+		return false;
+	}
+
+	fb->pageBytes = (size_t)sysconf(_SC_PAGESIZE);
+
+	// Everything is considered dirty until the first flush.
+	fb->dirtyRows = malloc(fb->heightPixels);
+	if (fb->dirtyRows == NULL)
+	{
+		munmap(fb->colorData, fb->colorDataBytes);
+		close(fb->fileDescriptor);
+		return false;
+	}
+	memset(fb->dirtyRows, 1, fb->heightPixels);
+
+	fb->updateCount = 0;
+	fb->updatePixels = 0;
+	fb->updateLog = NULL;
+	fb->nextMarker = 1;
+	memset(fb->emulatedUpdates, 0, sizeof(fb->emulatedUpdates));
+	fb->emulatedUpdatesNext = 0;
+	return true;
+}
+
 FrameBuffer *FrameBuffer_allocate(char const *device)
 {
 	FrameBuffer *fb = (FrameBuffer *)malloc(sizeof(FrameBuffer));
@@ -55,6 +105,7 @@ FrameBuffer *FrameBuffer_allocate(char const *device)
 		return NULL;
 	}
 
+	fb->isDevice = true;
 	fb->fileDescriptor = open(device, O_RDWR);
 	if (fb->fileDescriptor < 1)
 	{
@@ -85,12 +136,51 @@ FrameBuffer *FrameBuffer_allocate(char const *device)
 	}
 
 	// Memory-map the data buffer.
-	fb->colorDataBytes = fb->widthPixels * fb->heightPixels * sizeof(uint16_t);
-	fb->colorData = mmap(NULL, fb->colorDataBytes, PROT_WRITE, MAP_SHARED, fb->fileDescriptor, 0);
-	if (fb->colorData == MAP_FAILED)
+	if (!FrameBuffer_map(fb))
+	{
+		free(fb);
+		return NULL;
+	}
+
+	return fb;
+}
+
+FrameBuffer *FrameBuffer_allocateFile(char const *path, size_t width, size_t height)
+{
+	FrameBuffer *fb = (FrameBuffer *)malloc(sizeof(FrameBuffer));
+	if (fb == NULL)
+	{
+		return NULL;
+	}
+
+	fb->isDevice = false;
+	if (path == NULL)
+	{
+		fb->fileDescriptor = memfd_create("framebuffer", 0);
+	}
+	else
+	{
+		fb->fileDescriptor = open(path, O_RDWR | O_CREAT, 0644);
+	}
+	if (fb->fileDescriptor < 0)
+	{
+		fprintf(stderr, "FrameBuffer_allocateFile: could not open `%s`.\n", path ? path : "memfd");
+		free(fb);
+		return NULL;
+	}
+
+	fb->widthPixels = width;
+	fb->heightPixels = height;
+	if (ftruncate(fb->fileDescriptor, width * height * sizeof(uint16_t)) != 0)
 	{
 		close(fb->fileDescriptor);
-		fprintf(stderr, "FrameBuffer_initialize: mmap failed.\n");
+		fprintf(stderr, "FrameBuffer_allocateFile: could not resize `%s`.\n", path ? path : "memfd");
+		free(fb);
+		return NULL;
+	}
+
+	if (!FrameBuffer_map(fb))
+	{
 		free(fb);
 		return NULL;
 	}
@@ -105,6 +195,11 @@ void FrameBuffer_deallocate(FrameBuffer *fb)
 	{
 		fprintf(stderr, "FrameBuffer_deallocate: munmap unexpectedly failed.\n");
 	}
+	if (fb->updateLog != NULL)
+	{
+		fclose(fb->updateLog);
+	}
+	free(fb->dirtyRows);
 	free(fb);
 }
 
@@ -115,6 +210,37 @@ void FrameBuffer_setPixel(FrameBuffer *fb, size_t x, size_t y, uint16_t color)
 
 	int index = x + y * fb->widthPixels;
 	fb->colorData[index] = color;
+	fb->dirtyRows[y] = 1;
+}
+
+void FrameBuffer_setSpan(FrameBuffer *fb, size_t x, size_t y, uint8_t const *colors, size_t count)
+{
+	assert(x + count <= fb->widthPixels);
+	assert(y < fb->heightPixels);
+
+	uint16_t *to = fb->colorData + y * fb->widthPixels + x;
+	for (size_t i = 0; i < count; i++)
+	{
+		to[i] = colors[i];
+	}
+	fb->dirtyRows[y] = 1;
+}
+
+void FrameBuffer_writeSpan(FrameBuffer *fb, size_t x, size_t y, uint16_t const *colors, size_t count)
+{
+	assert(x + count <= fb->widthPixels);
+	assert(y < fb->heightPixels);
+
+	memmove(fb->colorData + y * fb->widthPixels + x, colors, count * sizeof(uint16_t));
+	fb->dirtyRows[y] = 1;
+}
+
+void FrameBuffer_readSpan(FrameBuffer const *fb, size_t x, size_t y, uint16_t *colors, size_t count)
+{
+	assert(x + count <= fb->widthPixels);
+	assert(y < fb->heightPixels);
+
+	memcpy(colors, fb->colorData + y * fb->widthPixels + x, count * sizeof(uint16_t));
 }
 
 static void memset2(uint16_t *from, uint16_t value, size_t count)
@@ -152,24 +278,114 @@ void FrameBuffer_setRect(FrameBuffer *fb, Rectangle rect, uint16_t color)
 	{
 		size_t w = x2 - rect.left;
 		size_t y2 = rect.top + rect.height;
-		for (size_t y = rect.top; y < y2 && y < fb->heightPixels; y++)
+		if (y2 > fb->heightPixels)
+		{
+			y2 = fb->heightPixels;
+		}
+		for (size_t y = rect.top; y < y2; y++)
 		{
 			memset2(fb->colorData + y * width + rect.left, color, w);
 		}
+		if (y2 > rect.top)
+		{
+			memset(fb->dirtyRows + rect.top, 1, y2 - rect.top);
+		}
+	}
+}
+
+/// Syncs the mapped memory of rows `[top, bottom)` so that it is visible to the
+/// server.
+static void FrameBuffer_syncRows(FrameBuffer *fb, size_t top, size_t bottom)
+{
+	// msync requires a page-aligned address.
+	size_t rowBytes = fb->widthPixels * sizeof(uint16_t);
+	size_t begin = top * rowBytes / fb->pageBytes * fb->pageBytes;
+	size_t end = bottom * rowBytes;
+	uint64_t began = Profile_begin();
+	if (msync((char *)fb->colorData + begin, end - begin, MS_SYNC))
+	{
+		fprintf(stderr, "FrameBuffer_flush: unexpected error from msync.\n");
+	}
+	Profile_end("msync", began);
+}
+
+/// Syncs the dirty rows intersecting the given rectangle, and marks them clean.
+/// Runs of dirty rows separated by less than a page of clean rows are synced
+/// together, since they would touch the same page anyway.
+static void FrameBuffer_syncDirtyRows(FrameBuffer *fb, Rectangle rectangle)
+{
+	size_t rowBytes = fb->widthPixels * sizeof(uint16_t);
+	size_t bottom = rectangle.top + rectangle.height;
+	if (bottom > fb->heightPixels)
+	{
+		bottom = fb->heightPixels;
+	}
+
+	size_t runTop = 0;
+	size_t runBottom = 0;
+	bool inRun = false;
+	for (size_t y = rectangle.top; y < bottom; y++)
+	{
+		if (!fb->dirtyRows[y])
+		{
+			continue;
+		}
+		fb->dirtyRows[y] = 0;
+
+		if (inRun && (y - runBottom) * rowBytes < fb->pageBytes)
+		{
+			runBottom = y + 1;
+		}
+		else
+		{
+			if (inRun)
+			{
+				FrameBuffer_syncRows(fb, runTop, runBottom);
+			}
+			runTop = y;
+			runBottom = y + 1;
+			inRun = true;
+		}
+	}
+
+	if (inRun)
+	{
+		FrameBuffer_syncRows(fb, runTop, runBottom);
+	}
+}
+
+double FrameBuffer_updateSeconds(int waveform)
+{
+	switch (waveform)
+	{
+	case 0:
+		// A full initialization flashes several times.
+		return 2.0;
+	case 1:
+		// Black and white only.
+		return 0.26;
+	case 3:
+		// Goes white, black, then gray.
+		return 1.0;
+	default:
+		return 0.5;
 	}
 }
 
 /// `waveform`: 3
-void FrameBuffer_flush(FrameBuffer *fb, Rectangle rectangle, int waveform)
+uint32_t FrameBuffer_flush(FrameBuffer *fb, Rectangle rectangle, int waveform)
 {
 	struct mxcfb_update_data updateRequest;
 
+	uint32_t marker = fb->nextMarker;
+	fb->nextMarker = fb->nextMarker == UINT32_MAX ? 1 : fb->nextMarker + 1;
+
 	updateRequest.update_region.left = rectangle.left;
 	updateRequest.update_region.top = rectangle.top;
 	updateRequest.update_region.width = rectangle.width;
 	updateRequest.update_region.height = rectangle.height;
 
-	updateRequest.update_marker = 0x2a;
+	updateRequest.update_marker = marker;
 	updateRequest.waveform_mode = waveform;
 
 	// Perform a partial update.
@@ -182,18 +398,150 @@ void FrameBuffer_flush(FrameBuffer *fb, Rectangle rectangle, int waveform)
 	updateRequest.flags = 0;
 
 	// Sync the mapped memory to ensure it is visible to the server.
-	if (msync(fb->colorData, fb->colorDataBytes, MS_SYNC))
+	// Only the rows covered by the update which were written need to be synced.
+	FrameBuffer_syncDirtyRows(fb, rectangle);
+
+	Clock clock = Clock_monotonic();
+	double now = Clock_getSeconds(&clock);
+
+	fb->updateCount += 1;
+	fb->updatePixels += rectangle.width * rectangle.height;
+	if (fb->updateLog != NULL)
 	{
-		fprintf(stderr, "FrameBuffer_flush: unexpected error from msync.\n");
+		fprintf(fb->updateLog, "%.6f %zu %zu %zu %zu %d %u\n",
+				now,
+				rectangle.left, rectangle.top, rectangle.width, rectangle.height,
+				waveform, marker);
 	}
 
+	if (!fb->isDevice)
+	{
+		fb->emulatedUpdates[fb->emulatedUpdatesNext].marker = marker;
+		fb->emulatedUpdates[fb->emulatedUpdatesNext].completesAt = now + FrameBuffer_updateSeconds(waveform);
+		fb->emulatedUpdatesNext = (fb->emulatedUpdatesNext + 1) % EMULATED_UPDATES;
+		return marker;
+	}
+
+	uint64_t began = Profile_begin();
 	if (ioctl(fb->fileDescriptor, MXCFB_SEND_UPDATE, &updateRequest))
 	{
 		fprintf(stderr, "FrameBuffer_flush: unexpected error from ioctl.\n");
 	}
+	Profile_end("MXCFB_SEND_UPDATE", began);
+	return marker;
+}
+
+uint32_t FrameBuffer_flushRegion(FrameBuffer *fb, Region const *region, int waveform)
+{
+	uint32_t marker = 0;
+	for (size_t i = 0; i < region->count; i++)
+	{
+		marker = FrameBuffer_flush(fb, region->rects[i], waveform);
+	}
+	return marker;
+}
+
+void FrameBuffer_waitForUpdate(FrameBuffer *fb, uint32_t marker)
+{
+	if (fb->isDevice)
+	{
+		struct mxcfb_update_marker_data markerData = {marker, 0};
+		if (ioctl(fb->fileDescriptor, MXCFB_WAIT_FOR_UPDATE_COMPLETE, &markerData) < 0)
+		{
+			fprintf(stderr, "FrameBuffer_waitForUpdate: unexpected error from ioctl.\n");
+		}
+		return;
+	}
+
+	for (size_t i = 0; i < EMULATED_UPDATES; i++)
+	{
+		if (fb->emulatedUpdates[i].marker == marker)
+		{
+			Clock clock = Clock_monotonic();
+			double remaining = fb->emulatedUpdates[i].completesAt - Clock_getSeconds(&clock);
+			if (remaining > 0)
+			{
+				usleep((useconds_t)(remaining * 1.0e6));
+			}
+			return;
+		}
+	}
 }
 
 Rectangle FrameBuffer_size(FrameBuffer const *fb)
 {
 	return (Rectangle){0, 0, fb->widthPixels, fb->heightPixels};
 }
+
+int FrameBuffer_logUpdates(FrameBuffer *fb, char const *path)
+{
+	FILE *log = fopen(path, "w");
+	if (log == NULL)
+	{
+		fprintf(stderr, "FrameBuffer_logUpdates: could not open `%s`.\n", path);
+		return 1;
+	}
+
+	if (fb->updateLog != NULL)
+	{
+		fclose(fb->updateLog);
+	}
+	fb->updateLog = log;
+	fprintf(log, "# seconds left top width height waveform marker\n");
+	return 0;
+}
+
+size_t FrameBuffer_updateCount(FrameBuffer const *fb)
+{
+	return fb->updateCount;
+}
+
+size_t FrameBuffer_updatePixels(FrameBuffer const *fb)
+{
+	return fb->updatePixels;
+}
+
+/// Converts a 16-bit RGB565 color to an 8-bit gray level.
+static uint8_t grayFromColor(uint16_t color)
+{
+	uint32_t r = (color >> 11) & 0x1f;
+	uint32_t g = (color >> 5) & 0x3f;
+	uint32_t b = color & 0x1f;
+	return (uint8_t)((r * 255 / 31 * 299 + g * 255 / 63 * 587 + b * 255 / 31 * 114) / 1000);
+}
+
+int FrameBuffer_writePGM(FrameBuffer const *fb, char const *path)
+{
+	FILE *file = fopen(path, "wb");
+	if (file == NULL)
+	{
+		fprintf(stderr, "FrameBuffer_writePGM: could not open `%s`.\n", path);
+		return 1;
+	}
+
+	fprintf(file, "P5\n%zu %zu\n255\n", fb->widthPixels, fb->heightPixels);
+
+	uint8_t *row = malloc(fb->widthPixels);
+	if (row == NULL)
+	{
+		fclose(file);
+		return 1;
+	}
+	for (size_t y = 0; y < fb->heightPixels; y++)
+	{
+		uint16_t const *colors = fb->colorData + y * fb->widthPixels;
+		for (size_t x = 0; x < fb->widthPixels; x++)
+		{
+			row[x] = grayFromColor(colors[x]);
+		}
+		fwrite(row, 1, fb->widthPixels, file);
+	}
+	free(row);
+
+	if (fclose(file) != 0)
+	{
+		fprintf(stderr, "FrameBuffer_writePGM: could not write `%s`.\n", path);
+		return 1;
+	}
+	return 0;
+}
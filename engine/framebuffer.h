@@ -5,17 +5,7 @@
 #include "stdint.h"
 #include "stdlib.h"
 
-typedef struct
-{
-	size_t left;
-	size_t top;
-	size_t width;
-	size_t height;
-} Rectangle;
-
-/// MODIFIES the Rectangle pointed to by a to contain Rectangle b.
-/// A zero-area rectangle is considered to be contained by all other rectangles.
-void Rectangle_expandToContain(Rectangle *a, Rectangle b);
+#include "region.h"
 
 struct FrameBuffer;
 typedef struct FrameBuffer FrameBuffer;
@@ -26,23 +16,76 @@ typedef struct FrameBuffer FrameBuffer;
 /// RETURNS `NULL` if there was a problem initializing the FrameBuffer.
 FrameBuffer *FrameBuffer_allocate(char const *device);
 
+/// Initializes a FrameBuffer structure backed by a plain file rather than a
+/// display device, so that it can be used off of the tablet.
+/// `path` is created (or resized) to hold `width * height` 16-bit pixels;
+/// if `path` is `NULL`, an anonymous memfd is used instead.
+/// Flushes sync the file, but do not request any display update.
+/// RETURNS `NULL` if there was a problem initializing the FrameBuffer.
+FrameBuffer *FrameBuffer_allocateFile(char const *path, size_t width, size_t height);
+
 /// Frees the resources held by this FrameBuffer, invalidating it.
 void FrameBuffer_deallocate(FrameBuffer *fb);
 
 /// Sets the color of a single pixel in this FrameBuffer.
 void FrameBuffer_setPixel(FrameBuffer *fb, size_t x, size_t y, uint16_t color);
 
+/// Sets the colors of `count` consecutive pixels of row `y`, starting at column
+/// `x`, from an array of 8-bit colors.
+void FrameBuffer_setSpan(FrameBuffer *fb, size_t x, size_t y, uint8_t const *colors, size_t count);
+
+/// Sets the colors of `count` consecutive pixels of row `y`, starting at column
+/// `x`, from an array of 16-bit colors.
+void FrameBuffer_writeSpan(FrameBuffer *fb, size_t x, size_t y, uint16_t const *colors, size_t count);
+
+/// Reads the colors of `count` consecutive pixels of row `y`, starting at
+/// column `x`, into `colors`.
+void FrameBuffer_readSpan(FrameBuffer const *fb, size_t x, size_t y, uint16_t *colors, size_t count);
+
 /// Sets the color of all the pixels in the given rectangle.
 void FrameBuffer_setRect(FrameBuffer *fb, Rectangle area, uint16_t color);
 
 /// Flushes the contents of the FrameBuffer to the physical display.
-/// Only the specified Rectangle is requested to flush.
+/// Only the specified Rectangle is requested to flush, and only the rows of it
+/// which were modified since they were last flushed are synced.
 /// The waveform affects the speed and quality of the update on the display;
 /// some waveforms allow fewer colors but are faster or more accurate.
-void FrameBuffer_flush(FrameBuffer *fb, Rectangle rectangle, int waveform);
+/// RETURNS the unique marker of the update request, for
+/// `FrameBuffer_waitForUpdate`.
+uint32_t FrameBuffer_flush(FrameBuffer *fb, Rectangle rectangle, int waveform);
+
+/// Flushes each rectangle of the Region as its own update.
+/// RETURNS the marker of the last update request, or 0 if the Region is empty.
+uint32_t FrameBuffer_flushRegion(FrameBuffer *fb, Region const *region, int waveform);
+
+/// Blocks until the display has completed the update request with the given
+/// marker. Without a display device, waits until the update's estimated
+/// duration has passed.
+void FrameBuffer_waitForUpdate(FrameBuffer *fb, uint32_t marker);
+
+/// RETURNS an estimate, in seconds, of how long the display takes to complete
+/// an update with the given waveform.
+double FrameBuffer_updateSeconds(int waveform);
 
 /// Gets the size of the FrameBuffer. The width and height are bounds on
 /// coordinates passed to `FrameBuffer_setPixel`.
 Rectangle FrameBuffer_size(FrameBuffer const *fb);
 
+/// Records every subsequent update request (monotonic timestamp, rectangle and
+/// waveform) as a line of text in the file at `path`, replacing any previous
+/// log.
+/// RETURNS nonzero if the file could not be opened.
+int FrameBuffer_logUpdates(FrameBuffer *fb, char const *path);
+
+/// RETURNS the number of update requests made by `FrameBuffer_flush` so far.
+size_t FrameBuffer_updateCount(FrameBuffer const *fb);
+
+/// RETURNS the total area of the update requests made so far.
+size_t FrameBuffer_updatePixels(FrameBuffer const *fb);
+
+/// Writes the current contents of the FrameBuffer, converted to gray levels,
+/// to a binary PGM image at `path`.
+/// RETURNS nonzero if there was a problem writing the image.
+int FrameBuffer_writePGM(FrameBuffer const *fb, char const *path);
+
 #endif
@@ -6,13 +6,15 @@
 #include <poll.h>
 #include <unistd.h>
 #include <errno.h>
-#include <sys/time.h>
 #include <linux/input.h>
+#include <math.h>
+#include <sys/ioctl.h>
 
-int PenInput_init(PenInput *input, char const *device)
-{
-	input->fileDescriptor = open(device, O_RDONLY);
+#include "clock.h"
+#include "profile.h"
 
+static void PenInput_reset(PenInput *input)
+{
 	input->xPos = (Axis){0, 0, 0};
 	input->yPos = (Axis){0, 0, 0};
 
@@ -26,12 +28,249 @@ int PenInput_init(PenInput *input, char const *device)
 	input->eraser = (Button){0};
 	input->touching = (Button){0};
 
+	input->historyCount = 0;
+	input->historyTaken = 0;
+
+	input->replay = NULL;
+	input->hasPendingEvent = 0;
+}
+
+int PenInput_init(PenInput *input, char const *device)
+{
+	PenInput_reset(input);
+	input->fileDescriptor = open(device, O_RDONLY | O_NONBLOCK);
+
+	// Timestamp events with the clock used for `Clock_monotonic`, so that
+	// their age can be known.
+	int clock = CLOCK_MONOTONIC;
+	if (input->fileDescriptor >= 0)
+	{
+		ioctl(input->fileDescriptor, EVIOCSCLOCKID, &clock);
+	}
+
+	return 0;
+}
+
+int PenInput_initReplay(PenInput *input, char const *path, double speed)
+{
+	PenInput_reset(input);
+	input->fileDescriptor = -1;
+	input->replay = fopen(path, "rb");
+	if (input->replay == NULL)
+	{
+		fprintf(stderr, "PenInput_initReplay: could not open `%s`.\n", path);
+		return 1;
+	}
+
+	Clock clock = Clock_monotonic();
+	input->replaySpeed = speed;
+	input->replayStartSeconds = Clock_getSeconds(&clock);
+	input->recordingStartSeconds = -1;
 	return 0;
 }
 
 void PenInput_free(PenInput *input)
 {
-	close(input->fileDescriptor);
+	if (input->replay != NULL)
+	{
+		fclose(input->replay);
+	}
+	else
+	{
+		close(input->fileDescriptor);
+	}
+}
+
+/// Appends the current state of the pen to the history ring.
+static void PenInput_record(PenInput *input, struct input_event const *event)
+{
+	PenSample *sample = &input->history[input->historyCount % PEN_HISTORY_CAPACITY];
+	sample->seconds = event->time.tv_sec + 1.0e-6 * event->time.tv_usec;
+	sample->xPos = input->xPos.raw;
+	sample->yPos = input->yPos.raw;
+	sample->pressure = input->pressure.raw;
+	sample->distance = input->distance.raw;
+	sample->xTilt = input->xTilt.raw;
+	sample->yTilt = input->yTilt.raw;
+	sample->buttons = (input->pen.pressed ? PEN_BUTTON_PEN : 0) | (input->eraser.pressed ? PEN_BUTTON_ERASER : 0) | (input->touching.pressed ? PEN_BUTTON_TOUCHING : 0);
+	input->historyCount += 1;
+}
+
+size_t PenInput_takeSamples(PenInput *input, PenSample *out, size_t capacity)
+{
+	uint32_t waiting = input->historyCount - input->historyTaken;
+	if (waiting > PEN_HISTORY_CAPACITY)
+	{
+		waiting = PEN_HISTORY_CAPACITY;
+	}
+	if (waiting > capacity)
+	{
+		waiting = (uint32_t)capacity;
+	}
+
+	uint32_t first = input->historyCount - waiting;
+	for (uint32_t i = 0; i < waiting; i++)
+	{
+		out[i] = input->history[(first + i) % PEN_HISTORY_CAPACITY];
+	}
+	input->historyTaken = input->historyCount;
+	return waiting;
+}
+
+PenSample const *PenInput_latestSample(PenInput const *input)
+{
+	if (input->historyCount == 0)
+	{
+		return NULL;
+	}
+	return &input->history[(input->historyCount - 1) % PEN_HISTORY_CAPACITY];
+}
+
+// The most recent samples fitted by `PenInput_predict`.
+#define PREDICTION_WINDOW 6
+
+// Samples further apart than this (in seconds) are not part of one movement,
+// and a prediction isn't made from samples older than this.
+#define PREDICTION_GAP 0.025
+
+/// Fits `value = c0 + c1 t + c2 t^2` to the points by least squares, or a line
+/// when there are only two points.
+/// MODIFIES `velocity` to `c1` and `acceleration` to `2 c2`, the derivatives
+/// at `t = 0`.
+/// RETURNS nonzero if the times don't determine a fit.
+static int PenInput_fit(double const *t, double const *value, size_t n, double *velocity, double *acceleration)
+{
+	if (n == 2)
+	{
+		*velocity = (value[1] - value[0]) / (t[1] - t[0]);
+		*acceleration = 0;
+		return !isfinite(*velocity);
+	}
+
+	// The normal equations, solved by Cramer's rule.
+	double s[5] = {0, 0, 0, 0, 0};
+	double r[3] = {0, 0, 0};
+	for (size_t i = 0; i < n; i++)
+	{
+		double power = 1;
+		for (int k = 0; k < 5; k++)
+		{
+			s[k] += power;
+			if (k < 3)
+			{
+				r[k] += power * value[i];
+			}
+			power *= t[i];
+		}
+	}
+	double determinant = s[0] * (s[2] * s[4] - s[3] * s[3]) - s[1] * (s[1] * s[4] - s[3] * s[2]) + s[2] * (s[1] * s[3] - s[2] * s[2]);
+	if (fabs(determinant) < 1.0e-30)
+	{
+		return 1;
+	}
+	double c1 = (s[0] * (r[1] * s[4] - s[3] * r[2]) - r[0] * (s[1] * s[4] - s[3] * s[2]) + s[2] * (s[1] * r[2] - r[1] * s[2])) / determinant;
+	double c2 = (s[0] * (s[2] * r[2] - r[1] * s[3]) - s[1] * (s[1] * r[2] - r[1] * s[2]) + r[0] * (s[1] * s[3] - s[2] * s[2])) / determinant;
+	*velocity = c1;
+	*acceleration = 2 * c2;
+	return 0;
+}
+
+/// RETURNS the displacement after `tau` seconds at `velocity` and
+/// `acceleration`, stopping where deceleration would reverse the movement,
+/// and with acceleration adding at most as much again as the velocity.
+static double PenInput_extrapolate(double velocity, double acceleration, double tau)
+{
+	if (velocity * acceleration < 0 && tau > -velocity / acceleration)
+	{
+		tau = -velocity / acceleration;
+	}
+	double accelerated = 0.5 * acceleration * tau * tau;
+	double limit = fabs(velocity * tau);
+	accelerated = accelerated > limit ? limit : accelerated < -limit ? -limit : accelerated;
+	return velocity * tau + accelerated;
+}
+
+size_t PenInput_predict(PenInput const *input, double seconds, PenSample *out, size_t count)
+{
+	PenSample const *newest = PenInput_latestSample(input);
+	if (newest == NULL || !(newest->buttons & PEN_BUTTON_TOUCHING) || count == 0)
+	{
+		return 0;
+	}
+
+	// A recording's timestamps aren't comparable with the clock, so predict
+	// from the time of its newest sample.
+	double age = 0;
+	if (input->replay == NULL)
+	{
+		Clock clock = Clock_monotonic();
+		age = Clock_getSeconds(&clock) - newest->seconds;
+		if (age < 0 || age > PREDICTION_GAP)
+		{
+			return 0;
+		}
+	}
+
+	// The recent samples in contact, relative to the newest.
+	double t[PREDICTION_WINDOW];
+	double x[PREDICTION_WINDOW];
+	double y[PREDICTION_WINDOW];
+	double pressure[PREDICTION_WINDOW];
+	size_t n = 0;
+	uint32_t available = input->historyCount < PEN_HISTORY_CAPACITY ? input->historyCount : PEN_HISTORY_CAPACITY;
+	double later = newest->seconds;
+	for (uint32_t i = 0; i < available && n < PREDICTION_WINDOW; i++)
+	{
+		PenSample const *sample = &input->history[(input->historyCount - 1 - i) % PEN_HISTORY_CAPACITY];
+		if (!(sample->buttons & PEN_BUTTON_TOUCHING) || later - sample->seconds > PREDICTION_GAP)
+		{
+			break;
+		}
+		t[n] = sample->seconds - newest->seconds;
+		x[n] = sample->xPos;
+		y[n] = sample->yPos;
+		pressure[n] = sample->pressure;
+		later = sample->seconds;
+		n += 1;
+	}
+	if (n < 2)
+	{
+		return 0;
+	}
+
+	double vx, ax, vy, ay, vp, ap;
+	if (PenInput_fit(t, x, n, &vx, &ax) || PenInput_fit(t, y, n, &vy, &ay) || PenInput_fit(t, pressure, n, &vp, &ap))
+	{
+		return 0;
+	}
+
+	double horizon = age + seconds;
+	horizon = horizon < PEN_PREDICTION_LIMIT ? horizon : PEN_PREDICTION_LIMIT;
+	if (horizon <= 0)
+	{
+		return 0;
+	}
+
+	size_t predicted = 0;
+	for (size_t i = 0; i < count; i++)
+	{
+		double tau = horizon * (i + 1) / count;
+
+		// Pressure follows its trend, without the noisier acceleration.
+		double p = newest->pressure + vp * tau;
+		if (p <= 0)
+		{
+			break;
+		}
+
+		PenSample *sample = &out[predicted++];
+		*sample = *newest;
+		sample->seconds = newest->seconds + tau;
+		sample->xPos = (int32_t)lround(newest->xPos + PenInput_extrapolate(vx, ax, tau));
+		sample->yPos = (int32_t)lround(newest->yPos + PenInput_extrapolate(vy, ay, tau));
+		sample->pressure = (int32_t)(p < 4095 ? p : 4095);
+	}
+	return predicted;
 }
 
 // https://github.com/torvalds/linux/blob/master/include/uapi/linux/input.h#L28
@@ -41,6 +280,8 @@ static void PenInput_processPacket(PenInput *input, struct input_event event, vo
 {
 	if (event.type == 0)
 	{
+		PenInput_record(input, &event);
+
 		// Callback time!
 		if (callback != NULL)
 		{
@@ -105,50 +346,179 @@ static void PenInput_processPacket(PenInput *input, struct input_event event, vo
 	}
 }
 
-void PenInput_poll(PenInput *input, void *data, void (*callback)(void *, PenInput const *))
+/// Reads the next recorded event into the pending event.
+/// RETURNS 0 at the end of the recording.
+static int PenInput_readReplayEvent(PenInput *input)
 {
-	struct timeval began;
-	gettimeofday(&began, NULL);
+	// The tablet's 32-bit `struct input_event`, in little-endian byte order:
+	// uint32 seconds, uint32 microseconds, uint16 type, uint16 code,
+	// int32 value.
+	uint8_t record[16];
+	if (fread(record, sizeof(record), 1, input->replay) != 1)
+	{
+		return 0;
+	}
 
-	while (1)
+	uint32_t seconds = record[0] | record[1] << 8 | record[2] << 16 | (uint32_t)record[3] << 24;
+	uint32_t micros = record[4] | record[5] << 8 | record[6] << 16 | (uint32_t)record[7] << 24;
+	input->pendingSeconds = seconds + 1.0e-6 * micros;
+	input->pendingType = record[8] | record[9] << 8;
+	input->pendingCode = record[10] | record[11] << 8;
+	input->pendingValue = (int32_t)(record[12] | record[13] << 8 | record[14] << 16 | (uint32_t)record[15] << 24);
+
+	if (input->recordingStartSeconds < 0)
+	{
+		input->recordingStartSeconds = input->pendingSeconds;
+	}
+	input->hasPendingEvent = 1;
+	return 1;
+}
+
+/// RETURNS the monotonic time at which the pending recorded event is due.
+static double PenInput_replayDue(PenInput const *input)
+{
+	double due = input->replayStartSeconds;
+	if (input->replaySpeed > 0)
 	{
-		struct pollfd fds[1];
-		// TODO: Needs to set poll events.
-		fds[0] = (struct pollfd){input->fileDescriptor, POLLIN, 0};
+		due += (input->pendingSeconds - input->recordingStartSeconds) / input->replaySpeed;
+	}
+	return due;
+}
+
+/// Delivers the recorded events which are due.
+/// RETURNS the number of sync packets delivered.
+static int PenInput_readReplay(PenInput *input, void *data, void (*callback)(void *, PenInput const *))
+{
+	Clock clock = Clock_monotonic();
+	double now = Clock_getSeconds(&clock);
+	int packets = 0;
 
-		// Wait for 50 milliseconds
-		int success = poll(&fds[0], 1, 50);
-		// printf("poll result: %d\n", success);
-		if (success < 0)
+	while (input->hasPendingEvent || PenInput_readReplayEvent(input))
+	{
+		if (PenInput_replayDue(input) > now)
 		{
-			fprintf(stderr, "PenInput_poll: unexpected error %d from poll.\n", errno);
-			return;
+			break;
 		}
-		else if (success == 0)
+
+		struct input_event event;
+		event.time.tv_sec = (time_t)input->pendingSeconds;
+		event.time.tv_usec = (suseconds_t)((input->pendingSeconds - event.time.tv_sec) * 1.0e6 + 0.5);
+		event.type = input->pendingType;
+		event.code = input->pendingCode;
+		event.value = input->pendingValue;
+		input->hasPendingEvent = 0;
+		PenInput_processPacket(input, event, data, callback);
+
+		if (event.type == 0)
 		{
-			// No inputs
-			return;
+			packets += 1;
+			if (input->replaySpeed <= 0)
+			{
+				break;
+			}
 		}
+	}
+	return packets;
+}
 
-		struct input_event event;
-		size_t progress = 0;
-		while (progress < sizeof(event))
+double PenInput_secondsUntilReady(PenInput *input)
+{
+	if (input->replay == NULL)
+	{
+		return -1;
+	}
+	if (!input->hasPendingEvent && !PenInput_readReplayEvent(input))
+	{
+		return -1;
+	}
+
+	Clock clock = Clock_monotonic();
+	double remaining = PenInput_replayDue(input) - Clock_getSeconds(&clock);
+	return remaining > 0 ? remaining : 0;
+}
+
+int PenInput_read(PenInput *input, void *data, void (*callback)(void *, PenInput const *))
+{
+	if (input->replay != NULL)
+	{
+		return PenInput_readReplay(input, data, callback);
+	}
+	uint64_t began = Profile_begin();
+
+	// Read as many events as are available, in batches of up to a page.
+	struct input_event events[4096 / sizeof(struct input_event)];
+	int packets = 0;
+	while (1)
+	{
+		ssize_t r = read(input->fileDescriptor, events, sizeof(events));
+		if (r < 0)
 		{
-			int r = read(input->fileDescriptor, ((char *)&event) + progress, sizeof(event) - progress);
-			if (r < 0)
+			if (errno == EINTR)
 			{
-				fprintf(stderr, "PenInput_poll: unexpect error %d from read.\n", errno);
 				continue;
 			}
-			progress += r;
+			else if (errno != EAGAIN)
+			{
+				fprintf(stderr, "PenInput_read: unexpected error %d from read.\n", errno);
+			}
+			break;
 		}
-		PenInput_processPacket(input, event, data, callback);
 
-		if (timercmp(&began, &event.time, <))
+		size_t count = (size_t)r / sizeof(struct input_event);
+		for (size_t i = 0; i < count; i++)
+		{
+			PenInput_processPacket(input, events[i], data, callback);
+			if (events[i].type == 0)
+			{
+				packets += 1;
+			}
+		}
+
+		if ((size_t)r < sizeof(events))
 		{
 			break;
 		}
 	}
+	Profile_end("PenInput_read", began);
+	return packets;
+}
+
+void PenInput_poll(PenInput *input, void *data, void (*callback)(void *, PenInput const *))
+{
+	if (input->replay != NULL)
+	{
+		// Like a device, wait up to 50 milliseconds for the next event.
+		double wait = PenInput_secondsUntilReady(input);
+		if (wait < 0 || wait > 0.05)
+		{
+			wait = 0.05;
+		}
+		uint64_t began = Profile_begin();
+		usleep((useconds_t)(wait * 1.0e6));
+		Profile_end("PenInput_poll", began);
+		PenInput_readReplay(input, data, callback);
+		return;
+	}
+
+	struct pollfd fds[1];
+	fds[0] = (struct pollfd){input->fileDescriptor, POLLIN, 0};
+
+	// Wait for 50 milliseconds
+	uint64_t began = Profile_begin();
+	int success = poll(&fds[0], 1, 50);
+	Profile_end("PenInput_poll", began);
+	if (success < 0)
+	{
+		fprintf(stderr, "PenInput_poll: unexpected error %d from poll.\n", errno);
+		return;
+	}
+	else if (success == 0)
+	{
+		// No inputs
+		return;
+	}
+
+	PenInput_read(input, data, callback);
 }
 
 // https://github.com/freedesktop-unofficial-mirror/evtest/blob/master/evtest.c
@@ -1,7 +1,9 @@
 #ifndef _CF_INPUT
 #define _CF_INPUT
 
+#include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
 
 typedef struct
 {
@@ -15,6 +17,32 @@ typedef struct
 	int pressed;
 } Button;
 
+// Bits of `PenSample.buttons`.
+#define PEN_BUTTON_PEN 1u
+#define PEN_BUTTON_ERASER 2u
+#define PEN_BUTTON_TOUCHING 4u
+
+// The complete state of the pen at one sync packet.
+typedef struct
+{
+	// The kernel's timestamp of the sync, in seconds.
+	double seconds;
+
+	int32_t xPos;
+	int32_t yPos;
+	int32_t pressure;
+	int32_t distance;
+	int32_t xTilt;
+	int32_t yTilt;
+
+	// A combination of the `PEN_BUTTON_` bits.
+	uint32_t buttons;
+} PenSample;
+
+// The number of recent samples a PenInput retains. At the digitizer's rate of
+// about 240 samples per second, this is roughly one second of history.
+#define PEN_HISTORY_CAPACITY 256
+
 typedef struct PenInput PenInput;
 
 typedef struct
@@ -41,12 +69,80 @@ struct PenInput
 	Button pen;
 	Button eraser;
 	Button touching;
+
+	// A ring of the most recent samples, written at each sync.
+	// `historyCount` counts every sample ever written; the newest sample is at
+	// `history[(historyCount - 1) % PEN_HISTORY_CAPACITY]`.
+	PenSample history[PEN_HISTORY_CAPACITY];
+	uint32_t historyCount;
+
+	// The value of `historyCount` as of the last `PenInput_takeSamples`.
+	uint32_t historyTaken;
+
+	// When `replay` is not `NULL`, events are read from a recording rather than
+	// from a device. See `PenInput_initReplay`.
+	FILE *replay;
+	double replaySpeed;
+	double replayStartSeconds;
+	double recordingStartSeconds;
+	int hasPendingEvent;
+	double pendingSeconds;
+	uint16_t pendingType;
+	uint16_t pendingCode;
+	int32_t pendingValue;
 };
 
 int PenInput_init(PenInput *input, char const *device);
 
-// Processes data from the input device, and calls the callback at appropriate
-// sync times.
+// Initializes a PenInput that replays a recording of the digitizer instead of
+// reading a device.
+// The recording is the raw stream of the tablet's 16-byte `input_event`s, as
+// captured by `cat /dev/input/event1 > pen.events` on the reMarkable.
+// `speed` scales the playback rate relative to the original timestamps; `0`
+// replays as fast as possible, one sync packet per poll.
+// RETURNS nonzero if the recording could not be opened.
+int PenInput_initReplay(PenInput *input, char const *path, double speed);
+
+// Closes the device or recording.
+void PenInput_free(PenInput *input);
+
+// Waits up to 50 milliseconds for data from the input device, then processes
+// all of the available data, calling the callback at each sync.
 void PenInput_poll(PenInput *input, void *data, void (*callback)(void *, PenInput const *));
 
+// Processes all of the data available from the input device without waiting,
+// calling the callback at each sync.
+// RETURNS the number of syncs processed.
+int PenInput_read(PenInput *input, void *data, void (*callback)(void *, PenInput const *));
+
+// RETURNS the number of seconds until a replayed recording has another event
+// ready to read, or a negative number when not replaying (the file descriptor
+// can be waited on instead) or when the recording is finished.
+double PenInput_secondsUntilReady(PenInput *input);
+
+// Copies the samples recorded since the previous call, oldest first, into
+// `out`. When more than `capacity` samples (or more than the history holds) are
+// waiting, only the newest are copied and the older ones are discarded.
+// RETURNS the number of samples copied.
+size_t PenInput_takeSamples(PenInput *input, PenSample *out, size_t capacity);
+
+// RETURNS the most recently recorded sample, or `NULL` if there has not been
+// one.
+PenSample const *PenInput_latestSample(PenInput const *input);
+
+// The furthest ahead of the newest sample that `PenInput_predict` looks, in
+// seconds.
+#define PEN_PREDICTION_LIMIT 0.05
+
+// Extrapolates the stroke in contact from the velocity and acceleration (and
+// the trend of pressure) of the recent samples, fitted by their kernel
+// timestamps, to where the pen will be `seconds` from now. The newest sample
+// may already be some milliseconds old, which is added to the look-ahead; it
+// is limited to `PEN_PREDICTION_LIMIT`.
+// MODIFIES `out` to up to `count` samples evenly spaced along the prediction,
+// stopping early if the pressure is predicted to reach 0.
+// RETURNS the number of samples predicted, which is 0 unless the pen is in
+// contact and has been moving recently.
+size_t PenInput_predict(PenInput const *input, double seconds, PenSample *out, size_t count);
+
 #endif
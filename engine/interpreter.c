@@ -2,20 +2,46 @@
 #include "lauxlib.h"
 #include "lualib.h"
 #include "stdio.h"
+#include "stdlib.h"
 #include "stdbool.h"
+#include "math.h"
 
 #include "interpreter.h"
 
 #include "framebuffer.h"
 #include "slowbuffer.h"
 #include "input.h"
+#include "touch.h"
 #include "clock.h"
+#include "flushscheduler.h"
+#include "eventloop.h"
+#include "raster.h"
+#include "stroke.h"
+#include "draw.h"
+#include "font.h"
+#include "surface.h"
+#include "scene.h"
+#include "profile.h"
+#include "tiles.h"
+#include "fractal.h"
+#include "chunkcache.h"
+#include "collector.h"
+#include "provisional.h"
+
+// The EventLoop source bit for the pen's file descriptor.
+#define EVENT_PEN 2u
+#define EVENT_TOUCH 4u
 
 typedef struct
 {
 	PenInput *penInput;
+	TouchInput *touchInput;
 	FrameBuffer *frameBuffer;
 	SlowBuffer *slowBuffer;
+	FlushScheduler *scheduler;
+	EventLoop *events;
+	TileRenderer *tiles;
+	Collector *collector;
 } Device;
 
 static int s_FrameBuffer_size(lua_State *L)
@@ -131,41 +157,90 @@ static int s_SlowBuffer_setPixel(lua_State *L)
 	return 0;
 }
 
-static int s_FrameBuffer_flush(lua_State *L)
+/// Reads the rectangle `x1, y1, x2, y2` from the arguments starting at `arg`.
+/// RETURNS `false` if the rectangle is empty; raises an error if it is out of
+/// bounds.
+static bool s_checkFlushRectangle(lua_State *L, int arg, Rectangle screenSize, Rectangle *out)
 {
-	Device *device = luaL_checkudata(L, 1, "C-FrameBuffer");
-	lua_Integer x1 = luaL_checkinteger(L, 2);
-	lua_Integer y1 = luaL_checkinteger(L, 3);
-	lua_Integer x2 = luaL_checkinteger(L, 4);
-	lua_Integer y2 = luaL_checkinteger(L, 5);
-	lua_Integer waveform = luaL_checkinteger(L, 6);
-
-	Rectangle screenSize = FrameBuffer_size(device->frameBuffer);
+	lua_Integer x1 = luaL_checkinteger(L, arg);
+	lua_Integer y1 = luaL_checkinteger(L, arg + 1);
+	lua_Integer x2 = luaL_checkinteger(L, arg + 2);
+	lua_Integer y2 = luaL_checkinteger(L, arg + 3);
 
 	if (x2 <= x1 || y2 <= y1)
 	{
-		return 0;
+		return false;
 	}
 	if (x1 < 0 || x1 >= screenSize.width)
 	{
-		return luaL_error(L, "x1 `%d` is out of bounds.", x1);
+		luaL_error(L, "x1 `%d` is out of bounds.", x1);
 	}
 	else if (y1 < 0 || y1 > screenSize.height)
 	{
-		return luaL_error(L, "y1 `%d` is out of bounds", y1);
+		luaL_error(L, "y1 `%d` is out of bounds", y1);
 	}
 	else if (x2 > screenSize.width)
 	{
-		return luaL_error(L, "x2 `%d` is out of bounds.", x2);
+		luaL_error(L, "x2 `%d` is out of bounds.", x2);
 	}
 	else if (y2 > screenSize.height)
 	{
-		return luaL_error(L, "y2 `%d` is out of bounds.", y2);
+		luaL_error(L, "y2 `%d` is out of bounds.", y2);
 	}
 
-	Rectangle rect = {x1, y1, x2 - x1, y2 - y1};
+	*out = (Rectangle){x1, y1, x2 - x1, y2 - y1};
+	return true;
+}
+
+static int s_FrameBuffer_flush(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-FrameBuffer");
+	lua_Integer waveform = luaL_checkinteger(L, 6);
+
+	Rectangle rect;
+	if (!s_checkFlushRectangle(L, 2, FrameBuffer_size(device->frameBuffer), &rect))
+	{
+		return 0;
+	}
 
 	FrameBuffer_flush(device->frameBuffer, rect, waveform);
+	Collector_step(device->collector);
+	return 0;
+}
+
+static int s_FrameBuffer_flushAsync(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-FrameBuffer");
+	lua_Integer waveform = luaL_checkinteger(L, 6);
+
+	Rectangle rect;
+	if (!s_checkFlushRectangle(L, 2, FrameBuffer_size(device->frameBuffer), &rect))
+	{
+		// There is nothing to wait for.
+		lua_pushinteger(L, 0);
+		return 1;
+	}
+
+	lua_pushinteger(L, FlushScheduler_request(device->scheduler, rect, waveform));
+	Collector_step(device->collector);
+	return 1;
+}
+
+static int s_FrameBuffer_isComplete(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-FrameBuffer");
+	lua_Integer handle = luaL_checkinteger(L, 2);
+
+	lua_pushboolean(L, FlushScheduler_isComplete(device->scheduler, (FlushHandle)handle));
+	return 1;
+}
+
+static int s_FrameBuffer_wait(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-FrameBuffer");
+	lua_Integer handle = luaL_checkinteger(L, 2);
+
+	FlushScheduler_wait(device->scheduler, (FlushHandle)handle);
 	return 0;
 }
 
@@ -205,6 +280,19 @@ static int s_SlowBuffer_flush(lua_State *L)
 	Rectangle rect = {x1, y1, x2 - x1, y2 - y1};
 
 	SlowBuffer_flush(sb, rect);
+	Collector_step(device->collector);
+	return 0;
+}
+
+static int s_FrameBuffer_snapshot(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-FrameBuffer");
+	char const *path = luaL_checkstring(L, 2);
+
+	if (FrameBuffer_writePGM(device->frameBuffer, path))
+	{
+		return luaL_error(L, "could not write snapshot `%s`", path);
+	}
 	return 0;
 }
 
@@ -212,46 +300,77 @@ typedef struct
 {
 	lua_State *L;
 	Rectangle screenSize;
+
+	// The stack index of the Lua callback function.
+	int callbackIndex;
 } s_PenInput_pollPen_callback_closure;
 
+/// Converts the digitizer's coordinates, which are rotated relative to the
+/// display, into screen pixels.
+static void s_penScreenPoint(Rectangle screenSize, int32_t xRaw, int32_t yRaw, double *x, double *y)
+{
+	double px = xRaw / 20966.0;
+	double py = yRaw / 15725.0;
+	*x = screenSize.width * py;
+	*y = screenSize.height * (1.0 - px);
+}
+
+/// Like `s_penScreenPoint`, but rounds down to the pixel.
+static void s_penScreenPosition(Rectangle screenSize, int32_t xRaw, int32_t yRaw, int *mx, int *my)
+{
+	double x, y;
+	s_penScreenPoint(screenSize, xRaw, yRaw, &x, &y);
+	*mx = (int)x;
+	*my = (int)y;
+}
+
+// The registry key of the table passed to pen callbacks.
+static char s_penStateKey;
+
+// The registry key of the C-PenSamples returned by `rm_pen:samples()`.
+static char s_penSamplesKey;
+
+// The registry key of the C-PenSamples returned by `rm_pen:predict()`.
+static char s_penPredictionKey;
+
+// The number of samples `rm_pen:predict()` spaces along the prediction, so
+// that a curving prediction is drawn as a curve.
+#define PEN_PREDICTION_SAMPLES 4
+
 static void s_PenInput_pollPen_callback(void *vclosure, PenInput const *penInput)
 {
 	s_PenInput_pollPen_callback_closure *closure = vclosure;
 	lua_State *L = closure->L;
 
-	double px = penInput->xPos.raw / 20966.0;
-	double py = penInput->yPos.raw / 15725.0;
-	int mx = (int)(closure->screenSize.width * py);
-	int my = (int)(closure->screenSize.height * (1.0 - px));
+	int mx, my;
+	s_penScreenPosition(closure->screenSize, penInput->xPos.raw, penInput->yPos.raw, &mx, &my);
 
 	// Make a copy of the callback function.
-	lua_pushvalue(L, 2);
+	lua_pushvalue(L, closure->callbackIndex);
 
-	// Construct a Lua table describing the pen's state.
-	lua_newtable(L);
+	// Update the Lua table describing the pen's state. The same table is reused
+	// for every sync, so that polling does not create garbage.
+	lua_rawgetp(L, LUA_REGISTRYINDEX, &s_penStateKey);
 
-	lua_pushstring(L, "xPos");
 	lua_pushnumber(L, mx);
-	lua_rawset(L, -3);
+	lua_setfield(L, -2, "xPos");
 
-	lua_pushstring(L, "yPos");
 	lua_pushnumber(L, my);
-	lua_rawset(L, -3);
+	lua_setfield(L, -2, "yPos");
 
-	lua_pushstring(L, "contacting");
 	lua_pushboolean(L, penInput->touching.pressed);
-	lua_rawset(L, -3);
+	lua_setfield(L, -2, "contacting");
 
-	lua_pushstring(L, "hoverDraw");
 	lua_pushboolean(L, penInput->pen.pressed);
-	lua_rawset(L, -3);
+	lua_setfield(L, -2, "hoverDraw");
 
-	lua_pushstring(L, "hoverErase");
 	lua_pushboolean(L, penInput->eraser.pressed);
-	lua_rawset(L, -3);
+	lua_setfield(L, -2, "hoverErase");
 
-	// Invoke the function at position 3.
+	// Invoke the callback.
+	uint64_t began = Profile_begin();
 	lua_call(L, 1, 0);
+	Profile_end("pen callback", began);
 }
 
 static int s_PenInput_pollPen(lua_State *L)
@@ -261,124 +380,2329 @@ static int s_PenInput_pollPen(lua_State *L)
 	luaL_checktype(L, 2, LUA_TFUNCTION);
 
 	Rectangle screenSize = FrameBuffer_size(device->frameBuffer);
-	s_PenInput_pollPen_callback_closure closure = {L, screenSize};
+	s_PenInput_pollPen_callback_closure closure = {L, screenSize, 2};
 	PenInput_poll(pi, &closure, s_PenInput_pollPen_callback);
 
+	// Send any updates which were waiting on earlier ones.
+	FlushScheduler_service(device->scheduler);
+
+	Collector_step(device->collector);
 	return 0;
 }
 
-static int s_Clock_getSeconds(lua_State *L)
+typedef struct
 {
-	Clock *clock = luaL_checkudata(L, 1, "C-Clock");
+	Rectangle screenSize;
+	size_t count;
+	PenSample samples[PEN_HISTORY_CAPACITY];
+
+	// The last sample of the previous batch, so that strokes continue across
+	// batches.
+	bool hasPrevious;
+	PenSample previous;
+} s_PenSamples;
+
+/// `rm_pen:samples()`
+/// Takes every pen sample recorded since the previous call, including those
+/// that arrived during `rm_pen:poll` or `rm_events:wait`.
+/// RETURNS a view of the samples, which is overwritten by the next call.
+static int s_PenInput_samples(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-PenInput");
 
-	lua_pushnumber(L, Clock_getSeconds(clock));
+	lua_rawgetp(L, LUA_REGISTRYINDEX, &s_penSamplesKey);
+	s_PenSamples *view = lua_touserdata(L, -1);
+	if (view->count != 0)
+	{
+		view->hasPrevious = true;
+		view->previous = view->samples[view->count - 1];
+	}
+	view->screenSize = FrameBuffer_size(device->frameBuffer);
+	view->count = PenInput_takeSamples(device->penInput, view->samples, PEN_HISTORY_CAPACITY);
 	return 1;
 }
 
-void run_script(char const *script, PenInput *penInput, FrameBuffer *fb, SlowBuffer *sb)
+/// `rm_pen:predict(seconds)`
+/// Extrapolates the stroke in contact to where the pen will be `seconds` from
+/// now (at most 0.05), continuing from the newest sample taken by
+/// `rm_pen:samples()`. Draw it with a C-Provisional, and restore that before
+/// drawing the next samples.
+/// RETURNS a view of the predicted samples, which is empty unless the pen is in
+/// contact and moving, and is overwritten by the next call.
+static int s_PenInput_predict(lua_State *L)
 {
-	lua_State *L = luaL_newstate();
-
-	Device *vfb = lua_newuserdata(L, sizeof(Device));
-	*vfb = (Device){penInput, fb, sb};
-	if (luaL_newmetatable(L, "C-FrameBuffer"))
+	Device *device = luaL_checkudata(L, 1, "C-PenInput");
+	double seconds = luaL_checknumber(L, 2);
+
+	lua_rawgetp(L, LUA_REGISTRYINDEX, &s_penPredictionKey);
+	s_PenSamples *view = lua_touserdata(L, -1);
+	view->screenSize = FrameBuffer_size(device->frameBuffer);
+	view->count = PenInput_predict(device->penInput, seconds, view->samples, PEN_PREDICTION_SAMPLES);
+	view->hasPrevious = view->count != 0;
+	if (view->hasPrevious)
 	{
-		lua_pushstring(L, "__index");
-		lua_newtable(L);
+		view->previous = *PenInput_latestSample(device->penInput);
+	}
+	return 1;
+}
 
-		lua_pushstring(L, "setPixel");
-		lua_pushcfunction(L, s_FrameBuffer_setPixel);
-		lua_rawset(L, -3);
+/// `#samples`
+static int s_PenSamples_len(lua_State *L)
+{
+	s_PenSamples *view = luaL_checkudata(L, 1, "C-PenSamples");
+	lua_pushinteger(L, (lua_Integer)view->count);
+	return 1;
+}
 
-		lua_pushstring(L, "setRect");
-		lua_pushcfunction(L, s_FrameBuffer_setRect);
-		lua_rawset(L, -3);
+/// `samples:get(i)`
+/// RETURNS xPos, yPos, pressure (from 0 to 1), contacting, hoverDraw,
+/// hoverErase, and the time of the sample in seconds.
+static int s_PenSamples_get(lua_State *L)
+{
+	s_PenSamples *view = luaL_checkudata(L, 1, "C-PenSamples");
+	lua_Integer i = luaL_checkinteger(L, 2);
+	luaL_argcheck(L, 1 <= i && i <= (lua_Integer)view->count, 2, "sample index out of range");
 
-		lua_pushstring(L, "size");
-		lua_pushcfunction(L, s_FrameBuffer_size);
-		lua_rawset(L, -3);
+	PenSample const *sample = &view->samples[i - 1];
+	int mx, my;
+	s_penScreenPosition(view->screenSize, sample->xPos, sample->yPos, &mx, &my);
 
-		lua_pushstring(L, "flush");
-		lua_pushcfunction(L, s_FrameBuffer_flush);
-		lua_rawset(L, -3);
+	lua_pushnumber(L, mx);
+	lua_pushnumber(L, my);
+	lua_pushnumber(L, sample->pressure / 4095.0);
+	lua_pushboolean(L, (sample->buttons & PEN_BUTTON_TOUCHING) != 0);
+	lua_pushboolean(L, (sample->buttons & PEN_BUTTON_PEN) != 0);
+	lua_pushboolean(L, (sample->buttons & PEN_BUTTON_ERASER) != 0);
+	lua_pushnumber(L, sample->seconds);
+	return 7;
+}
 
-		lua_rawset(L, -3);
+/// RETURNS left, top, right, bottom of the dirty rectangle, or nothing when
+/// nothing was drawn.
+static int s_pushDirty(lua_State *L, Rectangle dirty)
+{
+	if (dirty.width == 0 || dirty.height == 0)
+	{
+		return 0;
 	}
-	lua_setmetatable(L, -2);
-	lua_setglobal(L, "rm_fb");
+	lua_pushinteger(L, dirty.left);
+	lua_pushinteger(L, dirty.top);
+	lua_pushinteger(L, dirty.left + dirty.width);
+	lua_pushinteger(L, dirty.top + dirty.height);
+	return 4;
+}
 
-	Device *vsb = lua_newuserdata(L, sizeof(Device));
-	*vsb = (Device){penInput, fb, sb};
-	if (luaL_newmetatable(L, "C-SlowBuffer"))
+/// RETURNS the parts of the Region's rectangles within `bounds`.
+static Region s_clipRegion(Region const *region, Rectangle bounds)
+{
+	Region clipped = Region_empty(region->overhead);
+	for (size_t i = 0; i < region->count; i++)
 	{
-		lua_pushstring(L, "__index");
-		lua_newtable(L);
+		Rectangle rect = region->rects[i];
+		size_t right = rect.left + rect.width < bounds.width ? rect.left + rect.width : bounds.width;
+		size_t bottom = rect.top + rect.height < bounds.height ? rect.top + rect.height : bounds.height;
+		if (rect.left < right && rect.top < bottom)
+		{
+			clipped.rects[clipped.count++] = (Rectangle){rect.left, rect.top, right - rect.left, bottom - rect.top};
+		}
+	}
+	return clipped;
+}
 
-		lua_pushstring(L, "setPixel");
-		lua_pushcfunction(L, s_SlowBuffer_setPixel);
-		lua_rawset(L, -3);
+static Region *s_checkRegion(lua_State *L, int arg)
+{
+	return luaL_checkudata(L, arg, "C-Region");
+}
 
-		lua_pushstring(L, "setRect");
-		lua_pushcfunction(L, s_SlowBuffer_setRect);
-		lua_rawset(L, -3);
+/// `rm_region.new(overhead)`
+/// `overhead`: the cost of one display update, as a number of pixels whose
+/// update would take as long. Rectangles are merged when updating their
+/// bounding box would cost no more than updating them separately.
+/// RETURNS an empty C-Region.
+static int s_Region_new(lua_State *L)
+{
+	lua_Integer overhead = luaL_optinteger(L, 1, REGION_DEFAULT_OVERHEAD);
+	luaL_argcheck(L, overhead >= 0, 1, "negative overhead");
 
-		lua_pushstring(L, "size");
-		lua_pushcfunction(L, s_SlowBuffer_size);
-		lua_rawset(L, -3);
+	Region *region = lua_newuserdata(L, sizeof(Region));
+	*region = Region_empty((size_t)overhead);
+	luaL_setmetatable(L, "C-Region");
+	return 1;
+}
 
-		lua_pushstring(L, "flush");
-		lua_pushcfunction(L, s_SlowBuffer_flush);
-		lua_rawset(L, -3);
+/// `region:add(left, top, right, bottom)`
+/// Adds the pixels `[left, right) x [top, bottom)`; negative coordinates are
+/// clamped to 0.
+static int s_Region_add(lua_State *L)
+{
+	Region *region = s_checkRegion(L, 1);
+	lua_Integer left = luaL_checkinteger(L, 2);
+	lua_Integer top = luaL_checkinteger(L, 3);
+	lua_Integer right = luaL_checkinteger(L, 4);
+	lua_Integer bottom = luaL_checkinteger(L, 5);
+	left = left < 0 ? 0 : left;
+	top = top < 0 ? 0 : top;
+	if (left < right && top < bottom)
+	{
+		Region_add(region, (Rectangle){left, top, right - left, bottom - top});
+	}
+	return 0;
+}
 
-		lua_rawset(L, -3);
+/// `region:clear()`
+static int s_Region_clear(lua_State *L)
+{
+	Region *region = s_checkRegion(L, 1);
+	region->count = 0;
+	return 0;
+}
+
+/// `#region`
+/// RETURNS the number of (non-overlapping) rectangles in the region.
+static int s_Region_len(lua_State *L)
+{
+	Region *region = s_checkRegion(L, 1);
+	lua_pushinteger(L, region->count);
+	return 1;
+}
+
+/// `region:get(i)`
+/// RETURNS left, top, right, bottom of the `i`th rectangle.
+static int s_Region_get(lua_State *L)
+{
+	Region *region = s_checkRegion(L, 1);
+	lua_Integer i = luaL_checkinteger(L, 2);
+	luaL_argcheck(L, 1 <= i && i <= (lua_Integer)region->count, 2, "index out of range");
+	return s_pushDirty(L, region->rects[i - 1]);
+}
+
+/// `region:bounds()`
+/// RETURNS left, top, right, bottom of the bounding box, or nothing when the
+/// region is empty.
+static int s_Region_bounds(lua_State *L)
+{
+	Region *region = s_checkRegion(L, 1);
+	return s_pushDirty(L, Region_bounds(region));
+}
+
+/// `region:area()`
+/// RETURNS the number of pixels the region's rectangles cover.
+static int s_Region_area(lua_State *L)
+{
+	Region *region = s_checkRegion(L, 1);
+	lua_pushinteger(L, Region_area(region));
+	return 1;
+}
+
+/// `rm_fb:flushRegion(region, waveform)`
+/// Flushes each rectangle of the region (clipped to the screen) as its own
+/// update.
+/// RETURNS the marker of the last update, or 0 when there was none.
+static int s_FrameBuffer_flushRegion(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-FrameBuffer");
+	Region *region = s_checkRegion(L, 2);
+	lua_Integer waveform = luaL_checkinteger(L, 3);
+
+	Region clipped = s_clipRegion(region, FrameBuffer_size(device->frameBuffer));
+	lua_pushinteger(L, FrameBuffer_flushRegion(device->frameBuffer, &clipped, waveform));
+	Collector_step(device->collector);
+	return 1;
+}
+
+/// `rm_sb:flushRegion(region)`
+/// Flushes each rectangle of the region (clipped to the screen), batching the
+/// pixels which are ready into updates by the region's overhead.
+static int s_SlowBuffer_flushRegion(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-SlowBuffer");
+	Region *region = s_checkRegion(L, 2);
+
+	Region clipped = s_clipRegion(region, SlowBuffer_size(device->slowBuffer));
+	SlowBuffer_flushRegion(device->slowBuffer, &clipped);
+	Collector_step(device->collector);
+	return 0;
+}
+
+static StrokePoint s_strokePoint(s_PenSamples const *view, PenSample const *sample, Brush brush)
+{
+	StrokePoint point;
+	s_penScreenPoint(view->screenSize, sample->xPos, sample->yPos, &point.x, &point.y);
+
+	double tilt = sqrt((double)sample->xTilt * sample->xTilt + (double)sample->yTilt * sample->yTilt) / 9000.0;
+	point.radius = Brush_radius(brush, sample->pressure / 4095.0, tilt);
+	return point;
+}
+
+static Provisional *s_checkProvisional(lua_State *L, int arg)
+{
+	Provisional **vprovisional = luaL_checkudata(L, arg, "C-Provisional");
+	luaL_argcheck(L, *vprovisional != NULL, arg, "provisional is not allocated");
+	return *vprovisional;
+}
+
+/// Draws the parts of the samples where the pen is in contact, as a stroke
+/// with arguments `(samples, color, minRadius, maxRadius, tiltGrowth,
+/// provisional)` at stack index 2.
+/// RETURNS left, top, right, bottom of the changed pixels, or nothing.
+static int s_strokeSamples(lua_State *L, Raster raster, lua_Integer maximumColor)
+{
+	s_PenSamples const *view = luaL_checkudata(L, 2, "C-PenSamples");
+	lua_Integer icolor = luaL_checkinteger(L, 3);
+	Brush brush;
+	brush.minRadius = luaL_checknumber(L, 4);
+	brush.maxRadius = luaL_optnumber(L, 5, brush.minRadius);
+	brush.tiltGrowth = luaL_optnumber(L, 6, 0);
+
+	if (icolor < 0 || icolor > maximumColor)
+	{
+		luaL_error(L, "invalid color `%d`", icolor);
 	}
-	lua_setmetatable(L, -2);
-	lua_setglobal(L, "rm_sb");
 
-	Device *vpi = lua_newuserdata(L, sizeof(Device));
-	*vpi = (Device){penInput, fb, sb};
-	if (luaL_newmetatable(L, "C-PenInput"))
+	if (!lua_isnoneornil(L, 7))
 	{
-		lua_pushstring(L, "__index");
-		lua_newtable(L);
+		Provisional *provisional = s_checkProvisional(L, 7);
+		void const *holding = Provisional_target(provisional);
+		luaL_argcheck(L, holding == NULL || holding == raster.target, 7, "provisional holds pixels of another buffer");
+		raster = Provisional_raster(provisional, raster);
+	}
 
-		lua_pushstring(L, "poll");
-		lua_pushcfunction(L, s_PenInput_pollPen);
-		lua_rawset(L, -3);
+	Rectangle dirty = {0, 0, 0, 0};
+	PenSample const *previous = view->hasPrevious ? &view->previous : NULL;
+	for (size_t i = 0; i < view->count; i++)
+	{
+		PenSample const *sample = &view->samples[i];
+		if (sample->buttons & PEN_BUTTON_TOUCHING)
+		{
+			StrokePoint to = s_strokePoint(view, sample, brush);
+			StrokePoint from = to;
+			if (previous != NULL && (previous->buttons & PEN_BUTTON_TOUCHING))
+			{
+				from = s_strokePoint(view, previous, brush);
+			}
+			Stroke_segment(raster, from, to, (uint16_t)icolor, &dirty);
+		}
+		previous = sample;
+	}
 
-		lua_rawset(L, -3);
+	return s_pushDirty(L, dirty);
+}
+
+/// `rm_fb:stroke(samples, color, minRadius, maxRadius, tiltGrowth, provisional)`
+/// Draws the pen samples from `rm_pen:samples()` as a freehand stroke whose
+/// radius varies with pressure from `minRadius` to `maxRadius`, and grows by
+/// the fraction `tiltGrowth` when the pen is fully tilted. With a
+/// C-Provisional, the stroke can be taken back by `provisional:restore()`.
+/// RETURNS left, top, right, bottom of the changed pixels, or nothing.
+static int s_FrameBuffer_stroke(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-FrameBuffer");
+	return s_strokeSamples(L, Raster_frameBuffer(device->frameBuffer), UINT16_MAX);
+}
+
+/// `rm_sb:stroke(samples, color, minRadius, maxRadius, tiltGrowth, provisional)`
+/// See `rm_fb:stroke`.
+static int s_SlowBuffer_stroke(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-SlowBuffer");
+	return s_strokeSamples(L, Raster_slowBuffer(device->slowBuffer), UINT8_MAX);
+}
+
+/// `rm_provisional.new()`
+/// RETURNS a C-Provisional, which holds nothing.
+static int s_Provisional_new(lua_State *L)
+{
+	Provisional **vprovisional = lua_newuserdata(L, sizeof(Provisional *));
+	*vprovisional = NULL;
+	luaL_setmetatable(L, "C-Provisional");
+	*vprovisional = Provisional_allocate();
+	if (*vprovisional == NULL)
+	{
+		luaL_error(L, "could not allocate a provisional");
 	}
-	lua_setmetatable(L, -2);
-	lua_setglobal(L, "rm_pen");
+	return 1;
+}
 
-	Clock *monotonicClock = lua_newuserdata(L, sizeof(Clock));
-	*monotonicClock = Clock_monotonic();
-	if (luaL_newmetatable(L, "C-Clock"))
+static int s_Provisional_gc(lua_State *L)
+{
+	Provisional **vprovisional = luaL_checkudata(L, 1, "C-Provisional");
+	if (*vprovisional != NULL)
 	{
-		lua_pushstring(L, "__index");
-		lua_newtable(L);
+		Provisional_deallocate(*vprovisional);
+		*vprovisional = NULL;
+	}
+	return 0;
+}
 
-		lua_pushstring(L, "getSeconds");
-		lua_pushcfunction(L, s_Clock_getSeconds);
-		lua_rawset(L, -3);
+/// `provisional:restore()`
+/// Puts back the pixels under everything drawn with the provisional since the
+/// previous restore.
+/// RETURNS left, top, right, bottom of the restored pixels, or nothing.
+static int s_Provisional_restore(lua_State *L)
+{
+	Provisional *provisional = s_checkProvisional(L, 1);
+	Rectangle dirty = {0, 0, 0, 0};
+	Provisional_restore(provisional, &dirty);
+	return s_pushDirty(L, dirty);
+}
 
-		lua_rawset(L, -3);
-	}
-	lua_setmetatable(L, -2);
-	lua_setglobal(L, "rm_monotonic");
+static Surface *s_checkSurface(lua_State *L, int arg)
+{
+	Surface **vsurface = luaL_checkudata(L, arg, "C-Surface");
+	luaL_argcheck(L, *vsurface != NULL, arg, "surface is not allocated");
+	return *vsurface;
+}
 
-	Clock **calendar1970Clock = lua_newuserdata(L, sizeof(Clock));
-	luaL_newmetatable(L, "C-Clock");
-	lua_setmetatable(L, -2);
-	lua_setglobal(L, "rm_calendar");
+/// Checks that the argument at stack index `arg` is `rm_fb`, `rm_sb`, or a
+/// C-Surface.
+/// RETURNS a Raster drawing into it, and the largest color it accepts.
+static Raster s_checkRasterAt(lua_State *L, int arg, lua_Integer *maximumColor)
+{
+	Device *device = luaL_testudata(L, arg, "C-FrameBuffer");
+	if (device != NULL)
+	{
+		*maximumColor = UINT16_MAX;
+		return Raster_frameBuffer(device->frameBuffer);
+	}
 
-	luaL_openlibs(L);
+	device = luaL_testudata(L, arg, "C-SlowBuffer");
+	if (device != NULL)
+	{
+		*maximumColor = UINT8_MAX;
+		return Raster_slowBuffer(device->slowBuffer);
+	}
 
-	if (luaL_dofile(L, script) != LUA_OK)
+	if (luaL_testudata(L, arg, "C-Surface") == NULL)
 	{
-		fprintf(stderr, "run_script: error running `%s`\n", script);
-		fprintf(stderr, "\t```%s```\n", lua_tostring(L, -1));
+		luaL_argerror(L, arg, "expected `rm_fb`, `rm_sb`, or a surface");
 	}
+	Surface *surface = s_checkSurface(L, arg);
+	*maximumColor = (lua_Integer)((UINT32_C(1) << Surface_bits(surface)) - 1);
+	return Raster_surface(surface);
+}
+
+/// Checks that the first argument is `rm_fb`, `rm_sb`, or a C-Surface.
+/// RETURNS a Raster drawing into it, and the largest color it accepts.
+static Raster s_checkRaster(lua_State *L, lua_Integer *maximumColor)
+{
+	return s_checkRasterAt(L, 1, maximumColor);
+}
 
-	lua_close(L);
+static uint16_t s_checkColor(lua_State *L, int arg, lua_Integer maximumColor)
+{
+	lua_Integer icolor = luaL_checkinteger(L, arg);
+	if (icolor < 0 || icolor > maximumColor)
+	{
+		luaL_error(L, "invalid color `%d`", icolor);
+	}
+	return (uint16_t)icolor;
+}
+
+/// Reads an optional clipping rectangle `left, top, right, bottom` starting at
+/// stack index `arg`.
+/// RETURNS the Raster, clipped to it.
+static Raster s_optClip(lua_State *L, int arg, Raster raster)
+{
+	if (lua_isnoneornil(L, arg))
+	{
+		return raster;
+	}
+
+	lua_Integer left = luaL_checkinteger(L, arg);
+	lua_Integer top = luaL_checkinteger(L, arg + 1);
+	lua_Integer right = luaL_checkinteger(L, arg + 2);
+	lua_Integer bottom = luaL_checkinteger(L, arg + 3);
+	left = left < 0 ? 0 : left;
+	top = top < 0 ? 0 : top;
+	if (right <= left || bottom <= top)
+	{
+		return Raster_clip(raster, (Rectangle){0, 0, 0, 0});
+	}
+	return Raster_clip(raster, (Rectangle){left, top, right - left, bottom - top});
+}
+
+// The drawing methods below are shared by `rm_fb`, `rm_sb`, and surfaces. Each takes an
+// optional clipping rectangle `left, top, right, bottom` as its last
+// arguments, and RETURNS left, top, right, bottom of the changed pixels, or
+// nothing.
+
+/// `fb:line(x1, y1, x2, y2, color, width, ...clip)`
+static int s_Raster_line(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	lua_Integer x1 = luaL_checkinteger(L, 2);
+	lua_Integer y1 = luaL_checkinteger(L, 3);
+	lua_Integer x2 = luaL_checkinteger(L, 4);
+	lua_Integer y2 = luaL_checkinteger(L, 5);
+	uint16_t color = s_checkColor(L, 6, maximumColor);
+	lua_Number width = luaL_optnumber(L, 7, 1);
+	raster = s_optClip(L, 8, raster);
+
+	Rectangle dirty = {0, 0, 0, 0};
+	Draw_line(raster, x1, y1, x2, y2, width, color, &dirty);
+	return s_pushDirty(L, dirty);
+}
+
+// The number of polyline points which are read from Lua at a time.
+#define POLYLINE_CHUNK 128
+
+/// `fb:polyline({x1, y1, x2, y2, ...}, color, width, ...clip)`
+static int s_Raster_polyline(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	luaL_checktype(L, 2, LUA_TTABLE);
+	uint16_t color = s_checkColor(L, 3, maximumColor);
+	lua_Number width = luaL_optnumber(L, 4, 1);
+	raster = s_optClip(L, 5, raster);
+
+	lua_Integer length = luaL_len(L, 2);
+	if (length % 2 != 0)
+	{
+		luaL_error(L, "polyline coordinates have odd length `%d`", length);
+	}
+
+	Rectangle dirty = {0, 0, 0, 0};
+	long xy[2 * POLYLINE_CHUNK];
+	size_t count = 0;
+	for (lua_Integer i = 1; i <= length; i++)
+	{
+		lua_rawgeti(L, 2, i);
+		int isInteger;
+		xy[count * 2 + (i + 1) % 2] = (long)lua_tointegerx(L, -1, &isInteger);
+		lua_pop(L, 1);
+		if (!isInteger)
+		{
+			luaL_error(L, "polyline coordinate %d is not an integer", i);
+		}
+
+		if (i % 2 == 0)
+		{
+			count += 1;
+			if (count == POLYLINE_CHUNK || i == length)
+			{
+				Draw_polyline(raster, xy, count, width, color, &dirty);
+
+				// The next chunk continues from the last point.
+				xy[0] = xy[2 * count - 2];
+				xy[1] = xy[2 * count - 1];
+				count = 1;
+			}
+		}
+	}
+	return s_pushDirty(L, dirty);
+}
+
+/// `fb:fillCircle(cx, cy, radius, color, ...clip)`
+static int s_Raster_fillCircle(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	lua_Integer cx = luaL_checkinteger(L, 2);
+	lua_Integer cy = luaL_checkinteger(L, 3);
+	lua_Number radius = luaL_checknumber(L, 4);
+	uint16_t color = s_checkColor(L, 5, maximumColor);
+	raster = s_optClip(L, 6, raster);
+
+	Rectangle dirty = {0, 0, 0, 0};
+	Draw_fillCircle(raster, cx, cy, radius, color, &dirty);
+	return s_pushDirty(L, dirty);
+}
+
+/// `fb:circle(cx, cy, radius, color, width, ...clip)`
+static int s_Raster_circle(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	lua_Integer cx = luaL_checkinteger(L, 2);
+	lua_Integer cy = luaL_checkinteger(L, 3);
+	lua_Number radius = luaL_checknumber(L, 4);
+	uint16_t color = s_checkColor(L, 5, maximumColor);
+	lua_Number width = luaL_optnumber(L, 6, 1);
+	raster = s_optClip(L, 7, raster);
+
+	Rectangle dirty = {0, 0, 0, 0};
+	Draw_circle(raster, cx, cy, radius, width, color, &dirty);
+	return s_pushDirty(L, dirty);
+}
+
+/// `fb:rectangle(left, top, right, bottom, color, width, ...clip)`
+/// Draws the outline of the rectangle, inside of it.
+static int s_Raster_rectangle(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	lua_Integer left = luaL_checkinteger(L, 2);
+	lua_Integer top = luaL_checkinteger(L, 3);
+	lua_Integer right = luaL_checkinteger(L, 4);
+	lua_Integer bottom = luaL_checkinteger(L, 5);
+	uint16_t color = s_checkColor(L, 6, maximumColor);
+	lua_Integer width = luaL_optinteger(L, 7, 1);
+	raster = s_optClip(L, 8, raster);
+
+	Rectangle dirty = {0, 0, 0, 0};
+	Draw_rectangle(raster, left, top, right, bottom, width, color, &dirty);
+	return s_pushDirty(L, dirty);
+}
+
+/// `rm_font.new(fontData, kern, missingAdvance)`
+/// `fontData` is a table of `width` (at most 32), `height`, `baseline`, and
+/// `glyphs`, which maps each character to its rows as integers whose least
+/// significant bit is the leftmost pixel.
+/// RETURNS a C-Font.
+static int s_Font_new(lua_State *L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+	lua_Integer kern = luaL_checkinteger(L, 2);
+	lua_Integer missingAdvance = luaL_checkinteger(L, 3);
+
+	lua_getfield(L, 1, "width");
+	lua_Integer width = luaL_checkinteger(L, -1);
+	lua_getfield(L, 1, "height");
+	lua_Integer height = luaL_checkinteger(L, -1);
+	lua_getfield(L, 1, "baseline");
+	lua_Integer baseline = luaL_checkinteger(L, -1);
+	lua_pop(L, 3);
+	luaL_argcheck(L, 0 < width && width <= 32, 1, "glyphs must be 1 to 32 pixels wide");
+	luaL_argcheck(L, 0 < height && height <= 256, 1, "glyphs must be 1 to 256 pixels high");
+
+	Font **vfont = lua_newuserdata(L, sizeof(Font *));
+	*vfont = NULL;
+	luaL_setmetatable(L, "C-Font");
+	*vfont = Font_allocate((size_t)height, (size_t)baseline, kern, missingAdvance);
+	if (*vfont == NULL)
+	{
+		luaL_error(L, "could not allocate a font");
+	}
+
+	// Bits beyond the font's width are not part of the glyphs.
+	uint32_t mask = (uint32_t)((UINT64_C(1) << width) - 1);
+	uint32_t rows[256];
+	lua_getfield(L, 1, "glyphs");
+	luaL_checktype(L, -1, LUA_TTABLE);
+	lua_pushnil(L);
+	while (lua_next(L, -2) != 0)
+	{
+		// lua_tolstring would convert a numeric key in place, which confuses
+		// lua_next, so check the type first.
+		size_t length = 0;
+		char const *character = NULL;
+		if (lua_type(L, -2) == LUA_TSTRING)
+		{
+			character = lua_tolstring(L, -2, &length);
+		}
+		if (character == NULL || length != 1)
+		{
+			luaL_error(L, "glyph keys must be single characters");
+		}
+
+		for (lua_Integer y = 0; y < height; y++)
+		{
+			lua_rawgeti(L, -1, y + 1);
+			rows[y] = (uint32_t)lua_tointeger(L, -1) & mask;
+			lua_pop(L, 1);
+		}
+		Font_setGlyph(*vfont, (unsigned char)character[0], rows);
+		lua_pop(L, 1);
+	}
+	lua_pop(L, 1);
+	return 1;
+}
+
+/// `rm_font.load(path)`
+/// RETURNS a C-Font read from the binary font file at `path`, or `nil` and an
+/// error message.
+static int s_Font_load(lua_State *L)
+{
+	char const *path = luaL_checkstring(L, 1);
+
+	Font **vfont = lua_newuserdata(L, sizeof(Font *));
+	*vfont = NULL;
+	luaL_setmetatable(L, "C-Font");
+	*vfont = Font_load(path);
+	if (*vfont == NULL)
+	{
+		lua_pushnil(L);
+		lua_pushfstring(L, "could not load font `%s`", path);
+		return 2;
+	}
+	return 1;
+}
+
+static Font *s_checkFont(lua_State *L, int arg)
+{
+	Font **vfont = luaL_checkudata(L, arg, "C-Font");
+	luaL_argcheck(L, *vfont != NULL, arg, "font is not loaded");
+	return *vfont;
+}
+
+static int s_Font_gc(lua_State *L)
+{
+	Font **vfont = luaL_checkudata(L, 1, "C-Font");
+	if (*vfont != NULL)
+	{
+		Font_deallocate(*vfont);
+		*vfont = NULL;
+	}
+	return 0;
+}
+
+/// `font:setExtent(character, left, right)`
+/// Draws only the columns `left` to `right` (counting from 1) of the glyph.
+static int s_Font_setExtent(lua_State *L)
+{
+	Font *font = s_checkFont(L, 1);
+	size_t length;
+	char const *character = luaL_checklstring(L, 2, &length);
+	lua_Integer left = luaL_checkinteger(L, 3);
+	lua_Integer right = luaL_checkinteger(L, 4);
+	luaL_argcheck(L, length == 1, 2, "expected a single character");
+	luaL_argcheck(L, 1 <= left && left <= 32, 3, "column out of range");
+	luaL_argcheck(L, left - 1 <= right && right <= 32, 4, "column out of range");
+
+	Font_setExtent(font, (unsigned char)character[0], (size_t)(left - 1), (size_t)(right - left + 1));
+	return 0;
+}
+
+/// `font:measure(text)`
+/// RETURNS the distance to advance x past `text`.
+static int s_Font_measure(lua_State *L)
+{
+	Font *font = s_checkFont(L, 1);
+	size_t length;
+	char const *text = luaL_checklstring(L, 2, &length);
+	lua_pushinteger(L, Font_measure(font, text, length));
+	return 1;
+}
+
+/// `fb:drawString(font, x, y, text, color, ...clip)`
+/// Draws `text` starting at `x` with its baseline on row `y`.
+/// RETURNS the distance to advance x past `text`, then left, top, right,
+/// bottom of the changed pixels (if any).
+static int s_Raster_drawString(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	Font *font = s_checkFont(L, 2);
+	lua_Integer x = luaL_checkinteger(L, 3);
+	lua_Integer y = luaL_checkinteger(L, 4);
+	size_t length;
+	char const *text = luaL_checklstring(L, 5, &length);
+	uint16_t color = s_checkColor(L, 6, maximumColor);
+	raster = s_optClip(L, 7, raster);
+
+	Rectangle dirty = {0, 0, 0, 0};
+	lua_pushinteger(L, Font_draw(font, raster, x, y, text, length, color, &dirty));
+	return 1 + s_pushDirty(L, dirty);
+}
+
+/// `fb:blit(source, left, top, right, bottom, x, y, mask, ...clip)`
+/// Copies the rectangle `[left, right) x [top, bottom)` of `source` (which may
+/// be `rm_fb`, `rm_sb`, or a surface) so that its top left is at (x, y).
+/// When `mask` is given, only the pixels where it is nonzero are copied; its
+/// top left corresponds to (left, top) of `source`.
+/// Colors are copied as they are, so a 16-bit source copied to an 8-bit target
+/// keeps only the low 8 bits of each pixel.
+static int s_Raster_blit(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	Raster source = s_checkRasterAt(L, 2, &maximumColor);
+	lua_Integer left = luaL_checkinteger(L, 3);
+	lua_Integer top = luaL_checkinteger(L, 4);
+	lua_Integer right = luaL_checkinteger(L, 5);
+	lua_Integer bottom = luaL_checkinteger(L, 6);
+	lua_Integer x = luaL_checkinteger(L, 7);
+	lua_Integer y = luaL_checkinteger(L, 8);
+	Raster mask;
+	bool hasMask = !lua_isnoneornil(L, 9);
+	if (hasMask)
+	{
+		mask = s_checkRasterAt(L, 9, &maximumColor);
+	}
+	raster = s_optClip(L, 10, raster);
+
+	// Parts of the rectangle beyond the source's top left are not copied.
+	if (left < 0)
+	{
+		x -= left;
+		left = 0;
+	}
+	if (top < 0)
+	{
+		y -= top;
+		top = 0;
+	}
+
+	Rectangle dirty = {0, 0, 0, 0};
+	if (left < right && top < bottom)
+	{
+		Rectangle from = {left, top, right - left, bottom - top};
+		Draw_blit(raster, source, from, x, y, hasMask ? &mask : NULL, &dirty);
+	}
+	return s_pushDirty(L, dirty);
+}
+
+/// `fb:copyRect(left, top, right, bottom, x, y, ...clip)`
+/// Moves the rectangle `[left, right) x [top, bottom)` so that its top left is
+/// at (x, y), such as to scroll. The areas may overlap.
+static int s_Raster_copyRect(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	lua_Integer left = luaL_checkinteger(L, 2);
+	lua_Integer top = luaL_checkinteger(L, 3);
+	lua_Integer right = luaL_checkinteger(L, 4);
+	lua_Integer bottom = luaL_checkinteger(L, 5);
+	lua_Integer x = luaL_checkinteger(L, 6);
+	lua_Integer y = luaL_checkinteger(L, 7);
+	Raster clipped = s_optClip(L, 8, raster);
+
+	if (left < 0)
+	{
+		x -= left;
+		left = 0;
+	}
+	if (top < 0)
+	{
+		y -= top;
+		top = 0;
+	}
+
+	Rectangle dirty = {0, 0, 0, 0};
+	if (left < right && top < bottom)
+	{
+		Rectangle from = {left, top, right - left, bottom - top};
+		Draw_blit(clipped, raster, from, x, y, NULL, &dirty);
+	}
+	return s_pushDirty(L, dirty);
+}
+
+/// `fb:stamp(mask, x, y, color, ...clip)`
+/// Fills with `color` the pixels where `mask` (`rm_fb`, `rm_sb`, or a surface,
+/// typically with 1 bit) is nonzero, with its top left at (x, y).
+static int s_Raster_stamp(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	lua_Integer maskColor;
+	Raster mask = s_checkRasterAt(L, 2, &maskColor);
+	lua_Integer x = luaL_checkinteger(L, 3);
+	lua_Integer y = luaL_checkinteger(L, 4);
+	uint16_t color = s_checkColor(L, 5, maximumColor);
+	raster = s_optClip(L, 6, raster);
+
+	Rectangle dirty = {0, 0, 0, 0};
+	Draw_stamp(raster, mask, x, y, color, &dirty);
+	return s_pushDirty(L, dirty);
+}
+
+/// Adds the drawing methods to the table on top of the stack.
+static void s_addDrawingMethods(lua_State *L)
+{
+	lua_pushstring(L, "line");
+	lua_pushcfunction(L, s_Raster_line);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "polyline");
+	lua_pushcfunction(L, s_Raster_polyline);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "fillCircle");
+	lua_pushcfunction(L, s_Raster_fillCircle);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "circle");
+	lua_pushcfunction(L, s_Raster_circle);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "rectangle");
+	lua_pushcfunction(L, s_Raster_rectangle);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "drawString");
+	lua_pushcfunction(L, s_Raster_drawString);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "blit");
+	lua_pushcfunction(L, s_Raster_blit);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "copyRect");
+	lua_pushcfunction(L, s_Raster_copyRect);
+	lua_rawset(L, -3);
+
+	lua_pushstring(L, "stamp");
+	lua_pushcfunction(L, s_Raster_stamp);
+	lua_rawset(L, -3);
+}
+
+/// `rm_surface.new(width, height, bits)`
+/// `bits` is 1, 8, or 16 (the default). Every pixel starts as 0. Each side is at
+/// most 32768 pixels.
+/// RETURNS a C-Surface, which has the drawing methods of `rm_fb`.
+static int s_Surface_new(lua_State *L)
+{
+	lua_Integer width = luaL_checkinteger(L, 1);
+	lua_Integer height = luaL_checkinteger(L, 2);
+	lua_Integer bits = luaL_optinteger(L, 3, 16);
+	if (width < 0 || width > SURFACE_MAX_SIDE)
+	{
+		return luaL_argerror(L, 1, lua_pushfstring(L, "the width must be from 0 to %d", SURFACE_MAX_SIDE));
+	}
+	if (height < 0 || height > SURFACE_MAX_SIDE)
+	{
+		return luaL_argerror(L, 2, lua_pushfstring(L, "the height must be from 0 to %d", SURFACE_MAX_SIDE));
+	}
+	luaL_argcheck(L, bits == 1 || bits == 8 || bits == 16, 3, "expected 1, 8, or 16 bits");
+
+	Surface **vsurface = lua_newuserdata(L, sizeof(Surface *));
+	*vsurface = NULL;
+	luaL_setmetatable(L, "C-Surface");
+	*vsurface = Surface_allocate((size_t)width, (size_t)height, (unsigned)bits);
+	if (*vsurface == NULL)
+	{
+		luaL_error(L, "could not allocate a surface");
+	}
+	return 1;
+}
+
+static int s_Surface_gc(lua_State *L)
+{
+	Surface **vsurface = luaL_checkudata(L, 1, "C-Surface");
+	if (*vsurface != NULL)
+	{
+		Surface_deallocate(*vsurface);
+		*vsurface = NULL;
+	}
+	return 0;
+}
+
+/// `surface:size()`
+/// RETURNS the width and height, and the number of bits per pixel.
+static int s_Surface_size(lua_State *L)
+{
+	Surface *surface = s_checkSurface(L, 1);
+	Rectangle size = Surface_size(surface);
+	lua_pushinteger(L, size.width);
+	lua_pushinteger(L, size.height);
+	lua_pushinteger(L, Surface_bits(surface));
+	return 3;
+}
+
+/// `surface:setPixel(x, y, color)`
+static int s_Surface_setPixel(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	lua_Integer x = luaL_checkinteger(L, 2);
+	lua_Integer y = luaL_checkinteger(L, 3);
+	uint16_t color = s_checkColor(L, 4, maximumColor);
+
+	Rectangle dirty = {0, 0, 0, 0};
+	Raster_fillSpan(raster, x, x + 1, y, color, &dirty);
+	return 0;
+}
+
+/// `surface:setRect(left, top, right, bottom, color)`
+static int s_Surface_setRect(lua_State *L)
+{
+	lua_Integer maximumColor;
+	Raster raster = s_checkRaster(L, &maximumColor);
+	lua_Integer left = luaL_checkinteger(L, 2);
+	lua_Integer top = luaL_checkinteger(L, 3);
+	lua_Integer right = luaL_checkinteger(L, 4);
+	lua_Integer bottom = luaL_checkinteger(L, 5);
+	uint16_t color = s_checkColor(L, 6, maximumColor);
+
+	Rectangle dirty = {0, 0, 0, 0};
+	top = top < 0 ? 0 : top;
+	bottom = bottom < (lua_Integer)raster.height ? bottom : (lua_Integer)raster.height;
+	for (lua_Integer y = top; y < bottom; y++)
+	{
+		Raster_fillSpan(raster, left, right, y, color, &dirty);
+	}
+	return 0;
+}
+
+/// `surface:getPixel(x, y)`
+/// RETURNS the color of the pixel, or `nil` if it is outside the surface.
+static int s_Surface_getPixel(lua_State *L)
+{
+	Surface *surface = s_checkSurface(L, 1);
+	lua_Integer x = luaL_checkinteger(L, 2);
+	lua_Integer y = luaL_checkinteger(L, 3);
+
+	Rectangle size = Surface_size(surface);
+	if (x < 0 || x >= (lua_Integer)size.width || y < 0 || y >= (lua_Integer)size.height)
+	{
+		lua_pushnil(L);
+		return 1;
+	}
+
+	uint16_t color;
+	Surface_readSpan(surface, (size_t)x, (size_t)y, &color, 1);
+	lua_pushinteger(L, color);
+	return 1;
+}
+
+static Scene *s_checkScene(lua_State *L, int arg)
+{
+	Scene **vscene = luaL_checkudata(L, arg, "C-Scene");
+	luaL_argcheck(L, *vscene != NULL, arg, "scene is not allocated");
+	return *vscene;
+}
+
+/// `rm_scene.new(width, height, background)`
+/// RETURNS a C-Scene, entirely damaged, whose `background` color (white by
+/// default) is under every node.
+static int s_Scene_new(lua_State *L)
+{
+	lua_Integer width = luaL_checkinteger(L, 1);
+	lua_Integer height = luaL_checkinteger(L, 2);
+	uint16_t background = UINT16_MAX;
+	if (!lua_isnoneornil(L, 3))
+	{
+		background = s_checkColor(L, 3, UINT16_MAX);
+	}
+	luaL_argcheck(L, width >= 0, 1, "negative width");
+	luaL_argcheck(L, height >= 0, 2, "negative height");
+
+	Scene **vscene = lua_newuserdata(L, sizeof(Scene *));
+	*vscene = NULL;
+	luaL_setmetatable(L, "C-Scene");
+	*vscene = Scene_allocate((size_t)width, (size_t)height, background);
+	if (*vscene == NULL)
+	{
+		luaL_error(L, "could not allocate a scene");
+	}
+
+	// The uservalue maps node IDs to the fonts and surfaces they draw, so that
+	// those are not collected while the Scene refers to them.
+	lua_newtable(L);
+	lua_setuservalue(L, -2);
+	return 1;
+}
+
+static int s_Scene_gc(lua_State *L)
+{
+	Scene **vscene = luaL_checkudata(L, 1, "C-Scene");
+	if (*vscene != NULL)
+	{
+		Scene_deallocate(*vscene);
+		*vscene = NULL;
+	}
+	return 0;
+}
+
+/// Reads the arguments for a node of the given kind starting at stack index
+/// `arg`:
+///   SCENE_BOX: left, top, right, bottom, color
+///   SCENE_LINE: x1, y1, x2, y2, color, width
+///   SCENE_TEXT: font, x, y, text, color, ...clip
+///   SCENE_IMAGE: surface, x, y, mask
+static SceneNode s_checkSceneNode(lua_State *L, SceneNodeKind kind, int arg)
+{
+	SceneNode node = {.kind = kind};
+	switch (kind)
+	{
+	case SCENE_BOX:
+	case SCENE_LINE:
+		node.x1 = luaL_checkinteger(L, arg);
+		node.y1 = luaL_checkinteger(L, arg + 1);
+		node.x2 = luaL_checkinteger(L, arg + 2);
+		node.y2 = luaL_checkinteger(L, arg + 3);
+		node.color = s_checkColor(L, arg + 4, UINT16_MAX);
+		node.width = luaL_optnumber(L, arg + 5, 1);
+		break;
+	case SCENE_TEXT:
+		node.font = s_checkFont(L, arg);
+		node.x1 = luaL_checkinteger(L, arg + 1);
+		node.y1 = luaL_checkinteger(L, arg + 2);
+		node.text = luaL_checklstring(L, arg + 3, &node.length);
+		node.color = s_checkColor(L, arg + 4, UINT16_MAX);
+		if (!lua_isnoneornil(L, arg + 5))
+		{
+			node.clipped = true;
+			node.clipLeft = luaL_checkinteger(L, arg + 5);
+			node.clipTop = luaL_checkinteger(L, arg + 6);
+			node.clipRight = luaL_checkinteger(L, arg + 7);
+			node.clipBottom = luaL_checkinteger(L, arg + 8);
+		}
+		break;
+	case SCENE_IMAGE:
+		node.surface = s_checkSurface(L, arg);
+		node.x1 = luaL_checkinteger(L, arg + 1);
+		node.y1 = luaL_checkinteger(L, arg + 2);
+		if (!lua_isnoneornil(L, arg + 3))
+		{
+			node.mask = s_checkSurface(L, arg + 3);
+		}
+		break;
+	}
+	return node;
+}
+
+/// Keeps the font or surfaces of the node with arguments at stack index `arg`
+/// referenced from the Scene at stack index 1.
+static void s_Scene_keep(lua_State *L, SceneId id, SceneNodeKind kind, int arg)
+{
+	lua_getuservalue(L, 1);
+	if (kind == SCENE_TEXT || kind == SCENE_IMAGE)
+	{
+		lua_createtable(L, 2, 0);
+		lua_pushvalue(L, arg);
+		lua_rawseti(L, -2, 1);
+		if (kind == SCENE_IMAGE)
+		{
+			lua_pushvalue(L, arg + 3);
+			lua_rawseti(L, -2, 2);
+		}
+	}
+	else
+	{
+		lua_pushnil(L);
+	}
+	lua_rawseti(L, -2, id);
+	lua_pop(L, 1);
+}
+
+static int s_Scene_add(lua_State *L, SceneNodeKind kind)
+{
+	Scene *scene = s_checkScene(L, 1);
+	SceneNode node = s_checkSceneNode(L, kind, 2);
+	SceneId id = Scene_add(scene, &node);
+	if (id == 0)
+	{
+		return luaL_error(L, "could not allocate a scene node");
+	}
+
+	s_Scene_keep(L, id, kind, 2);
+	lua_pushinteger(L, id);
+	return 1;
+}
+
+/// `scene:box(left, top, right, bottom, color)`
+/// Adds a filled rectangle above every other node.
+/// RETURNS the node's ID.
+static int s_Scene_box(lua_State *L)
+{
+	return s_Scene_add(L, SCENE_BOX);
+}
+
+/// `scene:line(x1, y1, x2, y2, color, width)`
+/// Adds a line, as drawn by `fb:line`, above every other node.
+/// RETURNS the node's ID.
+static int s_Scene_line(lua_State *L)
+{
+	return s_Scene_add(L, SCENE_LINE);
+}
+
+/// `scene:text(font, x, y, text, color, ...clip)`
+/// Adds a string, as drawn by `fb:drawString` with the optional clipping
+/// rectangle `left, top, right, bottom`, above every other node.
+/// RETURNS the node's ID.
+static int s_Scene_text(lua_State *L)
+{
+	return s_Scene_add(L, SCENE_TEXT);
+}
+
+/// `scene:image(surface, x, y, mask)`
+/// Adds the whole surface with its top left at (x, y), above every other node.
+/// When `mask` is given, only the pixels where it is nonzero are drawn.
+/// RETURNS the node's ID.
+static int s_Scene_image(lua_State *L)
+{
+	return s_Scene_add(L, SCENE_IMAGE);
+}
+
+/// `scene:set(id, ...)`
+/// Changes a node, keeping its place in the order. The arguments after `id`
+/// are those of the method which added it.
+static int s_Scene_set(lua_State *L)
+{
+	Scene *scene = s_checkScene(L, 1);
+	SceneId id = (SceneId)luaL_checkinteger(L, 2);
+	SceneNode const *old = Scene_get(scene, id);
+	luaL_argcheck(L, old != NULL, 2, "no such node");
+
+	SceneNodeKind kind = old->kind;
+	SceneNode node = s_checkSceneNode(L, kind, 3);
+	if (!Scene_set(scene, id, &node))
+	{
+		return luaL_error(L, "could not allocate a scene node");
+	}
+	s_Scene_keep(L, id, kind, 3);
+	return 0;
+}
+
+/// `scene:remove(id)`
+static int s_Scene_remove(lua_State *L)
+{
+	Scene *scene = s_checkScene(L, 1);
+	SceneId id = (SceneId)luaL_checkinteger(L, 2);
+	luaL_argcheck(L, Scene_remove(scene, id), 2, "no such node");
+
+	lua_getuservalue(L, 1);
+	lua_pushnil(L);
+	lua_rawseti(L, -2, id);
+	return 0;
+}
+
+/// `scene:setVisible(id, visible)`
+static int s_Scene_setVisible(lua_State *L)
+{
+	Scene *scene = s_checkScene(L, 1);
+	SceneId id = (SceneId)luaL_checkinteger(L, 2);
+	luaL_argcheck(L, Scene_setVisible(scene, id, lua_toboolean(L, 3)), 2, "no such node");
+	return 0;
+}
+
+/// `scene:damageAll()`
+/// Repaints the whole scene at the next render, such as after something else
+/// drew over it.
+static int s_Scene_damageAll(lua_State *L)
+{
+	Scene_damageAll(s_checkScene(L, 1));
+	return 0;
+}
+
+typedef struct
+{
+	FrameBuffer *frameBuffer;
+	SlowBuffer *slowBuffer;
+	int waveform;
+	Region flushes;
+} s_Scene_flush_closure;
+
+static void s_Scene_flush(void *context, Rectangle rect)
+{
+	s_Scene_flush_closure *closure = context;
+	Region_add(&closure->flushes, rect);
+}
+
+/// `scene:render(target, waveform)`
+/// Repaints the damaged parts of the scene into `target` (`rm_fb`, `rm_sb`, or
+/// a surface). The repainted rectangles of `rm_fb` (with `waveform`, 1 by
+/// default) or `rm_sb` are then flushed, merged into a Region.
+/// RETURNS the number of rectangles repainted.
+static int s_Scene_render(lua_State *L)
+{
+	Scene *scene = s_checkScene(L, 1);
+	lua_Integer maximumColor;
+	Raster raster = s_checkRasterAt(L, 2, &maximumColor);
+
+	s_Scene_flush_closure closure = {NULL, NULL, (int)luaL_optinteger(L, 3, 1), Region_empty(REGION_DEFAULT_OVERHEAD)};
+	Device *device = luaL_testudata(L, 2, "C-FrameBuffer");
+	if (device != NULL)
+	{
+		closure.frameBuffer = device->frameBuffer;
+	}
+	device = luaL_testudata(L, 2, "C-SlowBuffer");
+	if (device != NULL)
+	{
+		closure.slowBuffer = device->slowBuffer;
+	}
+
+	lua_pushinteger(L, Scene_render(scene, raster, &closure, s_Scene_flush));
+	if (closure.frameBuffer != NULL)
+	{
+		FrameBuffer_flushRegion(closure.frameBuffer, &closure.flushes, closure.waveform);
+	}
+	else if (closure.slowBuffer != NULL)
+	{
+		SlowBuffer_flushRegion(closure.slowBuffer, &closure.flushes);
+	}
+	return 1;
+}
+
+typedef struct
+{
+	Raster raster;
+	FrameBuffer *frameBuffer;
+	SlowBuffer *slowBuffer;
+	int waveform;
+	Region flushes;
+} s_Tiles_render_closure;
+
+static void s_Tiles_render_done(void *context, Rectangle tile, uint16_t const *colors, size_t stride)
+{
+	s_Tiles_render_closure *closure = context;
+	Rectangle dirty = {0, 0, 0, 0};
+	for (size_t y = 0; y < tile.height; y++)
+	{
+		Raster_writeSpan(closure->raster, (long)tile.left, (long)(tile.top + y), colors + y * stride, tile.width, &dirty);
+	}
+	Region_add(&closure->flushes, dirty);
+}
+
+/// Flushes the tiles completed since the last batch.
+static void s_Tiles_render_idle(void *context)
+{
+	s_Tiles_render_closure *closure = context;
+	if (closure->frameBuffer != NULL)
+	{
+		FrameBuffer_flushRegion(closure->frameBuffer, &closure->flushes, closure->waveform);
+	}
+	else if (closure->slowBuffer != NULL)
+	{
+		SlowBuffer_flushRegion(closure->slowBuffer, &closure->flushes);
+	}
+	closure->flushes.count = 0;
+}
+
+/// `rm_tiles:render(target, code, arguments, cell, waveform, ...clip)`
+/// Fills `target` (`rm_fb`, `rm_sb`, or a surface) with `cell` x `cell` squares
+/// whose colors are computed in parallel, on a worker thread for each core.
+/// `code`: the source of a Lua chunk, which is called in each worker's own Lua
+/// state with the values of the `arguments` array (nils, booleans, numbers, or
+/// strings) and returns the kernel: a function `(left, top, size)` returning
+/// the color of the square whose top left pixel is (left, top).
+/// The squares are computed in tiles, which are drawn into `target` as they are
+/// completed; the tiles of `rm_fb` (with `waveform`, 1 by default) or `rm_sb`
+/// are also flushed as they are completed.
+/// Raises the first error raised by the kernel, after which no more tiles are
+/// started.
+static int s_Tiles_render(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-Tiles");
+	lua_Integer maximumColor;
+	Raster raster = s_checkRasterAt(L, 2, &maximumColor);
+	size_t codeLength;
+	char const *code = luaL_checklstring(L, 3, &codeLength);
+	lua_Integer cell = luaL_checkinteger(L, 5);
+	if (cell < 1 || cell > TILE_PIXELS)
+	{
+		return luaL_argerror(L, 5, lua_pushfstring(L, "the cell size must be from 1 to %d", TILE_PIXELS));
+	}
+	raster = s_optClip(L, 7, raster);
+
+	TileJob job;
+	job.code = code;
+	job.codeLength = codeLength;
+	job.argumentCount = 0;
+	job.area = raster.clip;
+	job.cell = (size_t)cell;
+	job.maximumColor = (uint16_t)maximumColor;
+	if (!lua_isnoneornil(L, 4))
+	{
+		luaL_checktype(L, 4, LUA_TTABLE);
+		size_t count = lua_rawlen(L, 4);
+		luaL_argcheck(L, count <= TILE_ARGUMENTS, 4, "too many arguments");
+		for (size_t i = 0; i < count; i++)
+		{
+			TileArgument *argument = &job.arguments[job.argumentCount++];
+			lua_rawgeti(L, 4, (lua_Integer)i + 1);
+			switch (lua_type(L, -1))
+			{
+			case LUA_TNIL:
+				argument->type = TILE_ARGUMENT_NIL;
+				break;
+			case LUA_TBOOLEAN:
+				argument->type = TILE_ARGUMENT_BOOLEAN;
+				argument->boolean = lua_toboolean(L, -1);
+				break;
+			case LUA_TNUMBER:
+				argument->type = lua_isinteger(L, -1) ? TILE_ARGUMENT_INTEGER : TILE_ARGUMENT_NUMBER;
+				argument->integer = lua_tointeger(L, -1);
+				argument->number = lua_tonumber(L, -1);
+				break;
+			case LUA_TSTRING:
+				// The string stays referenced by the table during the render.
+				argument->type = TILE_ARGUMENT_STRING;
+				argument->string = lua_tolstring(L, -1, &argument->length);
+				break;
+			default:
+				return luaL_argerror(L, 4, "arguments must be nil, booleans, numbers, or strings");
+			}
+			lua_pop(L, 1);
+		}
+	}
+
+	s_Tiles_render_closure closure = {raster, NULL, NULL, (int)luaL_optinteger(L, 6, 1), Region_empty(REGION_DEFAULT_OVERHEAD)};
+	Device *target = luaL_testudata(L, 2, "C-FrameBuffer");
+	if (target != NULL)
+	{
+		closure.frameBuffer = target->frameBuffer;
+	}
+	target = luaL_testudata(L, 2, "C-SlowBuffer");
+	if (target != NULL)
+	{
+		closure.slowBuffer = target->slowBuffer;
+	}
+
+	char const *error = TileRenderer_render(device->tiles, &job, &closure, s_Tiles_render_done, s_Tiles_render_idle);
+	if (error != NULL)
+	{
+		return luaL_error(L, "%s", error);
+	}
+	return 0;
+}
+
+/// `rm_fractal:render(target, centerX, centerY, scale, iterations, cell, levels, waveform, ...clip)`
+/// Renders the Mandelbrot set into `target` (`rm_fb`, `rm_sb`, or a surface),
+/// with (centerX, centerY) at the middle of the clipping rectangle (the whole
+/// target, by default) and `scale` between pixels. Each `cell` x `cell` square
+/// is shaded by the escape time of its middle, dithered to `levels` grays (16
+/// by default). Rendering again with smaller cells refines the image
+/// progressively.
+/// The render proceeds in bands of rows; the bands of `rm_fb` (with
+/// `waveform`, 2 by default) or `rm_sb` are flushed as they are finished.
+static int s_Fractal_render(lua_State *L)
+{
+	luaL_checkudata(L, 1, "C-Fractal");
+	lua_Integer maximumColor;
+	Raster raster = s_checkRasterAt(L, 2, &maximumColor);
+	FractalView view = {luaL_checknumber(L, 3), luaL_checknumber(L, 4), luaL_checknumber(L, 5), 0};
+	lua_Integer iterations = luaL_checkinteger(L, 6);
+	lua_Integer cell = luaL_checkinteger(L, 7);
+	lua_Integer levels = luaL_optinteger(L, 8, 16);
+	int waveform = (int)luaL_optinteger(L, 9, 2);
+	raster = s_optClip(L, 10, raster);
+	luaL_argcheck(L, iterations >= 1 && iterations <= UINT16_MAX, 6, "iterations must be from 1 to 65535");
+	luaL_argcheck(L, cell >= 1 && cell <= 256, 7, "the cell size must be from 1 to 256");
+	luaL_argcheck(L, levels >= 2 && levels <= FRACTAL_LEVELS, 8, "levels must be from 2 to 256");
+	view.iterations = (unsigned)iterations;
+
+	FrameBuffer *frameBuffer = NULL;
+	SlowBuffer *slowBuffer = NULL;
+	Device *device = luaL_testudata(L, 2, "C-FrameBuffer");
+	if (device != NULL)
+	{
+		frameBuffer = device->frameBuffer;
+	}
+	device = luaL_testudata(L, 2, "C-SlowBuffer");
+	if (device != NULL)
+	{
+		slowBuffer = device->slowBuffer;
+
+		// SlowBuffer colors are 5-bit grays.
+		maximumColor = 31;
+	}
+
+	// The grays from black to white, in RGB565 for 16-bit targets (`rm_fb` and
+	// surfaces which are blitted to it).
+	uint16_t palette[FRACTAL_LEVELS];
+	for (lua_Integer i = 0; i < levels; i++)
+	{
+		if (maximumColor == UINT16_MAX)
+		{
+			uint16_t r = (uint16_t)((i * 31 + (levels - 1) / 2) / (levels - 1));
+			uint16_t g = (uint16_t)((i * 63 + (levels - 1) / 2) / (levels - 1));
+			palette[i] = (uint16_t)(r << 11 | g << 5 | r);
+		}
+		else
+		{
+			palette[i] = (uint16_t)((i * maximumColor + (levels - 1) / 2) / (levels - 1));
+		}
+	}
+
+	Rectangle area = raster.clip;
+	size_t band = cell >= 64 ? (size_t)cell : 64 / (size_t)cell * (size_t)cell;
+	for (size_t top = area.top; top < area.top + area.height; top += band)
+	{
+		Rectangle dirty = {0, 0, 0, 0};
+		Raster rows = Raster_clip(raster, (Rectangle){area.left, top, area.width, band});
+		Fractal_render(rows, area, &view, (size_t)cell, palette, (size_t)levels, &dirty);
+		if (dirty.width == 0)
+		{
+			continue;
+		}
+		if (frameBuffer != NULL)
+		{
+			FrameBuffer_flush(frameBuffer, dirty, waveform);
+		}
+		else if (slowBuffer != NULL)
+		{
+			SlowBuffer_flush(slowBuffer, dirty);
+		}
+	}
+	return 0;
+}
+
+typedef struct
+{
+	Rectangle screenSize;
+	int32_t xMaximum;
+	int32_t yMaximum;
+	int32_t pressureMaximum;
+	size_t count;
+	TouchFrame frames[TOUCH_FRAME_CAPACITY];
+} s_TouchFrames;
+
+// The registry key of the C-TouchFrames returned by `rm_touch:frames()`.
+static char s_touchFramesKey;
+
+/// Takes the touch frames recorded since the previous call into the view.
+/// RETURNS the view, on the top of the stack.
+static s_TouchFrames *s_pushTouchFrames(lua_State *L, Device *device)
+{
+	lua_rawgetp(L, LUA_REGISTRYINDEX, &s_touchFramesKey);
+	s_TouchFrames *view = lua_touserdata(L, -1);
+	view->screenSize = FrameBuffer_size(device->frameBuffer);
+	view->xMaximum = device->touchInput->xMaximum;
+	view->yMaximum = device->touchInput->yMaximum;
+	view->pressureMaximum = device->touchInput->pressureMaximum;
+	view->count = TouchInput_takeFrames(device->touchInput, view->frames, TOUCH_FRAME_CAPACITY);
+	return view;
+}
+
+/// `rm_touch:frames()`
+/// Takes every touch frame recorded since the previous call, including those
+/// that arrived during `rm_events:wait`.
+/// RETURNS a view of the frames, which is overwritten by the next call.
+static int s_TouchInput_frames(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-TouchInput");
+	s_pushTouchFrames(L, device);
+	return 1;
+}
+
+/// `#frames`
+static int s_TouchFrames_len(lua_State *L)
+{
+	s_TouchFrames *view = luaL_checkudata(L, 1, "C-TouchFrames");
+	lua_pushinteger(L, (lua_Integer)view->count);
+	return 1;
+}
+
+/// `frames:get(i)`
+/// RETURNS the time of the frame in seconds, and the number of contacts
+/// (fingers on the screen); 0 once every finger has lifted.
+static int s_TouchFrames_get(lua_State *L)
+{
+	s_TouchFrames *view = luaL_checkudata(L, 1, "C-TouchFrames");
+	lua_Integer i = luaL_checkinteger(L, 2);
+	luaL_argcheck(L, 1 <= i && i <= (lua_Integer)view->count, 2, "frame index out of range");
+
+	TouchFrame const *frame = &view->frames[i - 1];
+	lua_pushnumber(L, frame->seconds);
+	lua_pushinteger(L, (lua_Integer)frame->count);
+	return 2;
+}
+
+/// `frames:contact(i, j)`
+/// RETURNS the id (which a finger keeps until it lifts), x, y, pressure (from
+/// 0 to 1), and the major and minor axes of the contact area of the `j`th
+/// contact of the `i`th frame.
+static int s_TouchFrames_contact(lua_State *L)
+{
+	s_TouchFrames *view = luaL_checkudata(L, 1, "C-TouchFrames");
+	lua_Integer i = luaL_checkinteger(L, 2);
+	luaL_argcheck(L, 1 <= i && i <= (lua_Integer)view->count, 2, "frame index out of range");
+	TouchFrame const *frame = &view->frames[i - 1];
+	lua_Integer j = luaL_checkinteger(L, 3);
+	luaL_argcheck(L, 1 <= j && j <= (lua_Integer)frame->count, 3, "contact index out of range");
+
+	// The touchscreen's y axis runs up from the bottom of the display.
+	TouchContact const *contact = &frame->contacts[j - 1];
+	lua_pushinteger(L, contact->id);
+	lua_pushnumber(L, (double)contact->x * (view->screenSize.width - 1) / view->xMaximum);
+	lua_pushnumber(L, (double)(view->yMaximum - contact->y) * (view->screenSize.height - 1) / view->yMaximum);
+	lua_pushnumber(L, (double)contact->pressure / view->pressureMaximum);
+	lua_pushinteger(L, contact->major);
+	lua_pushinteger(L, contact->minor);
+	return 6;
+}
+
+/// RETURNS the sooner of two durations, where negative durations mean
+/// "never".
+static double s_soonest(double a, double b)
+{
+	if (a < 0)
+	{
+		return b;
+	}
+	else if (b < 0)
+	{
+		return a;
+	}
+	return a < b ? a : b;
+}
+
+/// `rm_events:wait(timeout, onPen, onTouch)`
+/// Sleeps until there is pen input for `onPen` or touch input for `onTouch`,
+/// or until `timeout` seconds have passed (forever, when omitted). Meanwhile,
+/// queued display updates and delayed SlowBuffer pixels are flushed as they
+/// become ready.
+/// When `onPen` is `true`, the wait ends at pen input without any callback, and
+/// the input can be read with `rm_pen:samples()`. Likewise for `onTouch` and
+/// `rm_touch:frames()`; a function `onTouch` is called with the frames read at
+/// once.
+/// Without `onPen` (or `onTouch`), input is consumed but does not end the wait.
+/// RETURNS the number of pen syncs and of touch frames which ended the wait.
+static int s_Events_wait(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-Events");
+	lua_Number timeout = luaL_optnumber(L, 2, -1);
+	bool hasCallback = lua_isfunction(L, 3);
+	bool endsOnPen = hasCallback || lua_toboolean(L, 3);
+	if (!hasCallback && !lua_isnoneornil(L, 3))
+	{
+		luaL_checktype(L, 3, LUA_TBOOLEAN);
+	}
+	bool hasTouchCallback = lua_isfunction(L, 4);
+	bool endsOnTouch = hasTouchCallback || lua_toboolean(L, 4);
+	if (!hasTouchCallback && !lua_isnoneornil(L, 4))
+	{
+		luaL_checktype(L, 4, LUA_TBOOLEAN);
+	}
+
+	Clock clock = Clock_monotonic();
+	double deadline = Clock_getSeconds(&clock) + timeout;
+
+	Rectangle screenSize = FrameBuffer_size(device->frameBuffer);
+	s_PenInput_pollPen_callback_closure closure = {L, screenSize, 3};
+
+	int packets = 0;
+	int frames = 0;
+	while (1)
+	{
+		double wait = -1;
+		if (timeout >= 0)
+		{
+			wait = deadline - Clock_getSeconds(&clock);
+			wait = wait > 0 ? wait : 0;
+		}
+		wait = s_soonest(wait, FlushScheduler_secondsUntilNext(device->scheduler));
+		wait = s_soonest(wait, SlowBuffer_secondsUntilNext(device->slowBuffer));
+		wait = s_soonest(wait, PenInput_secondsUntilReady(device->penInput));
+
+		// Collect garbage in the idle time a slice at a time, checking for
+		// input between slices.
+		if (wait != 0 && Collector_hasWork(device->collector))
+		{
+			Collector_stepFor(device->collector, wait);
+			wait = 0;
+		}
+
+		unsigned ready = EventLoop_wait(device->events, wait);
+
+		FlushScheduler_service(device->scheduler);
+		SlowBuffer_ping(device->slowBuffer);
+		if ((ready & EVENT_PEN) || device->penInput->replay != NULL)
+		{
+			if (hasCallback)
+			{
+				packets += PenInput_read(device->penInput, &closure, s_PenInput_pollPen_callback);
+			}
+			else
+			{
+				int read = PenInput_read(device->penInput, NULL, NULL);
+				packets += endsOnPen ? read : 0;
+			}
+		}
+		if (ready & EVENT_TOUCH)
+		{
+			int read = TouchInput_read(device->touchInput);
+			if (read != 0 && hasTouchCallback)
+			{
+				lua_pushvalue(L, 4);
+				s_pushTouchFrames(L, device);
+				uint64_t began = Profile_begin();
+				lua_call(L, 1, 0);
+				Profile_end("touch callback", began);
+			}
+			frames += endsOnTouch ? read : 0;
+		}
+
+		if (packets != 0 || frames != 0 || (timeout >= 0 && Clock_getSeconds(&clock) >= deadline))
+		{
+			break;
+		}
+	}
+
+	lua_pushinteger(L, packets);
+	lua_pushinteger(L, frames);
+	return 2;
+}
+
+static int s_Clock_getSeconds(lua_State *L)
+{
+	Clock *clock = luaL_checkudata(L, 1, "C-Clock");
+
+	lua_pushnumber(L, Clock_getSeconds(clock));
+	return 1;
+}
+
+/// `rm_gc:budget([seconds])`
+/// Sets the longest time that the engine spends collecting garbage at once,
+/// while waiting for input or after sending a display update; 0 collects only
+/// when the heap outgrows the slices.
+/// RETURNS the budget before the call, in seconds.
+static int s_Collector_budget(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-Collector");
+	lua_pushnumber(L, Collector_budget(device->collector));
+	if (!lua_isnoneornil(L, 2))
+	{
+		lua_Number seconds = luaL_checknumber(L, 2);
+		luaL_argcheck(L, seconds >= 0, 2, "the budget must not be negative");
+		Collector_setBudget(device->collector, seconds);
+	}
+	return 1;
+}
+
+/// `rm_gc:stats()`
+/// RETURNS a table of `pauses` (the number of times the engine collected
+/// garbage), their `totalSeconds` and `longestSeconds`, the `cycles` completed
+/// and how many of those were `forced` all at once, and the heap's size in
+/// `kilobytes`.
+static int s_Collector_stats(lua_State *L)
+{
+	Device *device = luaL_checkudata(L, 1, "C-Collector");
+	CollectorStats stats = Collector_stats(device->collector);
+
+	lua_createtable(L, 0, 6);
+	lua_pushinteger(L, (lua_Integer)stats.pauses);
+	lua_setfield(L, -2, "pauses");
+	lua_pushnumber(L, stats.totalSeconds);
+	lua_setfield(L, -2, "totalSeconds");
+	lua_pushnumber(L, stats.longestSeconds);
+	lua_setfield(L, -2, "longestSeconds");
+	lua_pushinteger(L, (lua_Integer)stats.cycles);
+	lua_setfield(L, -2, "cycles");
+	lua_pushinteger(L, (lua_Integer)stats.forced);
+	lua_setfield(L, -2, "forced");
+	lua_pushinteger(L, lua_gc(L, LUA_GCCOUNT, 0));
+	lua_setfield(L, -2, "kilobytes");
+	return 1;
+}
+
+/// `rm_profile.enabled()`
+/// RETURNS whether the engine is recording a profile (`--profile`).
+static int s_Profile_enabled(lua_State *L)
+{
+	lua_pushboolean(L, profileEnabled);
+	return 1;
+}
+
+/// `rm_profile.begin()`
+/// RETURNS a token marking the start of a span, to pass to `rm_profile.finish`.
+static int s_Profile_begin(lua_State *L)
+{
+	lua_pushinteger(L, (lua_Integer)Profile_begin());
+	return 1;
+}
+
+/// `rm_profile.finish(name, token)`
+/// Records the span `name` from `rm_profile.begin()` until now.
+static int s_Profile_finish(lua_State *L)
+{
+	char const *name = luaL_checkstring(L, 1);
+	lua_Integer began = luaL_checkinteger(L, 2);
+	if (began != 0)
+	{
+		Profile_end(name, (uint64_t)began);
+	}
+	return 0;
+}
+
+/// `rm_profile.mark(name)`
+/// Records an instant event `name`.
+static int s_Profile_mark(lua_State *L)
+{
+	Profile_mark(luaL_checkstring(L, 1));
+	return 0;
+}
+
+struct Interpreter
+{
+	lua_State *L;
+	PenInput *penInput;
+	TouchInput *touchInput;
+	FlushScheduler *scheduler;
+	TileRenderer *tiles;
+	EventLoop *events;
+	Collector *collector;
+};
+
+Interpreter *Interpreter_allocate(PenInput *penInput, TouchInput *touchInput, FrameBuffer *fb, SlowBuffer *sb)
+{
+	Interpreter *interpreter = (Interpreter *)malloc(sizeof(Interpreter));
+	if (interpreter == NULL)
+	{
+		return NULL;
+	}
+
+	lua_State *L = luaL_newstate();
+	FlushScheduler *scheduler = FlushScheduler_allocate(fb);
+	TileRenderer *tiles = TileRenderer_allocate();
+	EventLoop *events = EventLoop_allocate();
+	Collector *collector = L != NULL ? Collector_allocate(L) : NULL;
+	if (L == NULL || scheduler == NULL || tiles == NULL || events == NULL || collector == NULL)
+	{
+		fprintf(stderr, "Interpreter_allocate: could not allocate the interpreter.\n");
+		Collector_deallocate(collector);
+		if (events != NULL)
+		{
+			EventLoop_deallocate(events);
+		}
+		if (tiles != NULL)
+		{
+			TileRenderer_deallocate(tiles);
+		}
+		FlushScheduler_deallocate(scheduler);
+		if (L != NULL)
+		{
+			lua_close(L);
+		}
+		free(interpreter);
+		return NULL;
+	}
+
+	if (penInput->fileDescriptor >= 0)
+	{
+		EventLoop_watch(events, penInput->fileDescriptor, EVENT_PEN);
+	}
+	if (touchInput->fileDescriptor >= 0)
+	{
+		EventLoop_watch(events, touchInput->fileDescriptor, EVENT_TOUCH);
+	}
+
+	*interpreter = (Interpreter){L, penInput, touchInput, scheduler, tiles, events, collector};
+
+	Device *vfb = lua_newuserdata(L, sizeof(Device));
+	*vfb = (Device){penInput, touchInput, fb, sb, scheduler, events, tiles, collector};
+	if (luaL_newmetatable(L, "C-FrameBuffer"))
+	{
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "setPixel");
+		lua_pushcfunction(L, s_FrameBuffer_setPixel);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "setRect");
+		lua_pushcfunction(L, s_FrameBuffer_setRect);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "size");
+		lua_pushcfunction(L, s_FrameBuffer_size);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "flush");
+		lua_pushcfunction(L, s_FrameBuffer_flush);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "flushAsync");
+		lua_pushcfunction(L, s_FrameBuffer_flushAsync);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "isComplete");
+		lua_pushcfunction(L, s_FrameBuffer_isComplete);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "wait");
+		lua_pushcfunction(L, s_FrameBuffer_wait);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "snapshot");
+		lua_pushcfunction(L, s_FrameBuffer_snapshot);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "stroke");
+		lua_pushcfunction(L, s_FrameBuffer_stroke);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "flushRegion");
+		lua_pushcfunction(L, s_FrameBuffer_flushRegion);
+		lua_rawset(L, -3);
+
+		s_addDrawingMethods(L);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_fb");
+
+	Device *vsb = lua_newuserdata(L, sizeof(Device));
+	*vsb = (Device){penInput, touchInput, fb, sb, scheduler, events, tiles, collector};
+	if (luaL_newmetatable(L, "C-SlowBuffer"))
+	{
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "setPixel");
+		lua_pushcfunction(L, s_SlowBuffer_setPixel);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "setRect");
+		lua_pushcfunction(L, s_SlowBuffer_setRect);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "size");
+		lua_pushcfunction(L, s_SlowBuffer_size);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "flush");
+		lua_pushcfunction(L, s_SlowBuffer_flush);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "stroke");
+		lua_pushcfunction(L, s_SlowBuffer_stroke);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "flushRegion");
+		lua_pushcfunction(L, s_SlowBuffer_flushRegion);
+		lua_rawset(L, -3);
+
+		s_addDrawingMethods(L);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_sb");
+
+	Device *vpi = lua_newuserdata(L, sizeof(Device));
+	*vpi = (Device){penInput, touchInput, fb, sb, scheduler, events, tiles, collector};
+	if (luaL_newmetatable(L, "C-PenInput"))
+	{
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "poll");
+		lua_pushcfunction(L, s_PenInput_pollPen);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "samples");
+		lua_pushcfunction(L, s_PenInput_samples);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "predict");
+		lua_pushcfunction(L, s_PenInput_predict);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_pen");
+
+	lua_newtable(L);
+	lua_rawsetp(L, LUA_REGISTRYINDEX, &s_penStateKey);
+
+	s_PenSamples *vps = lua_newuserdata(L, sizeof(s_PenSamples));
+	vps->count = 0;
+	vps->hasPrevious = false;
+	if (luaL_newmetatable(L, "C-PenSamples"))
+	{
+		lua_pushstring(L, "__len");
+		lua_pushcfunction(L, s_PenSamples_len);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "get");
+		lua_pushcfunction(L, s_PenSamples_get);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_rawsetp(L, LUA_REGISTRYINDEX, &s_penSamplesKey);
+
+	s_PenSamples *vpp = lua_newuserdata(L, sizeof(s_PenSamples));
+	vpp->count = 0;
+	vpp->hasPrevious = false;
+	luaL_setmetatable(L, "C-PenSamples");
+	lua_rawsetp(L, LUA_REGISTRYINDEX, &s_penPredictionKey);
+
+	Device *vti = lua_newuserdata(L, sizeof(Device));
+	*vti = (Device){penInput, touchInput, fb, sb, scheduler, events, tiles, collector};
+	if (luaL_newmetatable(L, "C-TouchInput"))
+	{
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "frames");
+		lua_pushcfunction(L, s_TouchInput_frames);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_touch");
+
+	s_TouchFrames *vtf = lua_newuserdata(L, sizeof(s_TouchFrames));
+	vtf->count = 0;
+	if (luaL_newmetatable(L, "C-TouchFrames"))
+	{
+		lua_pushstring(L, "__len");
+		lua_pushcfunction(L, s_TouchFrames_len);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "get");
+		lua_pushcfunction(L, s_TouchFrames_get);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "contact");
+		lua_pushcfunction(L, s_TouchFrames_contact);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_rawsetp(L, LUA_REGISTRYINDEX, &s_touchFramesKey);
+
+	Device *vev = lua_newuserdata(L, sizeof(Device));
+	*vev = (Device){penInput, touchInput, fb, sb, scheduler, events, tiles, collector};
+	if (luaL_newmetatable(L, "C-Events"))
+	{
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "wait");
+		lua_pushcfunction(L, s_Events_wait);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_events");
+
+	Device *vtiles = lua_newuserdata(L, sizeof(Device));
+	*vtiles = (Device){penInput, touchInput, fb, sb, scheduler, events, tiles, collector};
+	if (luaL_newmetatable(L, "C-Tiles"))
+	{
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "render");
+		lua_pushcfunction(L, s_Tiles_render);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_tiles");
+
+	Device *vgc = lua_newuserdata(L, sizeof(Device));
+	*vgc = (Device){penInput, touchInput, fb, sb, scheduler, events, tiles, collector};
+	if (luaL_newmetatable(L, "C-Collector"))
+	{
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "budget");
+		lua_pushcfunction(L, s_Collector_budget);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "stats");
+		lua_pushcfunction(L, s_Collector_stats);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_gc");
+
+	lua_newuserdata(L, 0);
+	if (luaL_newmetatable(L, "C-Fractal"))
+	{
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "render");
+		lua_pushcfunction(L, s_Fractal_render);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_fractal");
+
+	Clock *monotonicClock = lua_newuserdata(L, sizeof(Clock));
+	*monotonicClock = Clock_monotonic();
+	if (luaL_newmetatable(L, "C-Clock"))
+	{
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "getSeconds");
+		lua_pushcfunction(L, s_Clock_getSeconds);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_monotonic");
+
+	Clock **calendar1970Clock = lua_newuserdata(L, sizeof(Clock));
+	luaL_newmetatable(L, "C-Clock");
+	lua_setmetatable(L, -2);
+	lua_setglobal(L, "rm_calendar");
+
+	if (luaL_newmetatable(L, "C-Font"))
+	{
+		lua_pushstring(L, "__gc");
+		lua_pushcfunction(L, s_Font_gc);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "setExtent");
+		lua_pushcfunction(L, s_Font_setExtent);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "measure");
+		lua_pushcfunction(L, s_Font_measure);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_pop(L, 1);
+
+	lua_newtable(L);
+	lua_pushstring(L, "new");
+	lua_pushcfunction(L, s_Font_new);
+	lua_rawset(L, -3);
+	lua_pushstring(L, "load");
+	lua_pushcfunction(L, s_Font_load);
+	lua_rawset(L, -3);
+	lua_setglobal(L, "rm_font");
+
+	if (luaL_newmetatable(L, "C-Surface"))
+	{
+		lua_pushstring(L, "__gc");
+		lua_pushcfunction(L, s_Surface_gc);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "size");
+		lua_pushcfunction(L, s_Surface_size);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "setPixel");
+		lua_pushcfunction(L, s_Surface_setPixel);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "setRect");
+		lua_pushcfunction(L, s_Surface_setRect);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "getPixel");
+		lua_pushcfunction(L, s_Surface_getPixel);
+		lua_rawset(L, -3);
+
+		s_addDrawingMethods(L);
+
+		lua_rawset(L, -3);
+	}
+	lua_pop(L, 1);
+
+	lua_newtable(L);
+	lua_pushstring(L, "new");
+	lua_pushcfunction(L, s_Surface_new);
+	lua_rawset(L, -3);
+	lua_setglobal(L, "rm_surface");
+
+	if (luaL_newmetatable(L, "C-Provisional"))
+	{
+		lua_pushstring(L, "__gc");
+		lua_pushcfunction(L, s_Provisional_gc);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "restore");
+		lua_pushcfunction(L, s_Provisional_restore);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_pop(L, 1);
+
+	lua_newtable(L);
+	lua_pushstring(L, "new");
+	lua_pushcfunction(L, s_Provisional_new);
+	lua_rawset(L, -3);
+	lua_setglobal(L, "rm_provisional");
+
+	if (luaL_newmetatable(L, "C-Scene"))
+	{
+		lua_pushstring(L, "__gc");
+		lua_pushcfunction(L, s_Scene_gc);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "box");
+		lua_pushcfunction(L, s_Scene_box);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "line");
+		lua_pushcfunction(L, s_Scene_line);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "text");
+		lua_pushcfunction(L, s_Scene_text);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "image");
+		lua_pushcfunction(L, s_Scene_image);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "set");
+		lua_pushcfunction(L, s_Scene_set);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "remove");
+		lua_pushcfunction(L, s_Scene_remove);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "setVisible");
+		lua_pushcfunction(L, s_Scene_setVisible);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "damageAll");
+		lua_pushcfunction(L, s_Scene_damageAll);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "render");
+		lua_pushcfunction(L, s_Scene_render);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_pop(L, 1);
+
+	lua_newtable(L);
+	lua_pushstring(L, "new");
+	lua_pushcfunction(L, s_Scene_new);
+	lua_rawset(L, -3);
+	lua_setglobal(L, "rm_scene");
+
+	if (luaL_newmetatable(L, "C-Region"))
+	{
+		lua_pushstring(L, "__len");
+		lua_pushcfunction(L, s_Region_len);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "__index");
+		lua_newtable(L);
+
+		lua_pushstring(L, "add");
+		lua_pushcfunction(L, s_Region_add);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "clear");
+		lua_pushcfunction(L, s_Region_clear);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "get");
+		lua_pushcfunction(L, s_Region_get);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "bounds");
+		lua_pushcfunction(L, s_Region_bounds);
+		lua_rawset(L, -3);
+
+		lua_pushstring(L, "area");
+		lua_pushcfunction(L, s_Region_area);
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	}
+	lua_pop(L, 1);
+
+	lua_newtable(L);
+	lua_pushstring(L, "new");
+	lua_pushcfunction(L, s_Region_new);
+	lua_rawset(L, -3);
+	lua_setglobal(L, "rm_region");
+
+	lua_newtable(L);
+	lua_pushstring(L, "enabled");
+	lua_pushcfunction(L, s_Profile_enabled);
+	lua_rawset(L, -3);
+	lua_pushstring(L, "begin");
+	lua_pushcfunction(L, s_Profile_begin);
+	lua_rawset(L, -3);
+	lua_pushstring(L, "finish");
+	lua_pushcfunction(L, s_Profile_finish);
+	lua_rawset(L, -3);
+	lua_pushstring(L, "mark");
+	lua_pushcfunction(L, s_Profile_mark);
+	lua_rawset(L, -3);
+	lua_setglobal(L, "rm_profile");
+
+	luaL_openlibs(L);
+	ChunkCache_install(L);
+	return interpreter;
+}
+
+void Interpreter_deallocate(Interpreter *interpreter)
+{
+	lua_close(interpreter->L);
+	Collector_deallocate(interpreter->collector);
+	TileRenderer_deallocate(interpreter->tiles);
+	EventLoop_deallocate(interpreter->events);
+	FlushScheduler_deallocate(interpreter->scheduler);
+	free(interpreter);
+}
+
+int Interpreter_preload(Interpreter *interpreter, char const *module)
+{
+	lua_State *L = interpreter->L;
+	lua_getglobal(L, "require");
+	lua_pushstring(L, module);
+	if (lua_pcall(L, 1, 0, 0) != LUA_OK)
+	{
+		fprintf(stderr, "Interpreter_preload: error loading `%s`\n", module);
+		fprintf(stderr, "\t```%s```\n", lua_tostring(L, -1));
+		lua_pop(L, 1);
+		return 1;
+	}
+	return 0;
+}
+
+int Interpreter_run(Interpreter *interpreter, char const *script)
+{
+	lua_State *L = interpreter->L;
+	if (ChunkCache_load(L, script) != LUA_OK || lua_pcall(L, 0, LUA_MULTRET, 0) != LUA_OK)
+	{
+		fprintf(stderr, "Interpreter_run: error running `%s`\n", script);
+		fprintf(stderr, "\t```%s```\n", lua_tostring(L, -1));
+		lua_pop(L, 1);
+		return 1;
+	}
+	return 0;
+}
+
+int Interpreter_reopen(Interpreter *interpreter)
+{
+	if (EventLoop_reopen(interpreter->events))
+	{
+		return 1;
+	}
+	if (interpreter->penInput->fileDescriptor >= 0 && EventLoop_watch(interpreter->events, interpreter->penInput->fileDescriptor, EVENT_PEN))
+	{
+		return 1;
+	}
+	if (interpreter->touchInput->fileDescriptor >= 0)
+	{
+		return EventLoop_watch(interpreter->events, interpreter->touchInput->fileDescriptor, EVENT_TOUCH);
+	}
+	return 0;
+}
+
+void run_script(char const *script, PenInput *penInput, TouchInput *touchInput, FrameBuffer *fb, SlowBuffer *sb)
+{
+	Interpreter *interpreter = Interpreter_allocate(penInput, touchInput, fb, sb);
+	if (interpreter == NULL)
+	{
+		return;
+	}
+	Interpreter_run(interpreter, script);
+	Interpreter_deallocate(interpreter);
 }
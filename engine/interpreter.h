@@ -1,5 +1,31 @@
 #include "framebuffer.h"
 #include "slowbuffer.h"
 #include "input.h"
+#include "touch.h"
 
-void run_script(char const *script, PenInput *penInput, FrameBuffer *fb, SlowBuffer *sb);
+// An Interpreter is a Lua state with the engine's globals (`rm_fb`, `rm_pen`,
+// ...) and the standard libraries, in which scripts are run.
+
+struct Interpreter;
+typedef struct Interpreter Interpreter;
+
+/// RETURNS `NULL` if there was a problem allocating the Interpreter.
+Interpreter *Interpreter_allocate(PenInput *penInput, TouchInput *touchInput, FrameBuffer *fb, SlowBuffer *sb);
+
+void Interpreter_deallocate(Interpreter *interpreter);
+
+/// Loads `module` with `require`, so that scripts run later find it already in
+/// `package.loaded`.
+/// RETURNS nonzero (after printing the error) if the module raised an error.
+int Interpreter_preload(Interpreter *interpreter, char const *module);
+
+/// RETURNS nonzero (after printing the error) if the script raised an error.
+int Interpreter_run(Interpreter *interpreter, char const *script);
+
+/// Gives the Interpreter its own event loop in a process forked from the one
+/// which allocated it, and watches the (possibly reopened) pen and touch
+/// devices.
+/// RETURNS nonzero if there was a problem.
+int Interpreter_reopen(Interpreter *interpreter);
+
+void run_script(char const *script, PenInput *penInput, TouchInput *touchInput, FrameBuffer *fb, SlowBuffer *sb);
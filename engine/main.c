@@ -1,103 +1,206 @@
 #include <math.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include <unistd.h>
 
+#include "chunkcache.h"
 #include "framebuffer.h"
 #include "input.h"
 #include "interpreter.h"
+#include "profile.h"
+#include "touch.h"
+#include "zygote.h"
 
-Rectangle dirtyRectangle = {0, 0, 0, 0};
+// The most modules that can be preloaded by a zygote.
+#define PRELOADS 16
 
-void penCallback(void *_fb, PenInput const *penInput)
+static void usage(void)
 {
-	int buttonContact = penInput->touching.pressed;
-	int buttonPen = penInput->pen.pressed;
-	int buttonEraser = penInput->eraser.pressed;
-
-	FrameBuffer *fb = _fb;
-	double px = penInput->xPos.raw / 20966.0;
-	double py = penInput->yPos.raw / 15725.0;
-	Rectangle size = FrameBuffer_size(fb);
-	int mx = (int)(size.width * py);
-	int my = (int)(size.height * (1.0 - px));
-	// fprintf(stderr, "Stylus state: (%d, %d) pen(%d) eraser(%d) contact(%d)\n",
-	// 		mx, my, buttonPen, buttonEraser, buttonContact);
-
-	if (!buttonContact)
-	{
-		return;
-	}
-
-	uint16_t color = buttonPen ? 0 : 0xff;
-
-	int BRUSH = buttonEraser ? 8 : 2;
+	fprintf(stderr, "usage: engine [options] <script.lua>\n");
+	fprintf(stderr, "       engine [options] --zygote <socket> [--preload <module>]...\n");
+	fprintf(stderr, "       engine --compile <file.lua>...\n");
+	fprintf(stderr, "\t--headless            draw into a memory-backed framebuffer instead of /dev/fb0\n");
+	fprintf(stderr, "\t--updates <log>       record every display update request to <log>\n");
+	fprintf(stderr, "\t--snapshot <out.pgm>  write the framebuffer to <out.pgm> when the script exits\n");
+	fprintf(stderr, "\t--replay <events>     read pen events from a recording instead of /dev/input/event1\n");
+	fprintf(stderr, "\t--replay-speed <x>    replay at x times the recorded speed (0: no delays)\n");
+	fprintf(stderr, "\t--profile <trace.json> record timed spans, written as a Chrome trace on exit or SIGUSR1\n");
+	fprintf(stderr, "\t--zygote <socket>     stay resident, forking a prepared engine for each script sent to <socket>\n");
+	fprintf(stderr, "\t--preload <module>    require <module> before forking, so scripts find it loaded\n");
+	fprintf(stderr, "\t--connect <socket>    run the script in the zygote at <socket>, if there is one\n");
+	fprintf(stderr, "\t--compile <file.lua>... update the bytecode caches of the files, without running them\n");
+}
 
-	for (int u = -BRUSH; u <= BRUSH; u++)
+int main(int argc, char **argv)
+{
+	int headless = 0;
+	char const *updatesPath = NULL;
+	char const *snapshotPath = NULL;
+	char const *replayPath = NULL;
+	char const *profilePath = NULL;
+	double replaySpeed = 1;
+	char const *zygotePath = NULL;
+	char const *connectPath = NULL;
+	char const *preloads[PRELOADS];
+	int preloadCount = 0;
+	char const *script = NULL;
+
+	for (int i = 1; i < argc; i++)
 	{
-		for (int v = -BRUSH; v <= BRUSH; v++)
+		char const *arg = argv[i];
+		int hasValue = i + 1 < argc;
+		if (strcmp(arg, "--compile") == 0 && hasValue)
 		{
-			int wx = mx + u;
-			int wy = my + v;
-			if (0 <= wx && wx < (int)size.width && 0 <= wy && wy < (int)size.height)
+			int failed = 0;
+			for (i++; i < argc; i++)
 			{
-				FrameBuffer_setPixel(fb, wx, wy, color);
+				failed |= ChunkCache_compile(argv[i]);
 			}
+			return failed;
+		}
+		else if (strcmp(arg, "--headless") == 0)
+		{
+			headless = 1;
+		}
+		else if (strcmp(arg, "--updates") == 0 && hasValue)
+		{
+			updatesPath = argv[++i];
+		}
+		else if (strcmp(arg, "--snapshot") == 0 && hasValue)
+		{
+			snapshotPath = argv[++i];
+		}
+		else if (strcmp(arg, "--replay") == 0 && hasValue)
+		{
+			replayPath = argv[++i];
+		}
+		else if (strcmp(arg, "--replay-speed") == 0 && hasValue)
+		{
+			replaySpeed = atof(argv[++i]);
+		}
+		else if (strcmp(arg, "--profile") == 0 && hasValue)
+		{
+			profilePath = argv[++i];
+		}
+		else if (strcmp(arg, "--zygote") == 0 && hasValue)
+		{
+			zygotePath = argv[++i];
+		}
+		else if (strcmp(arg, "--preload") == 0 && hasValue && preloadCount < PRELOADS)
+		{
+			preloads[preloadCount++] = argv[++i];
+		}
+		else if (strcmp(arg, "--connect") == 0 && hasValue)
+		{
+			connectPath = argv[++i];
+		}
+		else if (arg[0] != '-' && script == NULL)
+		{
+			script = arg;
+		}
+		else
+		{
+			usage();
+			return 1;
 		}
 	}
 
-	int left = mx - BRUSH;
-	int top = my - BRUSH;
-	int right = mx + BRUSH + 1;
-	int bottom = my + BRUSH + 1;
-	if (left < 0)
+	if ((script == NULL) == (zygotePath == NULL))
 	{
-		left = 0;
+		usage();
+		return 1;
 	}
-	if (top < 0)
+
+	// Without a zygote, start from scratch.
+	if (connectPath != NULL)
 	{
-		top = 0;
+		int status = Zygote_launch(connectPath, script);
+		if (status >= 0)
+		{
+			return status;
+		}
 	}
-	if (right > (int)size.width)
+
+	if (profilePath != NULL && Profile_enable(profilePath))
 	{
-		right = size.width;
+		return 1;
 	}
-	if (bottom > (int)size.height)
+
+	FrameBuffer *fb;
+	if (headless)
 	{
-		bottom = size.height;
+		// The reMarkable 2's display.
+		fb = FrameBuffer_allocateFile(NULL, 1404, 1872);
 	}
-	Rectangle update = {left, top, right - left, bottom - top};
-	Rectangle_expandToContain(&dirtyRectangle, update);
-}
-
-int main(int argc, char **argv)
-{
-	if (argc != 2)
+	else
 	{
-		fprintf(stderr, "must pass exactly 2 arguments\n");
-		return 1;
+		fb = FrameBuffer_allocate("/dev/fb0");
 	}
-
-	FrameBuffer *fb = FrameBuffer_allocate("/dev/fb0");
 	if (fb == NULL)
 	{
 		return 1;
 	}
 
-	Rectangle size = FrameBuffer_size(fb);
+	if (updatesPath != NULL && FrameBuffer_logUpdates(fb, updatesPath))
+	{
+		return 1;
+	}
 
+	char const *penDevice = replayPath != NULL ? NULL : "/dev/input/event1";
 	PenInput penInput;
-	if (PenInput_init(&penInput, "/dev/input/event1"))
+	if (replayPath != NULL)
+	{
+		if (PenInput_initReplay(&penInput, replayPath, replaySpeed))
+		{
+			return 1;
+		}
+	}
+	else if (PenInput_init(&penInput, penDevice))
 	{
 		return 1;
 	}
 
+	// There is no touchscreen to read off the tablet.
+	char const *touchDevice = headless || replayPath != NULL ? NULL : "/dev/input/event2";
+	TouchInput touchInput;
+	TouchInput_init(&touchInput, touchDevice);
+
 	SlowBuffer *sb = SlowBuffer_allocate(fb);
 	if (sb == NULL)
 	{
 		return 1;
 	}
 
-	run_script(argv[1], &penInput, fb, sb);
+	if (zygotePath != NULL)
+	{
+		Interpreter *interpreter = Interpreter_allocate(&penInput, &touchInput, fb, sb);
+		if (interpreter == NULL)
+		{
+			return 1;
+		}
+		for (int i = 0; i < preloadCount; i++)
+		{
+			if (Interpreter_preload(interpreter, preloads[i]))
+			{
+				return 1;
+			}
+		}
+		return Zygote_serve(zygotePath, interpreter, &penInput, penDevice, &touchInput, touchDevice);
+	}
+
+	run_script(script, &penInput, &touchInput, fb, sb);
+
+	if (Profile_write())
+	{
+		fprintf(stderr, "engine: could not write the profile to `%s`.\n", profilePath);
+		return 1;
+	}
+
+	if (snapshotPath != NULL && FrameBuffer_writePGM(fb, snapshotPath))
+	{
+		return 1;
+	}
 	return 0;
 }
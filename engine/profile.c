@@ -0,0 +1,255 @@
+#define _GNU_SOURCE
+
+#include "profile.h"
+
+#include <fcntl.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <sys/syscall.h>
+
+typedef struct
+{
+	char name[PROFILE_NAME_BYTES];
+	uint64_t began;
+
+	// Instant events have no duration.
+	uint64_t duration;
+	bool instant;
+	uint32_t thread;
+
+	// Set once the rest of the event has been written, since other threads
+	// may be recording at the same time.
+	uint32_t sequence;
+} ProfileEvent;
+
+bool profileEnabled = false;
+
+static char *s_path = NULL;
+static ProfileEvent *s_events = NULL;
+static uint64_t s_next = 0;
+static uint64_t s_origin = 0;
+
+uint64_t Profile_clock(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+/// RETURNS the kernel's ID for the calling thread.
+static uint32_t Profile_thread(void)
+{
+	static __thread uint32_t thread = 0;
+	if (thread == 0)
+	{
+		thread = (uint32_t)syscall(SYS_gettid);
+	}
+	return thread;
+}
+
+static void Profile_record(char const *name, uint64_t began, uint64_t duration, bool instant)
+{
+	uint64_t index = __atomic_fetch_add(&s_next, 1, __ATOMIC_RELAXED);
+	ProfileEvent *event = &s_events[index % PROFILE_CAPACITY];
+
+	__atomic_store_n(&event->sequence, 0, __ATOMIC_RELAXED);
+	size_t i = 0;
+	for (; i + 1 < PROFILE_NAME_BYTES && name[i] != '\0'; i++)
+	{
+		// Keep the name a valid JSON string without escaping.
+		char c = name[i];
+		event->name[i] = (c == '"' || c == '\\' || (unsigned char)c < ' ') ? '_' : c;
+	}
+	event->name[i] = '\0';
+	event->began = began;
+	event->duration = duration;
+	event->instant = instant;
+	event->thread = Profile_thread();
+	__atomic_store_n(&event->sequence, (uint32_t)(index / PROFILE_CAPACITY) + 1, __ATOMIC_RELEASE);
+}
+
+void Profile_end(char const *name, uint64_t began)
+{
+	if (!profileEnabled)
+	{
+		return;
+	}
+	uint64_t now = Profile_clock();
+	Profile_record(name, began, now - began, false);
+}
+
+void Profile_mark(char const *name)
+{
+	if (!profileEnabled)
+	{
+		return;
+	}
+	Profile_record(name, Profile_clock(), 0, true);
+}
+
+// The trace is written with `write` and hand-formatted numbers, so that it can
+// be written from a signal handler.
+
+typedef struct
+{
+	int fd;
+	size_t length;
+	char bytes[4096];
+} ProfileOutput;
+
+static void Output_flush(ProfileOutput *out)
+{
+	size_t done = 0;
+	while (done < out->length)
+	{
+		ssize_t wrote = write(out->fd, out->bytes + done, out->length - done);
+		if (wrote <= 0)
+		{
+			break;
+		}
+		done += (size_t)wrote;
+	}
+	out->length = 0;
+}
+
+static void Output_string(ProfileOutput *out, char const *text)
+{
+	for (; *text != '\0'; text++)
+	{
+		if (out->length == sizeof(out->bytes))
+		{
+			Output_flush(out);
+		}
+		out->bytes[out->length++] = *text;
+	}
+}
+
+/// Writes `nanoseconds` as microseconds with three decimal places.
+static void Output_micros(ProfileOutput *out, uint64_t nanoseconds)
+{
+	char digits[32];
+	size_t count = 0;
+	do
+	{
+		digits[count++] = (char)('0' + nanoseconds % 10);
+		nanoseconds /= 10;
+	} while (nanoseconds != 0 || count < 4);
+
+	char text[40];
+	size_t length = 0;
+	for (size_t i = count; i != 0; i--)
+	{
+		if (i == 3)
+		{
+			text[length++] = '.';
+		}
+		text[length++] = digits[i - 1];
+	}
+	text[length] = '\0';
+	Output_string(out, text);
+}
+
+static void Output_unsigned(ProfileOutput *out, uint64_t value)
+{
+	char text[24];
+	size_t length = sizeof(text) - 1;
+	text[length] = '\0';
+	do
+	{
+		text[--length] = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+	Output_string(out, text + length);
+}
+
+int Profile_write(void)
+{
+	if (s_events == NULL)
+	{
+		return 0;
+	}
+
+	ProfileOutput out;
+	out.fd = open(s_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+	out.length = 0;
+	if (out.fd < 0)
+	{
+		return 1;
+	}
+
+	uint64_t next = __atomic_load_n(&s_next, __ATOMIC_ACQUIRE);
+	uint64_t first = next > PROFILE_CAPACITY ? next - PROFILE_CAPACITY : 0;
+	uint32_t process = (uint32_t)getpid();
+
+	Output_string(&out, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+	bool comma = false;
+	for (uint64_t index = first; index < next; index++)
+	{
+		ProfileEvent const *event = &s_events[index % PROFILE_CAPACITY];
+		if (__atomic_load_n(&event->sequence, __ATOMIC_ACQUIRE) != (uint32_t)(index / PROFILE_CAPACITY) + 1)
+		{
+			// Still being written, or already overwritten.
+			continue;
+		}
+
+		Output_string(&out, comma ? ",\n{\"name\":\"" : "\n{\"name\":\"");
+		Output_string(&out, event->name);
+		Output_string(&out, event->instant ? "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":" : "\",\"ph\":\"X\",\"ts\":");
+		Output_micros(&out, event->began - s_origin);
+		if (!event->instant)
+		{
+			Output_string(&out, ",\"dur\":");
+			Output_micros(&out, event->duration);
+		}
+		Output_string(&out, ",\"pid\":");
+		Output_unsigned(&out, process);
+		Output_string(&out, ",\"tid\":");
+		Output_unsigned(&out, event->thread);
+		Output_string(&out, "}");
+		comma = true;
+	}
+	Output_string(&out, "\n]}\n");
+	Output_flush(&out);
+	return close(out.fd) != 0;
+}
+
+static void Profile_onSignal(int signal)
+{
+	Profile_write();
+	if (signal != SIGUSR1)
+	{
+		_exit(128 + signal);
+	}
+}
+
+int Profile_enable(char const *path)
+{
+	s_events = (ProfileEvent *)calloc(PROFILE_CAPACITY, sizeof(ProfileEvent));
+	s_path = strdup(path);
+	if (s_events == NULL || s_path == NULL)
+	{
+		fprintf(stderr, "Profile_enable: could not allocate the ring buffer.\n");
+		free(s_events);
+		free(s_path);
+		s_events = NULL;
+		return 1;
+	}
+
+	s_origin = Profile_clock();
+	struct sigaction action;
+	memset(&action, 0, sizeof(action));
+	action.sa_handler = Profile_onSignal;
+	sigemptyset(&action.sa_mask);
+	sigaction(SIGINT, &action, NULL);
+	sigaction(SIGTERM, &action, NULL);
+	action.sa_flags = SA_RESTART;
+	sigaction(SIGUSR1, &action, NULL);
+
+	profileEnabled = true;
+	return 0;
+}
@@ -0,0 +1,49 @@
+#ifndef _CF_PROFILE
+#define _CF_PROFILE
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+// The profiler records timed spans into a process-wide ring buffer, which is
+// written as Chrome trace-event JSON (viewable in chrome://tracing or
+// Perfetto). While it is disabled, `Profile_begin` and `Profile_end` cost only
+// a branch, so hot paths are instrumented unconditionally:
+//
+//     uint64_t began = Profile_begin();
+//     ...
+//     Profile_end("SlowBuffer_tryflush", began);
+
+// The ring buffer holds this many spans; older spans are overwritten.
+#define PROFILE_CAPACITY 65536
+
+// Longer names are truncated.
+#define PROFILE_NAME_BYTES 40
+
+extern bool profileEnabled;
+
+/// RETURNS the current monotonic time in nanoseconds.
+uint64_t Profile_clock(void);
+
+/// Starts recording spans, to be written to `path` by `Profile_write`, or when
+/// the process receives SIGINT or SIGTERM (after which it exits) or SIGUSR1.
+/// RETURNS nonzero if there was a problem allocating the ring buffer.
+int Profile_enable(char const *path);
+
+/// RETURNS the start time for a span, or 0 when profiling is disabled.
+static inline uint64_t Profile_begin(void)
+{
+	return profileEnabled ? Profile_clock() : 0;
+}
+
+/// Records the span `name` from `began` (from `Profile_begin`) until now.
+void Profile_end(char const *name, uint64_t began);
+
+/// Records an instant event `name`.
+void Profile_mark(char const *name);
+
+/// Writes the recorded spans to the path given to `Profile_enable`.
+/// RETURNS nonzero if the trace could not be written.
+int Profile_write(void);
+
+#endif
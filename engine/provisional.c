@@ -0,0 +1,140 @@
+#include "provisional.h"
+
+#include <stdlib.h>
+
+// A span of the target's pixels as they were before drawing.
+typedef struct
+{
+	size_t x;
+	size_t y;
+	size_t count;
+
+	// The index of the span's first pixel in `Provisional.pixels`.
+	size_t offset;
+} ProvisionalSpan;
+
+struct Provisional
+{
+	// The Raster being drawn onto, whose `target` is `NULL` while no pixels are
+	// held.
+	Raster target;
+
+	ProvisionalSpan *spans;
+	size_t spanCount;
+	size_t spanCapacity;
+
+	uint16_t *pixels;
+	size_t pixelCount;
+	size_t pixelCapacity;
+};
+
+Provisional *Provisional_allocate(void)
+{
+	Provisional *provisional = (Provisional *)calloc(1, sizeof(Provisional));
+	return provisional;
+}
+
+void Provisional_deallocate(Provisional *provisional)
+{
+	if (provisional != NULL)
+	{
+		free(provisional->spans);
+		free(provisional->pixels);
+	}
+	free(provisional);
+}
+
+/// Saves the target's pixels under a span before it is drawn.
+/// RETURNS nonzero if there was a problem allocating room for them.
+static int Provisional_save(Provisional *provisional, size_t x, size_t y, size_t count)
+{
+	if (provisional->spanCount == provisional->spanCapacity)
+	{
+		size_t capacity = provisional->spanCapacity ? 2 * provisional->spanCapacity : 64;
+		ProvisionalSpan *spans = (ProvisionalSpan *)realloc(provisional->spans, capacity * sizeof(ProvisionalSpan));
+		if (spans == NULL)
+		{
+			return 1;
+		}
+		provisional->spans = spans;
+		provisional->spanCapacity = capacity;
+	}
+	if (provisional->pixelCount + count > provisional->pixelCapacity)
+	{
+		size_t capacity = provisional->pixelCapacity ? 2 * provisional->pixelCapacity : 4096;
+		while (capacity < provisional->pixelCount + count)
+		{
+			capacity *= 2;
+		}
+		uint16_t *pixels = (uint16_t *)realloc(provisional->pixels, capacity * sizeof(uint16_t));
+		if (pixels == NULL)
+		{
+			return 1;
+		}
+		provisional->pixels = pixels;
+		provisional->pixelCapacity = capacity;
+	}
+
+	Raster target = provisional->target;
+	target.readSpan(target.target, x, y, count, provisional->pixels + provisional->pixelCount);
+	provisional->spans[provisional->spanCount++] = (ProvisionalSpan){x, y, count, provisional->pixelCount};
+	provisional->pixelCount += count;
+	return 0;
+}
+
+static void Provisional_fillSpan(void *target, size_t x, size_t y, size_t count, uint16_t color)
+{
+	Provisional *provisional = target;
+	if (Provisional_save(provisional, x, y, count) == 0)
+	{
+		provisional->target.fillSpan(provisional->target.target, x, y, count, color);
+	}
+}
+
+static void Provisional_writeSpan(void *target, size_t x, size_t y, size_t count, uint16_t const *colors)
+{
+	Provisional *provisional = target;
+	if (Provisional_save(provisional, x, y, count) == 0)
+	{
+		provisional->target.writeSpan(provisional->target.target, x, y, count, colors);
+	}
+}
+
+static void Provisional_readSpan(void const *target, size_t x, size_t y, size_t count, uint16_t *colors)
+{
+	Provisional const *provisional = target;
+	provisional->target.readSpan(provisional->target.target, x, y, count, colors);
+}
+
+Raster Provisional_raster(Provisional *provisional, Raster target)
+{
+	provisional->target = target;
+
+	Raster raster = target;
+	raster.target = provisional;
+	raster.fillSpan = Provisional_fillSpan;
+	raster.writeSpan = Provisional_writeSpan;
+	raster.readSpan = Provisional_readSpan;
+	return raster;
+}
+
+void const *Provisional_target(Provisional const *provisional)
+{
+	return provisional->spanCount != 0 ? provisional->target.target : NULL;
+}
+
+void Provisional_restore(Provisional *provisional, Rectangle *dirty)
+{
+	Raster target = provisional->target;
+
+	// Later spans may have saved pixels drawn by earlier ones, so undo them in
+	// reverse.
+	for (size_t i = provisional->spanCount; i-- > 0;)
+	{
+		ProvisionalSpan span = provisional->spans[i];
+		target.writeSpan(target.target, span.x, span.y, span.count, provisional->pixels + span.offset);
+		Rectangle_expandToContain(dirty, (Rectangle){span.x, span.y, span.count, 1});
+	}
+	provisional->spanCount = 0;
+	provisional->pixelCount = 0;
+}
@@ -0,0 +1,34 @@
+#ifndef _CF_PROVISIONAL
+#define _CF_PROVISIONAL
+
+#include "stdbool.h"
+
+#include "raster.h"
+
+// A Provisional records what was under everything drawn through it, so that
+// the drawing can be taken back: predicted ink is drawn provisionally ahead of
+// the pen, and restored away once the real samples arrive to be drawn in its
+// place.
+
+struct Provisional;
+typedef struct Provisional Provisional;
+
+/// RETURNS `NULL` if there was a problem allocating the Provisional.
+Provisional *Provisional_allocate(void);
+
+void Provisional_deallocate(Provisional *provisional);
+
+/// RETURNS a Raster which draws onto `target` (with its clipping rectangle),
+/// first saving the pixels it covers. Spans whose pixels can't be saved are
+/// not drawn.
+/// N.B.: The Provisional must only hold pixels of one target at a time.
+Raster Provisional_raster(Provisional *provisional, Raster target);
+
+/// RETURNS the target of the pixels being held, or `NULL` when there are none.
+void const *Provisional_target(Provisional const *provisional);
+
+/// Writes back the saved pixels, newest first, and forgets them.
+/// MODIFIES `dirty` to contain the restored pixels.
+void Provisional_restore(Provisional *provisional, Rectangle *dirty);
+
+#endif
@@ -0,0 +1,159 @@
+#include "raster.h"
+
+static void Raster_fillFrameBufferSpan(void *target, size_t x, size_t y, size_t count, uint16_t color)
+{
+	FrameBuffer_setRect(target, (Rectangle){x, y, count, 1}, color);
+}
+
+static void Raster_fillSlowBufferSpan(void *target, size_t x, size_t y, size_t count, uint16_t color)
+{
+	SlowBuffer_setRect(target, (Rectangle){x, y, count, 1}, (uint8_t)color);
+}
+
+static void Raster_fillSurfaceSpan(void *target, size_t x, size_t y, size_t count, uint16_t color)
+{
+	Surface_fillSpan(target, x, y, count, color);
+}
+
+static void Raster_writeFrameBufferSpan(void *target, size_t x, size_t y, size_t count, uint16_t const *colors)
+{
+	FrameBuffer_writeSpan(target, x, y, colors, count);
+}
+
+static void Raster_readFrameBufferSpan(void const *target, size_t x, size_t y, size_t count, uint16_t *colors)
+{
+	FrameBuffer_readSpan(target, x, y, colors, count);
+}
+
+// SlowBuffer spans are converted through a small buffer on the stack.
+#define RASTER_CHUNK 256
+
+static void Raster_writeSlowBufferSpan(void *target, size_t x, size_t y, size_t count, uint16_t const *colors)
+{
+	uint8_t chunk[RASTER_CHUNK];
+	for (size_t done = 0; done < count; done += RASTER_CHUNK)
+	{
+		size_t n = count - done < RASTER_CHUNK ? count - done : RASTER_CHUNK;
+		for (size_t i = 0; i < n; i++)
+		{
+			chunk[i] = (uint8_t)colors[done + i];
+		}
+		SlowBuffer_writeSpan(target, x + done, y, chunk, n);
+	}
+}
+
+static void Raster_readSlowBufferSpan(void const *target, size_t x, size_t y, size_t count, uint16_t *colors)
+{
+	uint8_t chunk[RASTER_CHUNK];
+	for (size_t done = 0; done < count; done += RASTER_CHUNK)
+	{
+		size_t n = count - done < RASTER_CHUNK ? count - done : RASTER_CHUNK;
+		SlowBuffer_readSpan(target, x + done, y, chunk, n);
+		for (size_t i = 0; i < n; i++)
+		{
+			colors[done + i] = chunk[i];
+		}
+	}
+}
+
+static void Raster_writeSurfaceSpan(void *target, size_t x, size_t y, size_t count, uint16_t const *colors)
+{
+	Surface_writeSpan(target, x, y, colors, count);
+}
+
+static void Raster_readSurfaceSpan(void const *target, size_t x, size_t y, size_t count, uint16_t *colors)
+{
+	Surface_readSpan(target, x, y, colors, count);
+}
+
+Raster Raster_frameBuffer(FrameBuffer *fb)
+{
+	Rectangle size = FrameBuffer_size(fb);
+	return (Raster){fb, size.width, size.height, size, Raster_fillFrameBufferSpan, Raster_writeFrameBufferSpan, Raster_readFrameBufferSpan};
+}
+
+Raster Raster_slowBuffer(SlowBuffer *sb)
+{
+	Rectangle size = SlowBuffer_size(sb);
+	return (Raster){sb, size.width, size.height, size, Raster_fillSlowBufferSpan, Raster_writeSlowBufferSpan, Raster_readSlowBufferSpan};
+}
+
+Raster Raster_surface(Surface *surface)
+{
+	Rectangle size = Surface_size(surface);
+	return (Raster){surface, size.width, size.height, size, Raster_fillSurfaceSpan, Raster_writeSurfaceSpan, Raster_readSurfaceSpan};
+}
+
+Raster Raster_clip(Raster raster, Rectangle clip)
+{
+	size_t left = raster.clip.left > clip.left ? raster.clip.left : clip.left;
+	size_t top = raster.clip.top > clip.top ? raster.clip.top : clip.top;
+	size_t right = raster.clip.left + raster.clip.width;
+	size_t bottom = raster.clip.top + raster.clip.height;
+	if (clip.left + clip.width < right)
+	{
+		right = clip.left + clip.width;
+	}
+	if (clip.top + clip.height < bottom)
+	{
+		bottom = clip.top + clip.height;
+	}
+
+	raster.clip.left = left;
+	raster.clip.top = top;
+	raster.clip.width = right > left ? right - left : 0;
+	raster.clip.height = bottom > top ? bottom - top : 0;
+	return raster;
+}
+
+void Raster_fillSpan(Raster raster, long left, long right, long y, uint16_t color, Rectangle *dirty)
+{
+	long clipLeft = (long)raster.clip.left;
+	long clipRight = (long)(raster.clip.left + raster.clip.width);
+	if (y < (long)raster.clip.top || y >= (long)(raster.clip.top + raster.clip.height))
+	{
+		return;
+	}
+	if (left < clipLeft)
+	{
+		left = clipLeft;
+	}
+	if (right > clipRight)
+	{
+		right = clipRight;
+	}
+	if (right <= left)
+	{
+		return;
+	}
+
+	raster.fillSpan(raster.target, (size_t)left, (size_t)y, (size_t)(right - left), color);
+	Rectangle_expandToContain(dirty, (Rectangle){(size_t)left, (size_t)y, (size_t)(right - left), 1});
+}
+
+void Raster_writeSpan(Raster raster, long left, long y, uint16_t const *colors, size_t count, Rectangle *dirty)
+{
+	long right = left + (long)count;
+	long clipLeft = (long)raster.clip.left;
+	long clipRight = (long)(raster.clip.left + raster.clip.width);
+	if (y < (long)raster.clip.top || y >= (long)(raster.clip.top + raster.clip.height))
+	{
+		return;
+	}
+	if (left < clipLeft)
+	{
+		colors += clipLeft - left;
+		left = clipLeft;
+	}
+	if (right > clipRight)
+	{
+		right = clipRight;
+	}
+	if (right <= left)
+	{
+		return;
+	}
+
+	raster.writeSpan(raster.target, (size_t)left, (size_t)y, (size_t)(right - left), colors);
+	Rectangle_expandToContain(dirty, (Rectangle){(size_t)left, (size_t)y, (size_t)(right - left), 1});
+}
@@ -0,0 +1,56 @@
+#ifndef _CF_RASTER
+#define _CF_RASTER
+
+#include "stddef.h"
+#include "stdint.h"
+
+#include "framebuffer.h"
+#include "slowbuffer.h"
+#include "surface.h"
+
+// A Raster is something that can be filled one horizontal span at a time, so
+// that drawing code can target a FrameBuffer, a SlowBuffer, or a Surface.
+typedef struct
+{
+	void *target;
+	size_t width;
+	size_t height;
+
+	// Drawing is limited to this rectangle, which is within the bounds.
+	Rectangle clip;
+
+	/// Sets the `count` pixels of row `y` starting at column `x` to `color`.
+	/// The span is always within the clipping rectangle.
+	void (*fillSpan)(void *target, size_t x, size_t y, size_t count, uint16_t color);
+
+	/// Sets the `count` pixels of row `y` starting at column `x` from `colors`.
+	/// The span is always within the clipping rectangle.
+	void (*writeSpan)(void *target, size_t x, size_t y, size_t count, uint16_t const *colors);
+
+	/// Reads the `count` pixels of row `y` starting at column `x` into
+	/// `colors`. The span is always within the bounds.
+	void (*readSpan)(void const *target, size_t x, size_t y, size_t count, uint16_t *colors);
+} Raster;
+
+Raster Raster_frameBuffer(FrameBuffer *fb);
+
+/// N.B.: SlowBuffer colors are only 8 bits; higher bits are discarded.
+Raster Raster_slowBuffer(SlowBuffer *sb);
+
+/// N.B.: Surfaces keep only as many low bits of colors as they have.
+Raster Raster_surface(Surface *surface);
+
+/// RETURNS the Raster, with its clipping rectangle reduced to the part within
+/// `clip`.
+Raster Raster_clip(Raster raster, Rectangle clip);
+
+/// Fills the pixels `[left, right)` of row `y`, clipped to the Raster.
+/// MODIFIES `dirty` to contain the filled pixels.
+void Raster_fillSpan(Raster raster, long left, long right, long y, uint16_t color, Rectangle *dirty);
+
+/// Sets the `count` pixels of row `y` starting at column `left` from `colors`,
+/// clipped to the Raster.
+/// MODIFIES `dirty` to contain the written pixels.
+void Raster_writeSpan(Raster raster, long left, long y, uint16_t const *colors, size_t count, Rectangle *dirty);
+
+#endif
@@ -0,0 +1,267 @@
+#include "region.h"
+
+void Rectangle_expandToContain(Rectangle *a, Rectangle b)
+{
+	if (b.width == 0 || b.height == 0)
+	{
+		return;
+	}
+	else if (a->width == 0 || a->height == 0)
+	{
+		*a = b;
+		return;
+	}
+
+	size_t aRight = a->left + a->width;
+	size_t bRight = b.left + b.width;
+	size_t aBottom = a->top + a->height;
+	size_t bBottom = b.top + b.height;
+	size_t right = aRight > bRight ? aRight : bRight;
+	size_t bottom = aBottom > bBottom ? aBottom : bBottom;
+	a->left = a->left < b.left ? a->left : b.left;
+	a->top = a->top < b.top ? a->top : b.top;
+	a->width = right - a->left;
+	a->height = bottom - a->top;
+}
+
+bool Rectangle_overlaps(Rectangle a, Rectangle b)
+{
+	return a.left < b.left + b.width && b.left < a.left + a.width && a.top < b.top + b.height && b.top < a.top + a.height;
+}
+
+// Rectangles waiting to be added while splitting around existing rectangles.
+#define REGION_PENDING 64
+
+Region Region_empty(size_t overhead)
+{
+	Region region;
+	region.overhead = overhead;
+	region.count = 0;
+	return region;
+}
+
+static size_t Rectangle_area(Rectangle a)
+{
+	return a.width * a.height;
+}
+
+static bool Rectangle_contains(Rectangle a, Rectangle b)
+{
+	return a.left <= b.left && b.left + b.width <= a.left + a.width && a.top <= b.top && b.top + b.height <= a.top + a.height;
+}
+
+/// RETURNS the area shared by the rectangles.
+static size_t Rectangle_overlapArea(Rectangle a, Rectangle b)
+{
+	if (!Rectangle_overlaps(a, b))
+	{
+		return 0;
+	}
+	size_t left = a.left > b.left ? a.left : b.left;
+	size_t top = a.top > b.top ? a.top : b.top;
+	size_t right = a.left + a.width < b.left + b.width ? a.left + a.width : b.left + b.width;
+	size_t bottom = a.top + a.height < b.top + b.height ? a.top + a.height : b.top + b.height;
+	return (right - left) * (bottom - top);
+}
+
+static size_t Rectangle_subtract(Rectangle rect, Rectangle hole, Rectangle *parts);
+
+/// RETURNS how much more it costs to update the bounding box of `existing` and
+/// `adding` than to update them separately, with `adding` split around
+/// `existing` when they overlap; negative when merging is cheaper.
+static long Region_mergeCost(Region const *region, Rectangle existing, Rectangle adding)
+{
+	Rectangle merged = existing;
+	Rectangle_expandToContain(&merged, adding);
+
+	size_t updates = 2;
+	if (Rectangle_overlaps(existing, adding))
+	{
+		Rectangle parts[4];
+		updates = 1 + Rectangle_subtract(adding, existing, parts);
+	}
+
+	long together = (long)(region->overhead + Rectangle_area(merged));
+	long apart = (long)(updates * region->overhead + Rectangle_area(existing) + Rectangle_area(adding) - Rectangle_overlapArea(existing, adding));
+	return together - apart;
+}
+
+static void Region_remove(Region *region, size_t index)
+{
+	region->rects[index] = region->rects[region->count - 1];
+	region->count -= 1;
+}
+
+/// Grows `rect` to contain every rectangle of the Region which it overlaps,
+/// removing them, until it overlaps none, then adds it.
+static void Region_absorb(Region *region, Rectangle rect)
+{
+	size_t i = 0;
+	while (i < region->count)
+	{
+		if (Rectangle_overlaps(region->rects[i], rect))
+		{
+			Rectangle_expandToContain(&rect, region->rects[i]);
+			Region_remove(region, i);
+			i = 0;
+			continue;
+		}
+		i++;
+	}
+	region->rects[region->count++] = rect;
+}
+
+/// Splits `rect` into the (up to four) parts outside of `hole`, which it
+/// overlaps.
+/// RETURNS the number of parts written to `parts`.
+static size_t Rectangle_subtract(Rectangle rect, Rectangle hole, Rectangle *parts)
+{
+	size_t count = 0;
+	size_t right = rect.left + rect.width;
+	size_t bottom = rect.top + rect.height;
+	size_t holeRight = hole.left + hole.width;
+	size_t holeBottom = hole.top + hole.height;
+
+	// Full-width bands above and below the hole, then the sides beside it.
+	size_t top = rect.top;
+	if (hole.top > rect.top)
+	{
+		parts[count++] = (Rectangle){rect.left, rect.top, rect.width, hole.top - rect.top};
+		top = hole.top;
+	}
+	size_t middleBottom = bottom;
+	if (holeBottom < bottom)
+	{
+		parts[count++] = (Rectangle){rect.left, holeBottom, rect.width, bottom - holeBottom};
+		middleBottom = holeBottom;
+	}
+	if (hole.left > rect.left)
+	{
+		parts[count++] = (Rectangle){rect.left, top, hole.left - rect.left, middleBottom - top};
+	}
+	if (holeRight < right)
+	{
+		parts[count++] = (Rectangle){holeRight, top, right - holeRight, middleBottom - top};
+	}
+	return count;
+}
+
+void Region_add(Region *region, Rectangle rect)
+{
+	// Parts split off around existing rectangles are not merged again, which
+	// could recreate the overlap they were split to avoid.
+	struct
+	{
+		Rectangle rect;
+		bool merge;
+	} pending[REGION_PENDING];
+	size_t pendingCount = 0;
+	pending[pendingCount].rect = rect;
+	pending[pendingCount++].merge = true;
+
+	while (pendingCount != 0)
+	{
+		pendingCount--;
+		Rectangle adding = pending[pendingCount].rect;
+		bool merge = pending[pendingCount].merge;
+		if (adding.width == 0 || adding.height == 0)
+		{
+			continue;
+		}
+
+		// Merge with every rectangle it is cheaper to update together with,
+		// starting over since the merged rectangle is bigger.
+		bool covered = false;
+		size_t i = 0;
+		while (i < region->count)
+		{
+			if (Rectangle_contains(region->rects[i], adding))
+			{
+				covered = true;
+				break;
+			}
+			if (merge && Region_mergeCost(region, region->rects[i], adding) <= 0)
+			{
+				Rectangle_expandToContain(&adding, region->rects[i]);
+				Region_remove(region, i);
+				i = 0;
+				continue;
+			}
+			i++;
+		}
+		if (covered)
+		{
+			continue;
+		}
+
+		// Keep the rectangles disjoint by adding only the parts outside of
+		// any rectangle it overlaps.
+		size_t overlapped = 0;
+		while (overlapped < region->count && !Rectangle_overlaps(region->rects[overlapped], adding))
+		{
+			overlapped++;
+		}
+		if (overlapped < region->count)
+		{
+			if (pendingCount + 4 <= REGION_PENDING)
+			{
+				Rectangle parts[4];
+				size_t count = Rectangle_subtract(adding, region->rects[overlapped], parts);
+				for (size_t p = 0; p < count; p++)
+				{
+					pending[pendingCount].rect = parts[p];
+					pending[pendingCount++].merge = false;
+				}
+			}
+			else
+			{
+				// Too fragmented; update the bounding box instead.
+				Region_absorb(region, adding);
+			}
+			continue;
+		}
+
+		if (region->count == REGION_CAPACITY)
+		{
+			// Merge with the rectangle it is cheapest to merge with, along
+			// with anything their bounding box then overlaps.
+			size_t cheapest = 0;
+			long cheapestCost = Region_mergeCost(region, region->rects[0], adding);
+			for (size_t j = 1; j < region->count; j++)
+			{
+				long cost = Region_mergeCost(region, region->rects[j], adding);
+				if (cost < cheapestCost)
+				{
+					cheapest = j;
+					cheapestCost = cost;
+				}
+			}
+			Rectangle_expandToContain(&adding, region->rects[cheapest]);
+			Region_remove(region, cheapest);
+			Region_absorb(region, adding);
+			continue;
+		}
+
+		region->rects[region->count++] = adding;
+	}
+}
+
+Rectangle Region_bounds(Region const *region)
+{
+	Rectangle bounds = {0, 0, 0, 0};
+	for (size_t i = 0; i < region->count; i++)
+	{
+		Rectangle_expandToContain(&bounds, region->rects[i]);
+	}
+	return bounds;
+}
+
+size_t Region_area(Region const *region)
+{
+	size_t area = 0;
+	for (size_t i = 0; i < region->count; i++)
+	{
+		area += Rectangle_area(region->rects[i]);
+	}
+	return area;
+}
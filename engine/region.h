@@ -0,0 +1,58 @@
+#ifndef _CF_REGION
+#define _CF_REGION
+
+#include "stdbool.h"
+#include "stddef.h"
+
+typedef struct
+{
+	size_t left;
+	size_t top;
+	size_t width;
+	size_t height;
+} Rectangle;
+
+/// MODIFIES the Rectangle pointed to by a to contain Rectangle b.
+/// A zero-area rectangle is considered to be contained by all other rectangles.
+void Rectangle_expandToContain(Rectangle *a, Rectangle b);
+
+/// RETURNS whether the rectangles share any pixel.
+bool Rectangle_overlaps(Rectangle a, Rectangle b);
+
+// A Region is a set of non-overlapping rectangles to update, such as on the
+// display. Each display update costs a fixed overhead besides the time for its
+// area, so a rectangle added to a Region is merged with another whenever
+// updating their bounding box would cost no more than updating both; far-apart
+// changes stay separate, and nearby ones share an update.
+
+// A Region holds at most this many rectangles; beyond that, rectangles are
+// merged with whichever other rectangle it costs least to merge them with.
+#define REGION_CAPACITY 16
+
+// The default overhead of one update, as the number of pixels which would take
+// as long to update.
+#define REGION_DEFAULT_OVERHEAD (128 * 128)
+
+typedef struct
+{
+	// The overhead of one update, in pixels.
+	size_t overhead;
+
+	size_t count;
+	Rectangle rects[REGION_CAPACITY];
+} Region;
+
+/// RETURNS an empty Region whose updates each cost `overhead` pixels besides
+/// their area.
+Region Region_empty(size_t overhead);
+
+/// Adds the pixels of `rect` to the Region.
+void Region_add(Region *region, Rectangle rect);
+
+/// RETURNS the bounding box of the Region (zero-area when it is empty).
+Rectangle Region_bounds(Region const *region);
+
+/// RETURNS the total area of the Region's rectangles.
+size_t Region_area(Region const *region);
+
+#endif
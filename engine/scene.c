@@ -0,0 +1,474 @@
+#include "scene.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "draw.h"
+
+typedef struct
+{
+	SceneNode node;
+	bool used;
+	bool visible;
+
+	// The pixels the node could draw: `[left, right) x [top, bottom)`, when
+	// `hasBounds`.
+	bool hasBounds;
+	long left;
+	long top;
+	long right;
+	long bottom;
+} SceneSlot;
+
+struct Scene
+{
+	size_t width;
+	size_t height;
+	uint16_t background;
+
+	// Slot `id - 1` holds the node with that ID.
+	SceneSlot *slots;
+	size_t slotCount;
+	size_t slotCapacity;
+
+	// The IDs of the nodes, from bottom to top.
+	SceneId *order;
+	size_t orderCount;
+
+	// One flag per tile, set when the tile must be repainted.
+	size_t tilesAcross;
+	size_t tilesDown;
+	uint8_t *damage;
+
+	// Room for the rectangles of `Scene_render`; there are never more than
+	// there are tiles.
+	Rectangle *rects;
+};
+
+Scene *Scene_allocate(size_t width, size_t height, uint16_t background)
+{
+	Scene *scene = (Scene *)malloc(sizeof(Scene));
+	if (scene == NULL)
+	{
+		return NULL;
+	}
+
+	scene->width = width;
+	scene->height = height;
+	scene->background = background;
+	scene->slots = NULL;
+	scene->slotCount = 0;
+	scene->slotCapacity = 0;
+	scene->order = NULL;
+	scene->orderCount = 0;
+	scene->tilesAcross = (width + SCENE_TILE - 1) / SCENE_TILE;
+	scene->tilesDown = (height + SCENE_TILE - 1) / SCENE_TILE;
+
+	size_t tiles = scene->tilesAcross * scene->tilesDown;
+	scene->damage = (uint8_t *)malloc(tiles ? tiles : 1);
+	scene->rects = (Rectangle *)malloc((tiles ? tiles : 1) * sizeof(Rectangle));
+	if (scene->damage == NULL || scene->rects == NULL)
+	{
+		free(scene->damage);
+		free(scene->rects);
+		free(scene);
+		return NULL;
+	}
+	memset(scene->damage, 1, tiles);
+	return scene;
+}
+
+void Scene_deallocate(Scene *scene)
+{
+	for (size_t i = 0; i < scene->slotCount; i++)
+	{
+		if (scene->slots[i].used)
+		{
+			free((char *)scene->slots[i].node.text);
+		}
+	}
+	free(scene->slots);
+	free(scene->order);
+	free(scene->damage);
+	free(scene->rects);
+	free(scene);
+}
+
+/// Marks the tiles under `[left, right) x [top, bottom)` as damaged.
+static void Scene_damage(Scene *scene, long left, long top, long right, long bottom)
+{
+	left = left > 0 ? left : 0;
+	top = top > 0 ? top : 0;
+	right = right < (long)scene->width ? right : (long)scene->width;
+	bottom = bottom < (long)scene->height ? bottom : (long)scene->height;
+	if (right <= left || bottom <= top)
+	{
+		return;
+	}
+
+	size_t tileRight = ((size_t)right + SCENE_TILE - 1) / SCENE_TILE;
+	size_t tileBottom = ((size_t)bottom + SCENE_TILE - 1) / SCENE_TILE;
+	for (size_t ty = (size_t)top / SCENE_TILE; ty < tileBottom; ty++)
+	{
+		size_t tileLeft = (size_t)left / SCENE_TILE;
+		memset(scene->damage + ty * scene->tilesAcross + tileLeft, 1, tileRight - tileLeft);
+	}
+}
+
+static void Scene_damageSlot(Scene *scene, SceneSlot const *slot)
+{
+	if (slot->visible && slot->hasBounds)
+	{
+		Scene_damage(scene, slot->left, slot->top, slot->right, slot->bottom);
+	}
+}
+
+void Scene_damageAll(Scene *scene)
+{
+	memset(scene->damage, 1, scene->tilesAcross * scene->tilesDown);
+}
+
+/// Sets the bounds of the slot from its node.
+static void Scene_measure(SceneSlot *slot)
+{
+	SceneNode const *node = &slot->node;
+	slot->hasBounds = true;
+	switch (node->kind)
+	{
+	case SCENE_BOX:
+		slot->left = node->x1;
+		slot->top = node->y1;
+		slot->right = node->x2;
+		slot->bottom = node->y2;
+		break;
+	case SCENE_LINE:
+	{
+		// Wide lines have round caps, which reach half the width past the
+		// endpoints.
+		long pad = node->width > 1 ? (long)ceil(node->width / 2) + 1 : 0;
+		slot->left = (node->x1 < node->x2 ? node->x1 : node->x2) - pad;
+		slot->top = (node->y1 < node->y2 ? node->y1 : node->y2) - pad;
+		slot->right = (node->x1 > node->x2 ? node->x1 : node->x2) + pad + 1;
+		slot->bottom = (node->y1 > node->y2 ? node->y1 : node->y2) + pad + 1;
+		break;
+	}
+	case SCENE_TEXT:
+		slot->hasBounds = Font_bounds(node->font, node->x1, node->y1, node->text, node->length, &slot->left, &slot->top, &slot->right, &slot->bottom);
+		if (slot->hasBounds && node->clipped)
+		{
+			slot->left = slot->left > node->clipLeft ? slot->left : node->clipLeft;
+			slot->top = slot->top > node->clipTop ? slot->top : node->clipTop;
+			slot->right = slot->right < node->clipRight ? slot->right : node->clipRight;
+			slot->bottom = slot->bottom < node->clipBottom ? slot->bottom : node->clipBottom;
+		}
+		break;
+	case SCENE_IMAGE:
+	{
+		Rectangle size = Surface_size(node->surface);
+		slot->left = node->x1;
+		slot->top = node->y1;
+		slot->right = node->x1 + (long)size.width;
+		slot->bottom = node->y1 + (long)size.height;
+		break;
+	}
+	}
+
+	if (slot->right <= slot->left || slot->bottom <= slot->top)
+	{
+		slot->hasBounds = false;
+	}
+}
+
+/// Copies the node into the slot, including its own copy of any text.
+/// RETURNS `false` if there was a problem allocating the text.
+static bool Scene_fill(SceneSlot *slot, SceneNode const *node)
+{
+	char *text = NULL;
+	if (node->kind == SCENE_TEXT)
+	{
+		text = (char *)malloc(node->length ? node->length : 1);
+		if (text == NULL)
+		{
+			return false;
+		}
+		memcpy(text, node->text, node->length);
+	}
+
+	free((char *)slot->node.text);
+	slot->node = *node;
+	slot->node.text = text;
+	if (node->kind != SCENE_TEXT)
+	{
+		slot->node.length = 0;
+	}
+	Scene_measure(slot);
+	return true;
+}
+
+/// RETURNS the slot of the node, or `NULL` if there is no such node.
+static SceneSlot *Scene_slot(Scene const *scene, SceneId id)
+{
+	if (id == 0 || id > scene->slotCount || !scene->slots[id - 1].used)
+	{
+		return NULL;
+	}
+	return &scene->slots[id - 1];
+}
+
+SceneId Scene_add(Scene *scene, SceneNode const *node)
+{
+	// Reuse the first free slot, or grow the slots.
+	size_t index = 0;
+	while (index < scene->slotCount && scene->slots[index].used)
+	{
+		index++;
+	}
+	if (index == scene->slotCapacity)
+	{
+		size_t capacity = scene->slotCapacity ? 2 * scene->slotCapacity : 16;
+		SceneSlot *slots = (SceneSlot *)realloc(scene->slots, capacity * sizeof(SceneSlot));
+		if (slots == NULL)
+		{
+			return 0;
+		}
+		scene->slots = slots;
+
+		SceneId *order = (SceneId *)realloc(scene->order, capacity * sizeof(SceneId));
+		if (order == NULL)
+		{
+			return 0;
+		}
+		scene->order = order;
+		scene->slotCapacity = capacity;
+	}
+
+	SceneSlot *slot = &scene->slots[index];
+	slot->node.text = NULL;
+	if (!Scene_fill(slot, node))
+	{
+		return 0;
+	}
+	slot->used = true;
+	slot->visible = true;
+	if (index == scene->slotCount)
+	{
+		scene->slotCount++;
+	}
+
+	SceneId id = (SceneId)(index + 1);
+	scene->order[scene->orderCount++] = id;
+	Scene_damageSlot(scene, slot);
+	return id;
+}
+
+SceneNode const *Scene_get(Scene const *scene, SceneId id)
+{
+	SceneSlot const *slot = Scene_slot(scene, id);
+	return slot == NULL ? NULL : &slot->node;
+}
+
+bool Scene_set(Scene *scene, SceneId id, SceneNode const *node)
+{
+	SceneSlot *slot = Scene_slot(scene, id);
+	if (slot == NULL)
+	{
+		return false;
+	}
+
+	Scene_damageSlot(scene, slot);
+	bool filled = Scene_fill(slot, node);
+	Scene_damageSlot(scene, slot);
+	return filled;
+}
+
+bool Scene_remove(Scene *scene, SceneId id)
+{
+	SceneSlot *slot = Scene_slot(scene, id);
+	if (slot == NULL)
+	{
+		return false;
+	}
+
+	Scene_damageSlot(scene, slot);
+	free((char *)slot->node.text);
+	slot->node.text = NULL;
+	slot->used = false;
+
+	for (size_t i = 0; i < scene->orderCount; i++)
+	{
+		if (scene->order[i] == id)
+		{
+			memmove(scene->order + i, scene->order + i + 1, (scene->orderCount - i - 1) * sizeof(SceneId));
+			scene->orderCount--;
+			break;
+		}
+	}
+	return true;
+}
+
+bool Scene_setVisible(Scene *scene, SceneId id, bool visible)
+{
+	SceneSlot *slot = Scene_slot(scene, id);
+	if (slot == NULL)
+	{
+		return false;
+	}
+
+	if (slot->visible != visible)
+	{
+		slot->visible = true;
+		Scene_damageSlot(scene, slot);
+		slot->visible = visible;
+	}
+	return true;
+}
+
+/// Merges the damaged tiles into rectangles: runs of tiles along each row, then
+/// runs of identical row runs down the columns.
+/// RETURNS the number of rectangles in `scene->rects`.
+static size_t Scene_mergeDamage(Scene *scene)
+{
+	size_t count = 0;
+
+	// The rectangles which reach the bottom of the previous row are
+	// `rects[firstOpen, count)`, because each row's rectangles are moved to
+	// the end once the row is done.
+	size_t firstOpen = 0;
+	for (size_t ty = 0; ty < scene->tilesDown; ty++)
+	{
+		uint8_t const *row = scene->damage + ty * scene->tilesAcross;
+		size_t openCount = count;
+		size_t tx = 0;
+		while (tx < scene->tilesAcross)
+		{
+			if (!row[tx])
+			{
+				tx++;
+				continue;
+			}
+			size_t start = tx;
+			while (tx < scene->tilesAcross && row[tx])
+			{
+				tx++;
+			}
+
+			Rectangle run = {start * SCENE_TILE, ty * SCENE_TILE, (tx - start) * SCENE_TILE, SCENE_TILE};
+			bool extended = false;
+			for (size_t i = firstOpen; i < openCount; i++)
+			{
+				Rectangle *above = &scene->rects[i];
+				if (above->left == run.left && above->width == run.width && above->top + above->height == run.top)
+				{
+					above->height += SCENE_TILE;
+					extended = true;
+					break;
+				}
+			}
+			if (!extended)
+			{
+				scene->rects[count++] = run;
+			}
+		}
+
+		// Move the rectangles which reach this row's bottom to the end, and
+		// close the others.
+		size_t closed = firstOpen;
+		for (size_t i = firstOpen; i < count; i++)
+		{
+			if (scene->rects[i].top + scene->rects[i].height != (ty + 1) * SCENE_TILE)
+			{
+				Rectangle done = scene->rects[i];
+				memmove(scene->rects + closed + 1, scene->rects + closed, (i - closed) * sizeof(Rectangle));
+				scene->rects[closed++] = done;
+			}
+		}
+		firstOpen = closed;
+	}
+	return count;
+}
+
+/// Draws the node, clipped to the Raster.
+static void Scene_draw(SceneNode const *node, Raster raster)
+{
+	Rectangle dirty = {0, 0, 0, 0};
+	switch (node->kind)
+	{
+	case SCENE_BOX:
+		for (long y = node->y1; y < node->y2; y++)
+		{
+			Raster_fillSpan(raster, node->x1, node->x2, y, node->color, &dirty);
+		}
+		break;
+	case SCENE_LINE:
+		Draw_line(raster, node->x1, node->y1, node->x2, node->y2, node->width, node->color, &dirty);
+		break;
+	case SCENE_TEXT:
+		if (node->clipped)
+		{
+			// Only reached when the clip is nonempty, since otherwise the node
+			// has no bounds.
+			long left = node->clipLeft < 0 ? 0 : node->clipLeft;
+			long top = node->clipTop < 0 ? 0 : node->clipTop;
+			raster = Raster_clip(raster, (Rectangle){left, top, node->clipRight - left, node->clipBottom - top});
+		}
+		Font_draw(node->font, raster, node->x1, node->y1, node->text, node->length, node->color, &dirty);
+		break;
+	case SCENE_IMAGE:
+	{
+		Raster source = Raster_surface(node->surface);
+		Raster mask;
+		if (node->mask != NULL)
+		{
+			mask = Raster_surface(node->mask);
+		}
+		Draw_blit(raster, source, Surface_size(node->surface), node->x1, node->y1, node->mask ? &mask : NULL, &dirty);
+		break;
+	}
+	}
+}
+
+size_t Scene_render(Scene *scene, Raster raster, void *context, void (*flush)(void *context, Rectangle rect))
+{
+	size_t count = Scene_mergeDamage(scene);
+	memset(scene->damage, 0, scene->tilesAcross * scene->tilesDown);
+
+	size_t rendered = 0;
+	for (size_t r = 0; r < count; r++)
+	{
+		Raster clipped = Raster_clip(raster, scene->rects[r]);
+		clipped = Raster_clip(clipped, (Rectangle){0, 0, scene->width, scene->height});
+		Rectangle rect = clipped.clip;
+		if (rect.width == 0 || rect.height == 0)
+		{
+			continue;
+		}
+
+		Rectangle dirty = {0, 0, 0, 0};
+		for (size_t y = rect.top; y < rect.top + rect.height; y++)
+		{
+			Raster_fillSpan(clipped, (long)rect.left, (long)(rect.left + rect.width), (long)y, scene->background, &dirty);
+		}
+
+		for (size_t i = 0; i < scene->orderCount; i++)
+		{
+			SceneSlot const *slot = &scene->slots[scene->order[i] - 1];
+			if (!slot->visible || !slot->hasBounds)
+			{
+				continue;
+			}
+			if (slot->right <= (long)rect.left || slot->left >= (long)(rect.left + rect.width) || slot->bottom <= (long)rect.top || slot->top >= (long)(rect.top + rect.height))
+			{
+				continue;
+			}
+			Scene_draw(&slot->node, clipped);
+		}
+
+		if (flush != NULL)
+		{
+			flush(context, rect);
+		}
+		rendered++;
+	}
+	return rendered;
+}
@@ -0,0 +1,104 @@
+#ifndef _CF_SCENE
+#define _CF_SCENE
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+#include "font.h"
+#include "raster.h"
+#include "surface.h"
+
+// A Scene is a retained list of nodes (boxes, lines, text, and images) drawn
+// in order over a background color. Adding, changing, or removing a node
+// damages the tiles under its old and new bounds, and `Scene_render` repaints
+// only the damaged tiles, so the cost of a frame depends on what changed
+// rather than on the number of nodes.
+
+// The size of the squares that damage is tracked in, in pixels.
+#define SCENE_TILE 32
+
+struct Scene;
+typedef struct Scene Scene;
+
+// Node IDs start at 1; the ID of a removed node may be reused.
+typedef uint32_t SceneId;
+
+typedef enum
+{
+	SCENE_BOX,
+	SCENE_LINE,
+	SCENE_TEXT,
+	SCENE_IMAGE,
+} SceneNodeKind;
+
+// The description of a node; only the fields for its kind are used.
+typedef struct
+{
+	SceneNodeKind kind;
+	uint16_t color;
+
+	// SCENE_BOX: the rectangle `[x1, x2) x [y1, y2)`.
+	// SCENE_LINE: the endpoints (x1, y1) and (x2, y2), inclusive.
+	// SCENE_TEXT: (x1, y1) is the left of the text and its baseline.
+	// SCENE_IMAGE: (x1, y1) is where the top left of the surface is drawn.
+	long x1;
+	long y1;
+	long x2;
+	long y2;
+
+	// SCENE_LINE
+	double width;
+
+	// SCENE_TEXT: the Scene keeps its own copy of the text. When `clipped`,
+	// only the pixels within `[clipLeft, clipRight) x [clipTop, clipBottom)`
+	// are drawn.
+	Font *font;
+	char const *text;
+	size_t length;
+	bool clipped;
+	long clipLeft;
+	long clipTop;
+	long clipRight;
+	long clipBottom;
+
+	// SCENE_IMAGE: only pixels where `mask` is nonzero are drawn, when it is
+	// not `NULL`.
+	Surface *surface;
+	Surface *mask;
+} SceneNode;
+
+/// RETURNS a Scene of the given size, entirely damaged, or `NULL` if there was
+/// a problem allocating it.
+Scene *Scene_allocate(size_t width, size_t height, uint16_t background);
+
+void Scene_deallocate(Scene *scene);
+
+/// Adds a node above all the others.
+/// RETURNS its ID, or 0 if there was a problem allocating it.
+SceneId Scene_add(Scene *scene, SceneNode const *node);
+
+/// RETURNS the description of the node, or `NULL` if there is no such node.
+SceneNode const *Scene_get(Scene const *scene, SceneId id);
+
+/// Replaces the description of a node, keeping its place in the order.
+/// RETURNS `false` if there is no such node, or there was a problem allocating.
+bool Scene_set(Scene *scene, SceneId id, SceneNode const *node);
+
+/// RETURNS `false` if there is no such node.
+bool Scene_remove(Scene *scene, SceneId id);
+
+/// Hides or shows a node without forgetting it.
+/// RETURNS `false` if there is no such node.
+bool Scene_setVisible(Scene *scene, SceneId id, bool visible);
+
+/// Damages the whole Scene, such as after something else drew over it.
+void Scene_damageAll(Scene *scene);
+
+/// Repaints the damaged parts of the Scene into `raster`, merged into
+/// rectangles of whole tiles, and calls `flush` (when not `NULL`) with each
+/// rectangle after painting it.
+/// RETURNS the number of rectangles repainted.
+size_t Scene_render(Scene *scene, Raster raster, void *context, void (*flush)(void *context, Rectangle rect));
+
+#endif
@@ -5,7 +5,14 @@
 #include <string.h>
 #include <stdio.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "clock.h"
+#include "profile.h"
 
 const double TIME_BOX_SECONDS = 10.0;
 const double MIN_PULSE_SECONDS = 0.26;
@@ -15,12 +22,35 @@ typedef struct
 	uint16_t ticks;
 } Periodic;
 
+// The SlowBuffer is divided into square tiles of this many pixels on a side,
+// so that flushes only examine the pixels of tiles which may have changed.
+#define TILE_PIXELS 32
+
+typedef struct
+{
+	// Set when some pixel of the tile may have an unflushed color.
+	bool dirty;
+
+	// Set when every unflushed pixel of the tile was found to be delayed until
+	// `wait_until`, and none have been drawn since.
+	bool settled;
+	Periodic wait_until;
+} Tile;
+
 typedef struct
 {
 	Rectangle rect;
 	Periodic wait_until;
 } QElement;
 
+// The retry queue holds at most this many rectangles. When it is full, a new
+// rectangle is merged into the queued rectangle it would enlarge the least.
+#define QUEUE_CAPACITY 64
+
+// Queued rectangles which overlap or touch are merged when their deadlines are
+// within this many ticks (about 50 milliseconds) of each other.
+#define MERGE_TOLERANCE_TICKS 328
+
 Periodic fromSeconds(double seconds)
 {
 	double onUnit = fmod(fmod(seconds, TIME_BOX_SECONDS) / TIME_BOX_SECONDS + 1, 1.0);
@@ -37,6 +67,18 @@ bool Periodic_before(Periodic a, Periodic b)
 	return (uint16_t)(b.ticks - a.ticks) < UINT16_MAX / 2;
 }
 
+#if defined(__ARM_NEON)
+/// RETURNS the sum of each half of `v` as the low and high byte of the result.
+/// With `v` holding distinct bits per lane, this packs the lanes into a mask.
+static uint32_t movemask(uint8x16_t v)
+{
+	uint8x8_t sums = vpadd_u8(vget_low_u8(v), vget_high_u8(v));
+	sums = vpadd_u8(sums, sums);
+	sums = vpadd_u8(sums, sums);
+	return vget_lane_u8(sums, 0) | (uint32_t)vget_lane_u8(sums, 1) << 8;
+}
+#endif
+
 struct SlowBuffer
 {
 	FrameBuffer *fb;
@@ -48,10 +90,13 @@ struct SlowBuffer
 	uint8_t *unflushed_color;
 	uint16_t *flushed_at;
 
-	size_t queueCapacity;
-	size_t queueWrite;
-	size_t queueRead;
-	QElement *queue;
+	size_t tilesWide;
+	size_t tilesHigh;
+	Tile *tiles;
+
+	// Rectangles to retry flushing, ordered by `wait_until`.
+	size_t queueLength;
+	QElement queue[QUEUE_CAPACITY];
 };
 
 SlowBuffer *SlowBuffer_allocate(FrameBuffer *fb)
@@ -78,18 +123,36 @@ SlowBuffer *SlowBuffer_allocate(FrameBuffer *fb)
 	sb->flushed_at = malloc(sizeof(uint16_t) * count);
 	memset(sb->flushed_at, 0, sizeof(uint16_t) * count);
 
-	sb->queueCapacity = 40000;
-	sb->queue = (QElement *)malloc(sizeof(QElement) * sb->queueCapacity);
-	sb->queueWrite = 0;
-	sb->queueRead = 0;
-	for (size_t i = 0; i < sb->queueCapacity; i++)
+	sb->tilesWide = (size.width + TILE_PIXELS - 1) / TILE_PIXELS;
+	sb->tilesHigh = (size.height + TILE_PIXELS - 1) / TILE_PIXELS;
+	size_t tileCount = sb->tilesWide * sb->tilesHigh;
+	sb->tiles = (Tile *)malloc(sizeof(Tile) * tileCount);
+	for (size_t i = 0; i < tileCount; i++)
 	{
-		sb->queue[i].wait_until.ticks = 0;
-		sb->queue[i].rect = (Rectangle){0, 0, 0, 0};
+		sb->tiles[i] = (Tile){false, false, {0}};
 	}
+
+	sb->queueLength = 0;
 	return sb;
 }
 
+/// Marks the tiles covering the pixels `[left, right) x [top, bottom)` as
+/// possibly having unflushed pixels which can be flushed immediately.
+static void SlowBuffer_markTiles(SlowBuffer *sb, size_t left, size_t top, size_t right, size_t bottom)
+{
+	size_t tx2 = (right + TILE_PIXELS - 1) / TILE_PIXELS;
+	size_t ty2 = (bottom + TILE_PIXELS - 1) / TILE_PIXELS;
+	for (size_t ty = top / TILE_PIXELS; ty < ty2; ty++)
+	{
+		Tile *row = sb->tiles + ty * sb->tilesWide;
+		for (size_t tx = left / TILE_PIXELS; tx < tx2; tx++)
+		{
+			row[tx].dirty = true;
+			row[tx].settled = false;
+		}
+	}
+}
+
 void SlowBuffer_setPixel(SlowBuffer *sb, size_t x, size_t y, uint8_t color)
 {
 	if (x >= sb->widthPixels || y >= sb->heightPixels)
@@ -98,6 +161,25 @@ void SlowBuffer_setPixel(SlowBuffer *sb, size_t x, size_t y, uint8_t color)
 	}
 	size_t index = x + y * sb->widthPixels;
 	sb->unflushed_color[index] = color;
+
+	Tile *tile = sb->tiles + (y / TILE_PIXELS) * sb->tilesWide + x / TILE_PIXELS;
+	tile->dirty = true;
+	tile->settled = false;
+}
+
+void SlowBuffer_writeSpan(SlowBuffer *sb, size_t x, size_t y, uint8_t const *colors, size_t count)
+{
+	if (count == 0)
+	{
+		return;
+	}
+	memmove(sb->unflushed_color + y * sb->widthPixels + x, colors, count);
+	SlowBuffer_markTiles(sb, x, y, x + count, y + 1);
+}
+
+void SlowBuffer_readSpan(SlowBuffer const *sb, size_t x, size_t y, uint8_t *colors, size_t count)
+{
+	memcpy(colors, sb->unflushed_color + y * sb->widthPixels + x, count);
 }
 
 void SlowBuffer_setRect(SlowBuffer *sb, Rectangle rect, uint8_t color)
@@ -112,81 +194,451 @@ void SlowBuffer_setRect(SlowBuffer *sb, Rectangle rect, uint8_t color)
 	{
 		size_t w = x2 - rect.left;
 		size_t y2 = rect.top + rect.height;
-		for (size_t y = rect.top; y < y2 && y < sb->heightPixels; y++)
+		if (y2 > sb->heightPixels)
+		{
+			y2 = sb->heightPixels;
+		}
+		for (size_t y = rect.top; y < y2; y++)
 		{
 			memset(sb->unflushed_color + y * width + rect.left, color, w);
 		}
+		if (y2 > rect.top)
+		{
+			SlowBuffer_markTiles(sb, rect.left, rect.top, x2, y2);
+		}
 	}
 }
 
-static bool SlowBuffer_tryflush(SlowBuffer *sb, Rectangle rect, QElement *delay)
+// The diff-and-commit loop of `SlowBuffer_tryflush` classifies pixels in
+// blocks of 16, so that clean runs can be skipped and fully changed runs can be
+// committed without examining each pixel.
+#define BLOCK_PIXELS 16
+
+/// Sets bit `i` of `*changed` for each pixel `index + i` (of the following
+/// `BLOCK_PIXELS`) whose unflushed color differs from its flushed color.
+/// When any have changed, also sets bit `i` of `*delayed` for each pixel which
+/// was flushed too recently to be flushed again.
+static void SlowBuffer_classifyBlock(SlowBuffer const *sb, size_t index, Periodic pulseAgo, Periodic now, uint32_t *changed, uint32_t *delayed)
 {
-	Clock clock = Clock_monotonic();
+	uint8_t const *flushed = sb->flushed_color + index;
+	uint8_t const *unflushed = sb->unflushed_color + index;
+	uint16_t const *at = sb->flushed_at + index;
+
+#if defined(__SSE2__)
+	__m128i equal = _mm_cmpeq_epi8(_mm_loadu_si128((__m128i const *)flushed), _mm_loadu_si128((__m128i const *)unflushed));
+	*changed = ~(uint32_t)_mm_movemask_epi8(equal) & 0xffff;
+	if (*changed == 0)
+	{
+		*delayed = 0;
+		return;
+	}
 
-	Periodic now = fromSeconds(Clock_getSeconds(&clock));
-	Periodic pulseAgo = Periodic_add(now, fromSeconds(-MIN_PULSE_SECONDS));
+	// `Periodic_before(a, b)` is the unsigned comparison `b - a < 0x7fff`,
+	// which is `(b - a) ^ 0x8000 < -1` as a signed comparison.
+	__m128i bias = _mm_set1_epi16((int16_t)0x8000);
+	__m128i limit = _mm_set1_epi16(-1);
+	__m128i vPulseAgo = _mm_set1_epi16((int16_t)pulseAgo.ticks);
+	__m128i vNow = _mm_set1_epi16((int16_t)now.ticks);
+	__m128i halves[2];
+	for (int h = 0; h < 2; h++)
+	{
+		__m128i flushedAt = _mm_loadu_si128((__m128i const *)(at + 8 * h));
+		__m128i afterPulseAgo = _mm_cmplt_epi16(_mm_xor_si128(_mm_sub_epi16(flushedAt, vPulseAgo), bias), limit);
+		__m128i beforeNow = _mm_cmplt_epi16(_mm_xor_si128(_mm_sub_epi16(vNow, flushedAt), bias), limit);
+		halves[h] = _mm_and_si128(afterPulseAgo, beforeNow);
+	}
+	*delayed = (uint32_t)_mm_movemask_epi8(_mm_packs_epi16(halves[0], halves[1]));
+#elif defined(__ARM_NEON)
+	static const uint8_t bits[16] = {1, 2, 4, 8, 16, 32, 64, 128, 1, 2, 4, 8, 16, 32, 64, 128};
+	uint8x16_t vBits = vld1q_u8(bits);
+
+	uint8x16_t different = vmvnq_u8(vceqq_u8(vld1q_u8(flushed), vld1q_u8(unflushed)));
+	*changed = movemask(vandq_u8(different, vBits));
+	if (*changed == 0)
+	{
+		*delayed = 0;
+		return;
+	}
 
-	size_t width = sb->widthPixels;
-	size_t x2 = rect.left + rect.width;
-	if (x2 > width)
+	uint16x8_t limit = vdupq_n_u16(UINT16_MAX / 2);
+	uint16x8_t vPulseAgo = vdupq_n_u16(pulseAgo.ticks);
+	uint16x8_t vNow = vdupq_n_u16(now.ticks);
+	uint8x8_t halves[2];
+	for (int h = 0; h < 2; h++)
 	{
-		x2 = width;
+		uint16x8_t flushedAt = vld1q_u16(at + 8 * h);
+		uint16x8_t afterPulseAgo = vcltq_u16(vsubq_u16(flushedAt, vPulseAgo), limit);
+		uint16x8_t beforeNow = vcltq_u16(vsubq_u16(vNow, flushedAt), limit);
+		halves[h] = vmovn_u16(vandq_u16(afterPulseAgo, beforeNow));
+	}
+	*delayed = movemask(vandq_u8(vcombine_u8(halves[0], halves[1]), vBits));
+#else
+	uint64_t flushedWords[2];
+	uint64_t unflushedWords[2];
+	memcpy(flushedWords, flushed, sizeof(flushedWords));
+	memcpy(unflushedWords, unflushed, sizeof(unflushedWords));
+	*changed = 0;
+	*delayed = 0;
+	if (flushedWords[0] == unflushedWords[0] && flushedWords[1] == unflushedWords[1])
+	{
+		return;
+	}
+
+	for (int i = 0; i < BLOCK_PIXELS; i++)
+	{
+		if (flushed[i] != unflushed[i])
+		{
+			*changed |= 1u << i;
+		}
+		Periodic flushedAt = {at[i]};
+		if (Periodic_before(pulseAgo, flushedAt) && Periodic_before(flushedAt, now))
+		{
+			*delayed |= 1u << i;
+		}
 	}
+#endif
+}
 
-	delay->rect.width = 0;
-	delay->rect.height = 0;
-	delay->wait_until = Periodic_add(now, fromSeconds(MIN_PULSE_SECONDS));
-	delay->wait_until.ticks += 10;
+/// Commits the unflushed colors of the pixels `[left, right)` of row `y` to the
+/// FrameBuffer.
+/// MODIFIES `committed` to contain the committed pixels.
+static void SlowBuffer_commitSpan(SlowBuffer *sb, size_t y, size_t left, size_t right, Periodic now, Rectangle *committed)
+{
+	size_t index = y * sb->widthPixels + left;
+	size_t count = right - left;
+	FrameBuffer_setSpan(sb->fb, left, y, sb->unflushed_color + index, count);
+	memcpy(sb->flushed_color + index, sb->unflushed_color + index, count);
 
-	size_t screenWidth = sb->widthPixels;
+	uint16_t *at = sb->flushed_at + index;
+	for (size_t i = 0; i < count; i++)
+	{
+		at[i] = now.ticks;
+	}
 
-	size_t updated = 0;
-	size_t delayed = 0;
+	Rectangle_expandToContain(committed, (Rectangle){left, y, count, 1});
+}
 
-	if (x2 > rect.left)
+/// Commits every unflushed pixel of `area` which was not flushed too recently.
+/// `area` must lie within the SlowBuffer.
+/// MODIFIES `committed` and `delay` to contain the committed and delayed pixels.
+static void SlowBuffer_flushArea(SlowBuffer *sb, Rectangle area, Periodic now, Periodic pulseAgo, Rectangle *committed, Rectangle *delay)
+{
+	size_t width = sb->widthPixels;
+	size_t x2 = area.left + area.width;
+	size_t y2 = area.top + area.height;
+	for (size_t y = area.top; y < y2; y++)
 	{
-		size_t y2 = rect.top + rect.height;
-		Rectangle pixel = {0, 0, 1, 1};
-		for (pixel.top = rect.top; pixel.top < y2 && pixel.top < sb->heightPixels; pixel.top++)
+		size_t row = y * width;
+
+		// The pixels `[spanLeft, x)` are waiting to be committed together.
+		size_t spanLeft = area.left;
+
+		// The range of delayed pixels in this row, when `delayLeft < delayRight`.
+		size_t delayLeft = x2;
+		size_t delayRight = 0;
+
+		size_t x = area.left;
+		while (x < x2)
 		{
-			for (pixel.left = rect.left; pixel.left < x2; pixel.left++)
+			uint32_t changed;
+			uint32_t delayed;
+			size_t count = x2 - x;
+			if (count >= BLOCK_PIXELS)
+			{
+				count = BLOCK_PIXELS;
+				SlowBuffer_classifyBlock(sb, row + x, pulseAgo, now, &changed, &delayed);
+			}
+			else
 			{
-				size_t index = pixel.top * screenWidth + pixel.left;
-				uint8_t flushed_color = sb->flushed_color[index];
-				uint8_t unflushed_color = sb->unflushed_color[index];
-				if (flushed_color != unflushed_color)
+				changed = 0;
+				delayed = 0;
+				for (size_t i = 0; i < count; i++)
 				{
-					Periodic flushed_at = {sb->flushed_at[index]};
-					if (Periodic_before(pulseAgo, flushed_at) && Periodic_before(flushed_at, now))
+					size_t index = row + x + i;
+					if (sb->flushed_color[index] != sb->unflushed_color[index])
 					{
-						Rectangle_expandToContain(&delay->rect, pixel);
-						delayed += 1;
+						changed |= 1u << i;
+						Periodic flushed_at = {sb->flushed_at[index]};
+						if (Periodic_before(pulseAgo, flushed_at) && Periodic_before(flushed_at, now))
+						{
+							delayed |= 1u << i;
+						}
 					}
-					else
-					{
-						FrameBuffer_setPixel(sb->fb, pixel.left, pixel.top, unflushed_color);
-						sb->flushed_color[index] = unflushed_color;
-						sb->flushed_at[index] = now.ticks;
+				}
+			}
 
-						updated += 1;
+			uint32_t all = (1u << count) - 1;
+			uint32_t commit = changed & ~delayed;
+			delayed &= changed;
+			if (commit == 0)
+			{
+				if (spanLeft < x)
+				{
+					SlowBuffer_commitSpan(sb, y, spanLeft, x, now, committed);
+				}
+				spanLeft = x + count;
+			}
+			else if (commit != all)
+			{
+				for (size_t i = 0; i < count; i++)
+				{
+					if (!(commit & (1u << i)))
+					{
+						if (spanLeft < x + i)
+						{
+							SlowBuffer_commitSpan(sb, y, spanLeft, x + i, now, committed);
+						}
+						spanLeft = x + i + 1;
 					}
 				}
 			}
+
+			if (delayed != 0)
+			{
+				size_t first = x + __builtin_ctz(delayed);
+				size_t last = x + 31 - __builtin_clz(delayed);
+				delayLeft = first < delayLeft ? first : delayLeft;
+				delayRight = last + 1 > delayRight ? last + 1 : delayRight;
+			}
+
+			x += count;
+		}
+
+		if (spanLeft < x2)
+		{
+			SlowBuffer_commitSpan(sb, y, spanLeft, x2, now, committed);
+		}
+
+		if (delayLeft < delayRight)
+		{
+			Rectangle_expandToContain(delay, (Rectangle){delayLeft, y, delayRight - delayLeft, 1});
+		}
+	}
+}
+
+/// RETURNS whether the deadline has been reached at `now`.
+/// Deadlines are never more than `MIN_PULSE_SECONDS` (plus the merge tolerance)
+/// in the future, so a deadline further ahead than that must have wrapped
+/// around, and has passed long ago.
+static bool Periodic_due(Periodic deadline, Periodic now)
+{
+	uint16_t ahead = deadline.ticks - now.ticks;
+	return ahead == 0 || ahead > fromSeconds(MIN_PULSE_SECONDS).ticks + 10 + MERGE_TOLERANCE_TICKS;
+}
+
+/// RETURNS whether the rectangles overlap or share an edge.
+static bool Rectangle_touches(Rectangle a, Rectangle b)
+{
+	return a.left <= b.left + b.width && b.left <= a.left + a.width && a.top <= b.top + b.height && b.top <= a.top + a.height;
+}
+
+/// RETURNS whether the deadlines are close enough to be merged.
+static bool Periodic_near(Periodic a, Periodic b)
+{
+	uint16_t distance = a.ticks - b.ticks;
+	return distance <= MERGE_TOLERANCE_TICKS || (uint16_t)-distance <= MERGE_TOLERANCE_TICKS;
+}
+
+/// RETURNS the later of two deadlines.
+static Periodic Periodic_later(Periodic a, Periodic b)
+{
+	return Periodic_before(a, b) ? b : a;
+}
+
+/// Removes the element at `index` from the retry queue.
+static QElement SlowBuffer_dequeue(SlowBuffer *sb, size_t index)
+{
+	QElement element = sb->queue[index];
+	memmove(sb->queue + index, sb->queue + index + 1, sizeof(QElement) * (sb->queueLength - index - 1));
+	sb->queueLength -= 1;
+	return element;
+}
+
+/// Enqueues a rectangle to retry flushing once `wait_until` has passed,
+/// merging it with queued rectangles that it overlaps or touches and that have
+/// a similar deadline.
+static void SlowBuffer_enqueue(SlowBuffer *sb, Rectangle rect, Periodic wait_until)
+{
+	QElement element = {rect, wait_until};
+
+	// Merging can cause the element to touch others, so repeat until stable.
+	bool merged = true;
+	while (merged)
+	{
+		merged = false;
+		for (size_t i = 0; i < sb->queueLength; i++)
+		{
+			QElement *other = sb->queue + i;
+			if (Periodic_near(other->wait_until, element.wait_until) && Rectangle_touches(other->rect, element.rect))
+			{
+				Rectangle_expandToContain(&element.rect, other->rect);
+				element.wait_until = Periodic_later(element.wait_until, other->wait_until);
+				SlowBuffer_dequeue(sb, i);
+				merged = true;
+				break;
+			}
 		}
 	}
 
-	FrameBuffer_flush(sb->fb, rect, 1);
+	if (sb->queueLength == QUEUE_CAPACITY)
+	{
+		// Merge into whichever queued rectangle grows the least.
+		size_t best = 0;
+		size_t bestGrowth = SIZE_MAX;
+		for (size_t i = 0; i < sb->queueLength; i++)
+		{
+			Rectangle bounds = sb->queue[i].rect;
+			Rectangle_expandToContain(&bounds, element.rect);
+			size_t growth = bounds.width * bounds.height - sb->queue[i].rect.width * sb->queue[i].rect.height;
+			if (growth < bestGrowth)
+			{
+				best = i;
+				bestGrowth = growth;
+			}
+		}
+		QElement other = SlowBuffer_dequeue(sb, best);
+		Rectangle_expandToContain(&element.rect, other.rect);
+		element.wait_until = Periodic_later(element.wait_until, other.wait_until);
+	}
+
+	// Insert in order of deadline.
+	size_t index = sb->queueLength;
+	while (index != 0 && Periodic_before(element.wait_until, sb->queue[index - 1].wait_until))
+	{
+		index -= 1;
+	}
+	memmove(sb->queue + index + 1, sb->queue + index, sizeof(QElement) * (sb->queueLength - index));
+	sb->queue[index] = element;
+	sb->queueLength += 1;
+}
+
+/// Commits the unflushed pixels in the rectangle which were not flushed too
+/// recently, visiting only dirty tiles. Delayed pixels are queued to be
+/// retried.
+/// MODIFIES `committed` to contain the committed pixels, which must be flushed
+/// to the FrameBuffer.
+static void SlowBuffer_tryflush(SlowBuffer *sb, Rectangle rect, Region *committed)
+{
+	Clock clock = Clock_monotonic();
+
+	Periodic now = fromSeconds(Clock_getSeconds(&clock));
+	Periodic pulseAgo = Periodic_add(now, fromSeconds(-MIN_PULSE_SECONDS));
+	Periodic wait_until = Periodic_add(now, fromSeconds(MIN_PULSE_SECONDS));
+	wait_until.ticks += 10;
+
+	size_t x2 = rect.left + rect.width;
+	if (x2 > sb->widthPixels)
+	{
+		x2 = sb->widthPixels;
+	}
+	size_t y2 = rect.top + rect.height;
+	if (y2 > sb->heightPixels)
+	{
+		y2 = sb->heightPixels;
+	}
+	if (x2 <= rect.left || y2 <= rect.top)
+	{
+		return;
+	}
+	uint64_t began = Profile_begin();
+
+	size_t tx2 = (x2 + TILE_PIXELS - 1) / TILE_PIXELS;
+	size_t ty2 = (y2 + TILE_PIXELS - 1) / TILE_PIXELS;
+	for (size_t ty = rect.top / TILE_PIXELS; ty < ty2; ty++)
+	{
+		size_t top = ty * TILE_PIXELS;
+		size_t bottom = top + TILE_PIXELS < sb->heightPixels ? top + TILE_PIXELS : sb->heightPixels;
+		bool wholeRows = rect.top <= top && y2 >= bottom;
+		top = top > rect.top ? top : rect.top;
+		bottom = bottom < y2 ? bottom : y2;
+
+		size_t tx = rect.left / TILE_PIXELS;
+		while (tx < tx2)
+		{
+			Tile *tile = sb->tiles + ty * sb->tilesWide + tx;
+			if (!tile->dirty)
+			{
+				tx++;
+				continue;
+			}
+			if (tile->settled && !Periodic_due(tile->wait_until, now))
+			{
+				// Every unflushed pixel in this tile is still delayed.
+				size_t left = tx * TILE_PIXELS > rect.left ? tx * TILE_PIXELS : rect.left;
+				size_t right = (tx + 1) * TILE_PIXELS < x2 ? (tx + 1) * TILE_PIXELS : x2;
+				SlowBuffer_enqueue(sb, (Rectangle){left, top, right - left, bottom - top}, tile->wait_until);
+				tx++;
+				continue;
+			}
+
+			// Flush the run of adjacent tiles which need it together, so that
+			// each row is committed in long spans rather than a span per tile.
+			size_t runEnd = tx + 1;
+			while (runEnd < tx2)
+			{
+				Tile const *next = sb->tiles + ty * sb->tilesWide + runEnd;
+				if (!next->dirty || (next->settled && !Periodic_due(next->wait_until, now)))
+				{
+					break;
+				}
+				runEnd++;
+			}
+			size_t left = tx * TILE_PIXELS > rect.left ? tx * TILE_PIXELS : rect.left;
+			size_t right = runEnd * TILE_PIXELS < x2 ? runEnd * TILE_PIXELS : x2;
+			Rectangle area = {left, top, right - left, bottom - top};
+
+			Rectangle runCommitted = {0, 0, 0, 0};
+			Rectangle delay = {0, 0, 0, 0};
+			SlowBuffer_flushArea(sb, area, now, pulseAgo, &runCommitted, &delay);
+			Region_add(committed, runCommitted);
+			if (delay.width != 0)
+			{
+				SlowBuffer_enqueue(sb, delay, wait_until);
+			}
 
-	return delay->rect.width != 0;
+			// Whatever the flush left unflushed is delayed, so a tile it covered
+			// entirely is either clean or settled.
+			for (; tx < runEnd; tx++)
+			{
+				size_t tileLeft = tx * TILE_PIXELS;
+				size_t tileRight = tileLeft + TILE_PIXELS < sb->widthPixels ? tileLeft + TILE_PIXELS : sb->widthPixels;
+				if (!wholeRows || rect.left > tileLeft || x2 < tileRight)
+				{
+					continue;
+				}
+				tile = sb->tiles + ty * sb->tilesWide + tx;
+				if (delay.width != 0 && delay.left < tileRight && tileLeft < delay.left + delay.width)
+				{
+					tile->settled = true;
+					tile->wait_until = wait_until;
+				}
+				else
+				{
+					tile->dirty = false;
+				}
+			}
+		}
+	}
+	Profile_end("SlowBuffer_tryflush", began);
 }
 
 void SlowBuffer_flush(SlowBuffer *sb, Rectangle rectangle)
 {
 	// Flush ONLY those pixels which were rendered long enough ago.
-	if (SlowBuffer_tryflush(sb, rectangle, &sb->queue[sb->queueWrite]))
+	Region committed = Region_empty(REGION_DEFAULT_OVERHEAD);
+	SlowBuffer_tryflush(sb, rectangle, &committed);
+	FrameBuffer_flushRegion(sb->fb, &committed, 1);
+	SlowBuffer_ping(sb);
+}
+
+void SlowBuffer_flushRegion(SlowBuffer *sb, Region const *region)
+{
+	Region committed = Region_empty(region->overhead);
+	for (size_t i = 0; i < region->count; i++)
 	{
-		sb->queueWrite = (sb->queueWrite + 1) % sb->queueCapacity;
+		SlowBuffer_tryflush(sb, region->rects[i], &committed);
 	}
+	FrameBuffer_flushRegion(sb->fb, &committed, 1);
 	SlowBuffer_ping(sb);
 }
 
@@ -196,22 +648,46 @@ void SlowBuffer_ping(SlowBuffer *sb)
 	Clock clock = Clock_monotonic();
 	Periodic now = fromSeconds(Clock_getSeconds(&clock));
 
-	// Assume the queue buffer doesn't fill up
-	// (would require flushes > queueCapacity within MIN_PULSE_SECONDS pings())
-	while (sb->queueRead != sb->queueWrite)
+	// Take every due rectangle at once, since retrying may queue more.
+	size_t due = 0;
+	while (due < sb->queueLength && Periodic_due(sb->queue[due].wait_until, now))
 	{
-		QElement dummy = {{0, 0, 0, 0}, {0}};
-		QElement *front = sb->queue + sb->queueRead;
-		if (Periodic_before(front->wait_until, now))
-		{
-			SlowBuffer_tryflush(sb, front->rect, &dummy);
-			sb->queueRead = (sb->queueRead + 1) % (sb->queueCapacity);
-		}
-		else
-		{
-			break;
-		}
+		due += 1;
+	}
+	if (due == 0)
+	{
+		return;
+	}
+	QElement retries[QUEUE_CAPACITY];
+	memcpy(retries, sb->queue, sizeof(QElement) * due);
+	memmove(sb->queue, sb->queue + due, sizeof(QElement) * (sb->queueLength - due));
+	sb->queueLength -= due;
+
+	// Batch everything committed by the retries into as few updates as are
+	// worth their overhead.
+	Region committed = Region_empty(REGION_DEFAULT_OVERHEAD);
+	for (size_t i = 0; i < due; i++)
+	{
+		SlowBuffer_tryflush(sb, retries[i].rect, &committed);
+	}
+	FrameBuffer_flushRegion(sb->fb, &committed, 1);
+}
+
+double SlowBuffer_secondsUntilNext(SlowBuffer const *sb)
+{
+	if (sb->queueLength == 0)
+	{
+		return -1;
+	}
+
+	Clock clock = Clock_monotonic();
+	Periodic now = fromSeconds(Clock_getSeconds(&clock));
+	Periodic front = sb->queue[0].wait_until;
+	if (Periodic_due(front, now))
+	{
+		return 0;
 	}
+	return (uint16_t)(front.ticks - now.ticks) * TIME_BOX_SECONDS / UINT16_MAX;
 }
 
 Rectangle SlowBuffer_size(SlowBuffer *sb)
@@ -224,6 +700,6 @@ void SlowBuffer_deallocate(SlowBuffer *sb)
 	free(sb->flushed_color);
 	free(sb->unflushed_color);
 	free(sb->flushed_at);
-	free(sb->queue);
+	free(sb->tiles);
 	free(sb);
 }
@@ -8,6 +8,10 @@
 struct SlowBuffer;
 typedef struct SlowBuffer SlowBuffer;
 
+// A pixel isn't flushed again until this many seconds after it was last
+// flushed; until then, it is delayed.
+extern const double MIN_PULSE_SECONDS;
+
 SlowBuffer *SlowBuffer_allocate(FrameBuffer *fb);
 
 void SlowBuffer_deallocate(SlowBuffer *sb);
@@ -15,10 +19,26 @@ void SlowBuffer_deallocate(SlowBuffer *sb);
 void SlowBuffer_setPixel(SlowBuffer *sb, size_t x, size_t y, uint8_t color);
 void SlowBuffer_setRect(SlowBuffer *sb, Rectangle rect, uint8_t color);
 
+/// Sets the colors of `count` consecutive pixels of row `y`, starting at column
+/// `x`, which must be within the SlowBuffer.
+void SlowBuffer_writeSpan(SlowBuffer *sb, size_t x, size_t y, uint8_t const *colors, size_t count);
+
+/// Reads the (possibly not yet flushed) colors of `count` consecutive pixels of
+/// row `y`, starting at column `x`, into `colors`.
+void SlowBuffer_readSpan(SlowBuffer const *sb, size_t x, size_t y, uint8_t *colors, size_t count);
+
 void SlowBuffer_flush(SlowBuffer *sb, Rectangle rectangle);
 
+/// Flushes every rectangle of the Region, batching the committed pixels into
+/// updates by the Region's overhead.
+void SlowBuffer_flushRegion(SlowBuffer *sb, Region const *region);
+
 Rectangle SlowBuffer_size(SlowBuffer *sb);
 
 void SlowBuffer_ping(SlowBuffer *sb);
 
+/// RETURNS the number of seconds until `SlowBuffer_ping` has delayed pixels to
+/// flush, or a negative number when nothing is delayed.
+double SlowBuffer_secondsUntilNext(SlowBuffer const *sb);
+
 #endif
@@ -0,0 +1,114 @@
+#include "stroke.h"
+
+#include <math.h>
+
+static double clamp01(double v)
+{
+	return v < 0 ? 0 : v > 1 ? 1 : v;
+}
+
+double Brush_radius(Brush brush, double pressure, double tilt)
+{
+	double radius = brush.minRadius + (brush.maxRadius - brush.minRadius) * clamp01(pressure);
+	return radius * (1 + brush.tiltGrowth * clamp01(tilt));
+}
+
+/// MODIFIES `[lo, hi]` to contain the part of the row at height `cy` within the
+/// disc around `p`.
+static void Stroke_discSpan(StrokePoint p, double cy, double *lo, double *hi)
+{
+	double dy = cy - p.y;
+	double squared = p.radius * p.radius - dy * dy;
+	if (squared < 0)
+	{
+		return;
+	}
+
+	double half = sqrt(squared);
+	*lo = fmin(*lo, p.x - half);
+	*hi = fmax(*hi, p.x + half);
+}
+
+void Stroke_segment(Raster raster, StrokePoint a, StrokePoint b, uint16_t color, Rectangle *dirty)
+{
+	double dx = b.x - a.x;
+	double dy = b.y - a.y;
+	double d = sqrt(dx * dx + dy * dy);
+
+	// When one disc contains the other, the hull is just the larger disc.
+	if (d <= fabs(a.radius - b.radius))
+	{
+		a = a.radius >= b.radius ? a : b;
+		b = a;
+		d = 0;
+	}
+
+	// The points where the two outer tangent lines touch the discs, which
+	// bound the quadrilateral joining them.
+	double quad[4][2];
+	if (d > 0)
+	{
+		double ux = dx / d;
+		double uy = dy / d;
+		double s = (a.radius - b.radius) / d;
+		double c = sqrt(1 - s * s);
+		double w1x = ux * s - uy * c;
+		double w1y = uy * s + ux * c;
+		double w2x = ux * s + uy * c;
+		double w2y = uy * s - ux * c;
+		quad[0][0] = a.x + a.radius * w1x;
+		quad[0][1] = a.y + a.radius * w1y;
+		quad[1][0] = b.x + b.radius * w1x;
+		quad[1][1] = b.y + b.radius * w1y;
+		quad[2][0] = b.x + b.radius * w2x;
+		quad[2][1] = b.y + b.radius * w2y;
+		quad[3][0] = a.x + a.radius * w2x;
+		quad[3][1] = a.y + a.radius * w2y;
+	}
+
+	long top = (long)floor(fmin(a.y - a.radius, b.y - b.radius));
+	long bottom = (long)ceil(fmax(a.y + a.radius, b.y + b.radius));
+	if (top < (long)raster.clip.top)
+	{
+		top = (long)raster.clip.top;
+	}
+	if (bottom > (long)(raster.clip.top + raster.clip.height))
+	{
+		bottom = (long)(raster.clip.top + raster.clip.height);
+	}
+
+	for (long y = top; y < bottom; y++)
+	{
+		// The hull is convex, so each row of it is a single span.
+		double cy = y + 0.5;
+		double lo = INFINITY;
+		double hi = -INFINITY;
+		Stroke_discSpan(a, cy, &lo, &hi);
+		Stroke_discSpan(b, cy, &lo, &hi);
+
+		if (d > 0)
+		{
+			for (int i = 0; i < 4; i++)
+			{
+				double const *p = quad[i];
+				double const *q = quad[(i + 1) % 4];
+				if (p[1] != q[1] && fmin(p[1], q[1]) <= cy && cy <= fmax(p[1], q[1]))
+				{
+					double x = p[0] + (cy - p[1]) * (q[0] - p[0]) / (q[1] - p[1]);
+					lo = fmin(lo, x);
+					hi = fmax(hi, x);
+				}
+			}
+		}
+
+		if (lo > hi)
+		{
+			continue;
+		}
+
+		// Fill the pixels whose centers are within `[lo, hi]`.
+		long left = (long)ceil(lo - 0.5);
+		long right = (long)floor(hi - 0.5) + 1;
+		Raster_fillSpan(raster, left, right, y, color, dirty);
+	}
+}
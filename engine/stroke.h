@@ -0,0 +1,41 @@
+#ifndef _CF_STROKE
+#define _CF_STROKE
+
+#include "stdbool.h"
+
+#include "raster.h"
+
+// A point along a stroke, in (fractional) screen pixels, with the radius of the
+// brush at that point.
+typedef struct
+{
+	double x;
+	double y;
+	double radius;
+} StrokePoint;
+
+// A Brush maps the pen's pressure and tilt to the radius of the stroke.
+typedef struct
+{
+	// The radius of the stroke, in pixels, at the lightest and firmest
+	// pressure.
+	double minRadius;
+	double maxRadius;
+
+	// How much the radius grows (as a fraction) when the pen is fully tilted.
+	double tiltGrowth;
+} Brush;
+
+/// `pressure`: from 0 to 1.
+/// `tilt`: the angle of the pen away from vertical, from 0 to 1 (fully tilted).
+/// RETURNS the radius of the brush, in pixels.
+double Brush_radius(Brush brush, double pressure, double tilt);
+
+/// Fills the segment from `a` to `b` with solid round caps: the convex hull of
+/// the disc at `a` and the disc at `b`. A pixel is filled when its center is
+/// within the hull. Successive segments of a stroke share their end discs, so
+/// a fast stroke is drawn without gaps however far apart its samples are.
+/// MODIFIES `dirty` to contain every pixel which was filled.
+void Stroke_segment(Raster raster, StrokePoint a, StrokePoint b, uint16_t color, Rectangle *dirty);
+
+#endif
@@ -0,0 +1,168 @@
+#include "surface.h"
+
+#include <assert.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct Surface
+{
+	size_t width;
+	size_t height;
+	unsigned bits;
+
+	// The number of bytes between the starts of consecutive rows.
+	size_t stride;
+
+	// For 1-bit Surfaces, bit `x % 8` of byte `x / 8` of a row is the pixel in
+	// column `x`.
+	uint8_t *data;
+};
+
+Surface *Surface_allocate(size_t width, size_t height, unsigned bits)
+{
+	if ((bits != 1 && bits != 8 && bits != 16) || width > SURFACE_MAX_SIDE || height > SURFACE_MAX_SIDE)
+	{
+		return NULL;
+	}
+
+	Surface *surface = (Surface *)malloc(sizeof(Surface));
+	if (surface == NULL)
+	{
+		return NULL;
+	}
+
+	surface->width = width;
+	surface->height = height;
+	surface->bits = bits;
+	surface->stride = bits == 1 ? (width + 7) / 8 : width * (bits / 8);
+	surface->data = (uint8_t *)calloc(height ? height : 1, surface->stride ? surface->stride : 1);
+	if (surface->data == NULL)
+	{
+		free(surface);
+		return NULL;
+	}
+	return surface;
+}
+
+void Surface_deallocate(Surface *surface)
+{
+	free(surface->data);
+	free(surface);
+}
+
+Rectangle Surface_size(Surface const *surface)
+{
+	return (Rectangle){0, 0, surface->width, surface->height};
+}
+
+unsigned Surface_bits(Surface const *surface)
+{
+	return surface->bits;
+}
+
+/// Sets the bits `[x, x + count)` of a 1-bit row to `on`.
+static void Surface_fillBits(uint8_t *row, size_t x, size_t count, bool on)
+{
+	size_t end = x + count;
+	while (x < end)
+	{
+		size_t bit = x % 8;
+		size_t take = 8 - bit < end - x ? 8 - bit : end - x;
+		uint8_t mask = (uint8_t)(((1u << take) - 1) << bit);
+		if (on)
+		{
+			row[x / 8] |= mask;
+		}
+		else
+		{
+			row[x / 8] &= (uint8_t)~mask;
+		}
+		x += take;
+	}
+}
+
+void Surface_fillSpan(Surface *surface, size_t x, size_t y, size_t count, uint16_t color)
+{
+	assert(x + count <= surface->width);
+	assert(y < surface->height);
+
+	uint8_t *row = surface->data + y * surface->stride;
+	if (surface->bits == 1)
+	{
+		Surface_fillBits(row, x, count, color & 1);
+	}
+	else if (surface->bits == 8)
+	{
+		memset(row + x, (uint8_t)color, count);
+	}
+	else
+	{
+		uint16_t *to = (uint16_t *)row + x;
+		for (size_t i = 0; i < count; i++)
+		{
+			to[i] = color;
+		}
+	}
+}
+
+void Surface_writeSpan(Surface *surface, size_t x, size_t y, uint16_t const *colors, size_t count)
+{
+	assert(x + count <= surface->width);
+	assert(y < surface->height);
+
+	uint8_t *row = surface->data + y * surface->stride;
+	if (surface->bits == 1)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			size_t column = x + i;
+			if (colors[i] & 1)
+			{
+				row[column / 8] |= (uint8_t)(1u << (column % 8));
+			}
+			else
+			{
+				row[column / 8] &= (uint8_t) ~(1u << (column % 8));
+			}
+		}
+	}
+	else if (surface->bits == 8)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			row[x + i] = (uint8_t)colors[i];
+		}
+	}
+	else
+	{
+		memmove((uint16_t *)row + x, colors, count * sizeof(uint16_t));
+	}
+}
+
+void Surface_readSpan(Surface const *surface, size_t x, size_t y, uint16_t *colors, size_t count)
+{
+	assert(x + count <= surface->width);
+	assert(y < surface->height);
+
+	uint8_t const *row = surface->data + y * surface->stride;
+	if (surface->bits == 1)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			size_t column = x + i;
+			colors[i] = (row[column / 8] >> (column % 8)) & 1;
+		}
+	}
+	else if (surface->bits == 8)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			colors[i] = row[x + i];
+		}
+	}
+	else
+	{
+		memmove(colors, (uint16_t const *)row + x, count * sizeof(uint16_t));
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef _CF_SURFACE
+#define _CF_SURFACE
+
+#include "stddef.h"
+#include "stdint.h"
+
+#include "framebuffer.h"
+
+// A Surface is an offscreen image in memory, which can be drawn into and then
+// copied onto the screen (or another Surface). Surfaces have 1, 8, or 16 bits
+// per pixel; a 1-bit Surface is typically used as a mask.
+
+struct Surface;
+typedef struct Surface Surface;
+
+// The largest width or height of a Surface, which keeps the size of its pixels
+// within a 32-bit `size_t`.
+#define SURFACE_MAX_SIDE 32768
+
+/// RETURNS a Surface of the given size with every pixel 0, or `NULL` if there
+/// was a problem allocating it, `bits` is not 1, 8, or 16, or a side is longer
+/// than `SURFACE_MAX_SIDE`.
+Surface *Surface_allocate(size_t width, size_t height, unsigned bits);
+
+void Surface_deallocate(Surface *surface);
+
+Rectangle Surface_size(Surface const *surface);
+
+/// RETURNS the number of bits per pixel.
+unsigned Surface_bits(Surface const *surface);
+
+/// Sets the `count` pixels of row `y` starting at column `x` to `color`,
+/// keeping only as many low bits of it as the Surface has.
+void Surface_fillSpan(Surface *surface, size_t x, size_t y, size_t count, uint16_t color);
+
+/// Sets the `count` pixels of row `y` starting at column `x` from `colors`,
+/// keeping only as many low bits of each as the Surface has.
+void Surface_writeSpan(Surface *surface, size_t x, size_t y, uint16_t const *colors, size_t count);
+
+/// Reads the `count` pixels of row `y` starting at column `x` into `colors`.
+void Surface_readSpan(Surface const *surface, size_t x, size_t y, uint16_t *colors, size_t count);
+
+#endif
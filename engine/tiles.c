@@ -0,0 +1,426 @@
+#include "tiles.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "lua.h"
+#include "lauxlib.h"
+#include "lualib.h"
+
+#include "profile.h"
+
+#define MAXIMUM_WORKERS 8
+
+// The registry key of a worker's compiled chunk.
+static char s_chunkKey;
+
+typedef struct
+{
+	TileRenderer *renderer;
+	pthread_t thread;
+	lua_State *L;
+
+	// The source of the compiled chunk, to recognize a repeated kernel.
+	char *code;
+	size_t codeLength;
+
+	// The render whose kernel is at the bottom of the worker's stack.
+	uint32_t generation;
+} Worker;
+
+struct TileRenderer
+{
+	pthread_mutex_t lock;
+
+	// Signalled when a render starts, or when the workers should stop.
+	pthread_cond_t work;
+
+	// Signalled when a worker finishes a tile.
+	pthread_cond_t progress;
+
+	bool stopping;
+	size_t workerCount;
+	Worker workers[MAXIMUM_WORKERS];
+
+	// The current render, or `NULL`; every other field below is only
+	// meaningful during a render.
+	TileJob const *job;
+	uint32_t generation;
+	size_t tileSize;
+	size_t tilesAcross;
+	size_t tileCount;
+	size_t nextTile;
+
+	// The number of workers rendering a tile.
+	size_t busy;
+
+	// The colors of the whole area, with rows `job->area.width` apart.
+	uint16_t *colors;
+	size_t colorsCapacity;
+
+	// The indices of the completed tiles, in the order they were completed.
+	size_t *completed;
+	size_t completedCapacity;
+	size_t completedCount;
+
+	bool failed;
+	char error[256];
+};
+
+TileRenderer *TileRenderer_allocate(void)
+{
+	TileRenderer *renderer = (TileRenderer *)calloc(1, sizeof(TileRenderer));
+	if (renderer == NULL)
+	{
+		return NULL;
+	}
+
+	pthread_mutex_init(&renderer->lock, NULL);
+	pthread_cond_init(&renderer->work, NULL);
+	pthread_cond_init(&renderer->progress, NULL);
+	return renderer;
+}
+
+void TileRenderer_deallocate(TileRenderer *renderer)
+{
+	pthread_mutex_lock(&renderer->lock);
+	renderer->stopping = true;
+	pthread_cond_broadcast(&renderer->work);
+	pthread_mutex_unlock(&renderer->lock);
+
+	for (size_t i = 0; i < renderer->workerCount; i++)
+	{
+		pthread_join(renderer->workers[i].thread, NULL);
+		lua_close(renderer->workers[i].L);
+		free(renderer->workers[i].code);
+	}
+
+	pthread_cond_destroy(&renderer->progress);
+	pthread_cond_destroy(&renderer->work);
+	pthread_mutex_destroy(&renderer->lock);
+	free(renderer->colors);
+	free(renderer->completed);
+	free(renderer);
+}
+
+/// RETURNS the rectangle of the current render's tile `index`.
+static Rectangle TileRenderer_tile(TileRenderer const *renderer, size_t index)
+{
+	Rectangle area = renderer->job->area;
+	Rectangle tile = {
+		area.left + index % renderer->tilesAcross * renderer->tileSize,
+		area.top + index / renderer->tilesAcross * renderer->tileSize,
+		renderer->tileSize,
+		renderer->tileSize,
+	};
+	if (tile.left + tile.width > area.left + area.width)
+	{
+		tile.width = area.left + area.width - tile.left;
+	}
+	if (tile.top + tile.height > area.top + area.height)
+	{
+		tile.height = area.top + area.height - tile.top;
+	}
+	return tile;
+}
+
+/// Records the first error of the render, and stops any more tiles from being
+/// started. The lock must be held.
+static void TileRenderer_fail(TileRenderer *renderer, char const *message)
+{
+	if (!renderer->failed)
+	{
+		renderer->failed = true;
+		snprintf(renderer->error, sizeof(renderer->error), "%s", message);
+	}
+	renderer->nextTile = renderer->tileCount;
+}
+
+/// Compiles the job's chunk, if the worker has not already, and calls it to
+/// leave the kernel at the bottom of the worker's stack.
+/// RETURNS `false`, leaving an error message on the stack, if the chunk could
+/// not be compiled, raised an error, or did not return a function.
+static bool Worker_prepare(Worker *worker, TileJob const *job)
+{
+	lua_State *L = worker->L;
+	lua_settop(L, 0);
+
+	if (worker->code == NULL || worker->codeLength != job->codeLength || memcmp(worker->code, job->code, job->codeLength) != 0)
+	{
+		free(worker->code);
+		worker->code = NULL;
+		if (luaL_loadbuffer(L, job->code, job->codeLength, "=kernel") != LUA_OK)
+		{
+			return false;
+		}
+		lua_rawsetp(L, LUA_REGISTRYINDEX, &s_chunkKey);
+
+		worker->code = (char *)malloc(job->codeLength);
+		if (worker->code != NULL)
+		{
+			memcpy(worker->code, job->code, job->codeLength);
+			worker->codeLength = job->codeLength;
+		}
+	}
+
+	lua_rawgetp(L, LUA_REGISTRYINDEX, &s_chunkKey);
+	for (size_t i = 0; i < job->argumentCount; i++)
+	{
+		TileArgument const *argument = &job->arguments[i];
+		switch (argument->type)
+		{
+		case TILE_ARGUMENT_NIL:
+			lua_pushnil(L);
+			break;
+		case TILE_ARGUMENT_BOOLEAN:
+			lua_pushboolean(L, argument->boolean);
+			break;
+		case TILE_ARGUMENT_INTEGER:
+			lua_pushinteger(L, (lua_Integer)argument->integer);
+			break;
+		case TILE_ARGUMENT_NUMBER:
+			lua_pushnumber(L, argument->number);
+			break;
+		case TILE_ARGUMENT_STRING:
+			lua_pushlstring(L, argument->string, argument->length);
+			break;
+		}
+	}
+
+	if (lua_pcall(L, (int)job->argumentCount, 1, 0) != LUA_OK)
+	{
+		return false;
+	}
+	if (!lua_isfunction(L, 1))
+	{
+		lua_settop(L, 0);
+		lua_pushstring(L, "the kernel's chunk must return a function");
+		return false;
+	}
+	return true;
+}
+
+/// Evaluates the kernel (at the bottom of the worker's stack) over the cells of
+/// a tile, writing their colors.
+/// RETURNS `false`, leaving an error message on the stack, if the kernel raised
+/// an error or did not return a number.
+static bool Worker_renderTile(Worker *worker, TileJob const *job, Rectangle tile, uint16_t *colors, size_t stride)
+{
+	lua_State *L = worker->L;
+	size_t right = tile.left + tile.width;
+	size_t bottom = tile.top + tile.height;
+	for (size_t y = tile.top; y < bottom; y += job->cell)
+	{
+		size_t cellBottom = y + job->cell < bottom ? y + job->cell : bottom;
+		for (size_t x = tile.left; x < right; x += job->cell)
+		{
+			size_t cellRight = x + job->cell < right ? x + job->cell : right;
+
+			lua_pushvalue(L, 1);
+			lua_pushinteger(L, (lua_Integer)x);
+			lua_pushinteger(L, (lua_Integer)y);
+			lua_pushinteger(L, (lua_Integer)job->cell);
+			if (lua_pcall(L, 3, 1, 0) != LUA_OK)
+			{
+				return false;
+			}
+
+			int isNumber;
+			lua_Number value = lua_tonumberx(L, -1, &isNumber);
+			lua_pop(L, 1);
+			if (!isNumber)
+			{
+				lua_pushstring(L, "the kernel must return a color");
+				return false;
+			}
+			uint16_t color = value <= 0 ? 0 : value >= job->maximumColor ? job->maximumColor : (uint16_t)(value + 0.5);
+
+			for (size_t cy = y; cy < cellBottom; cy++)
+			{
+				uint16_t *row = colors + (cy - job->area.top) * stride;
+				for (size_t cx = x; cx < cellRight; cx++)
+				{
+					row[cx - job->area.left] = color;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static void *Worker_run(void *vworker)
+{
+	Worker *worker = vworker;
+	TileRenderer *renderer = worker->renderer;
+
+	pthread_mutex_lock(&renderer->lock);
+	while (true)
+	{
+		while (!renderer->stopping && (renderer->job == NULL || renderer->nextTile >= renderer->tileCount))
+		{
+			pthread_cond_wait(&renderer->work, &renderer->lock);
+		}
+		if (renderer->stopping)
+		{
+			break;
+		}
+
+		TileJob const *job = renderer->job;
+		Rectangle tile = TileRenderer_tile(renderer, renderer->nextTile);
+		size_t index = renderer->nextTile++;
+		bool prepared = worker->generation == renderer->generation;
+		uint32_t generation = renderer->generation;
+		renderer->busy += 1;
+		pthread_mutex_unlock(&renderer->lock);
+
+		// Tiles are disjoint, so their colors can be written without the lock.
+		uint64_t began = Profile_begin();
+		bool ok = prepared || Worker_prepare(worker, job);
+		if (ok)
+		{
+			worker->generation = generation;
+			ok = Worker_renderTile(worker, job, tile, renderer->colors, job->area.width);
+		}
+		Profile_end("tile", began);
+
+		pthread_mutex_lock(&renderer->lock);
+		renderer->busy -= 1;
+		if (ok)
+		{
+			renderer->completed[renderer->completedCount++] = index;
+		}
+		else
+		{
+			char const *message = lua_tostring(worker->L, -1);
+			TileRenderer_fail(renderer, message != NULL ? message : "the kernel raised an error");
+
+			// The kernel must be prepared again.
+			worker->generation = 0;
+		}
+		pthread_cond_signal(&renderer->progress);
+	}
+	pthread_mutex_unlock(&renderer->lock);
+	return NULL;
+}
+
+/// Starts a worker for each core, if they have not been started.
+/// RETURNS `false` if no worker could be started.
+static bool TileRenderer_start(TileRenderer *renderer)
+{
+	if (renderer->workerCount != 0)
+	{
+		return true;
+	}
+
+	long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	size_t wanted = cores < 1 ? 1 : cores > MAXIMUM_WORKERS ? MAXIMUM_WORKERS : (size_t)cores;
+	for (size_t i = 0; i < wanted; i++)
+	{
+		Worker *worker = &renderer->workers[renderer->workerCount];
+		*worker = (Worker){renderer, 0, luaL_newstate(), NULL, 0, 0};
+		if (worker->L == NULL)
+		{
+			break;
+		}
+		luaL_openlibs(worker->L);
+
+		if (pthread_create(&worker->thread, NULL, Worker_run, worker) != 0)
+		{
+			lua_close(worker->L);
+			break;
+		}
+		renderer->workerCount += 1;
+	}
+	return renderer->workerCount != 0;
+}
+
+char const *TileRenderer_render(TileRenderer *renderer, TileJob const *job, void *context, void (*done)(void *context, Rectangle tile, uint16_t const *colors, size_t stride), void (*idle)(void *context))
+{
+	Rectangle area = job->area;
+	if (area.width == 0 || area.height == 0)
+	{
+		return NULL;
+	}
+
+	size_t tileSize = (TILE_PIXELS + job->cell - 1) / job->cell * job->cell;
+	size_t tilesAcross = (area.width + tileSize - 1) / tileSize;
+	size_t tileCount = tilesAcross * ((area.height + tileSize - 1) / tileSize);
+
+	pthread_mutex_lock(&renderer->lock);
+	if (!TileRenderer_start(renderer))
+	{
+		pthread_mutex_unlock(&renderer->lock);
+		return "could not start the worker threads";
+	}
+
+	if (renderer->colorsCapacity < area.width * area.height)
+	{
+		free(renderer->colors);
+		renderer->colors = (uint16_t *)malloc(area.width * area.height * sizeof(uint16_t));
+		renderer->colorsCapacity = renderer->colors == NULL ? 0 : area.width * area.height;
+	}
+	if (renderer->completedCapacity < tileCount)
+	{
+		free(renderer->completed);
+		renderer->completed = (size_t *)malloc(tileCount * sizeof(size_t));
+		renderer->completedCapacity = renderer->completed == NULL ? 0 : tileCount;
+	}
+	if (renderer->colors == NULL || renderer->completed == NULL)
+	{
+		pthread_mutex_unlock(&renderer->lock);
+		return "could not allocate the tiles";
+	}
+
+	renderer->job = job;
+	// Skip 0, which marks a worker without a kernel.
+	renderer->generation = renderer->generation + 1 == 0 ? 1 : renderer->generation + 1;
+	renderer->tileSize = tileSize;
+	renderer->tilesAcross = tilesAcross;
+	renderer->tileCount = tileCount;
+	renderer->nextTile = 0;
+	renderer->busy = 0;
+	renderer->completedCount = 0;
+	renderer->failed = false;
+	pthread_cond_broadcast(&renderer->work);
+
+	size_t drained = 0;
+	bool pending = false;
+	while (true)
+	{
+		if (drained < renderer->completedCount)
+		{
+			size_t index = renderer->completed[drained++];
+			pthread_mutex_unlock(&renderer->lock);
+
+			Rectangle tile = TileRenderer_tile(renderer, index);
+			uint16_t const *colors = renderer->colors + (tile.top - area.top) * area.width + (tile.left - area.left);
+			done(context, tile, colors, area.width);
+
+			pthread_mutex_lock(&renderer->lock);
+			pending = true;
+		}
+		else if (pending)
+		{
+			pthread_mutex_unlock(&renderer->lock);
+			idle(context);
+			pthread_mutex_lock(&renderer->lock);
+			pending = false;
+		}
+		else if (renderer->nextTile >= tileCount && renderer->busy == 0)
+		{
+			break;
+		}
+		else
+		{
+			pthread_cond_wait(&renderer->progress, &renderer->lock);
+		}
+	}
+
+	renderer->job = NULL;
+	bool failed = renderer->failed;
+	pthread_mutex_unlock(&renderer->lock);
+	return failed ? renderer->error : NULL;
+}
@@ -0,0 +1,85 @@
+#ifndef _CF_TILES
+#define _CF_TILES
+
+#include "stdbool.h"
+#include "stddef.h"
+#include "stdint.h"
+
+#include "region.h"
+
+// A TileRenderer evaluates a Lua kernel over the cells of a rectangle on a pool
+// of worker threads, one per core, each with its own Lua state. The rectangle
+// is divided into square tiles, which the workers take in turn; completed
+// tiles are handed back to the calling thread to be drawn and flushed while
+// the workers continue.
+//
+// The worker threads are started by the first render, and their Lua states
+// (and each kernel's compiled chunk) are kept for later renders.
+
+// The side of a tile, in pixels, which is rounded up to a multiple of the cell
+// size.
+#define TILE_PIXELS 128
+
+// The most arguments that can be passed to a kernel's chunk.
+#define TILE_ARGUMENTS 16
+
+struct TileRenderer;
+typedef struct TileRenderer TileRenderer;
+
+typedef enum
+{
+	TILE_ARGUMENT_NIL,
+	TILE_ARGUMENT_BOOLEAN,
+	TILE_ARGUMENT_INTEGER,
+	TILE_ARGUMENT_NUMBER,
+	TILE_ARGUMENT_STRING,
+} TileArgumentType;
+
+// A value copied into each worker's Lua state; only the field for its type is
+// used.
+typedef struct
+{
+	TileArgumentType type;
+	bool boolean;
+	long long integer;
+	double number;
+
+	// Not copied, so it must outlive the render.
+	char const *string;
+	size_t length;
+} TileArgument;
+
+typedef struct
+{
+	// The source of a Lua chunk, which is called with the arguments and
+	// returns the kernel: a function `(left, top, size)` returning the color
+	// of the `size` x `size` cell whose top left pixel is (left, top).
+	char const *code;
+	size_t codeLength;
+
+	TileArgument arguments[TILE_ARGUMENTS];
+	size_t argumentCount;
+
+	// The cells are `cell` pixels square, aligned to the top left of `area`.
+	Rectangle area;
+	size_t cell;
+
+	// Colors are clamped to `[0, maximumColor]`.
+	uint16_t maximumColor;
+} TileJob;
+
+/// RETURNS `NULL` if there was a problem allocating the TileRenderer.
+TileRenderer *TileRenderer_allocate(void);
+
+/// Stops the worker threads.
+void TileRenderer_deallocate(TileRenderer *renderer);
+
+/// Evaluates the job's kernel over every cell of its area, blocking until every
+/// tile is done. `done` is called on the calling thread with each completed
+/// tile, whose rows of colors are `stride` apart; `idle` is called after a
+/// batch of tiles, before waiting for more.
+/// RETURNS `NULL`, or a description of the first error raised by the kernel
+/// (valid until the next render), after which no more tiles are started.
+char const *TileRenderer_render(TileRenderer *renderer, TileJob const *job, void *context, void (*done)(void *context, Rectangle tile, uint16_t const *colors, size_t stride), void (*idle)(void *context));
+
+#endif
@@ -0,0 +1,265 @@
+#include "touch.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <linux/input.h>
+#include <sys/ioctl.h>
+
+#include "profile.h"
+
+/// RETURNS the largest value of the axis `code`, or `fallback` if the device
+/// doesn't report it.
+static int32_t TouchInput_axisMaximum(TouchInput const *input, unsigned code, int32_t fallback)
+{
+	struct input_absinfo info;
+	if (input->fileDescriptor < 0 || ioctl(input->fileDescriptor, EVIOCGABS(code), &info) != 0 || info.maximum <= 0)
+	{
+		return fallback;
+	}
+	return info.maximum;
+}
+
+static void TouchInput_clearSlots(TouchInput *input)
+{
+	for (int i = 0; i < TOUCH_SLOTS; i++)
+	{
+		input->slots[i] = (TouchContact){-1, 0, 0, 0, 0, 0};
+	}
+}
+
+void TouchInput_init(TouchInput *input, char const *device)
+{
+	input->fileDescriptor = device != NULL ? open(device, O_RDONLY | O_NONBLOCK | O_CLOEXEC) : -1;
+
+	// Timestamp events with the clock used for `Clock_monotonic`, like the pen,
+	// so that frames can be compared with pen samples and the event loop.
+	int clock = CLOCK_MONOTONIC;
+	if (input->fileDescriptor >= 0)
+	{
+		ioctl(input->fileDescriptor, EVIOCSCLOCKID, &clock);
+	}
+
+	// The ranges of the reMarkable 2's touchscreen.
+	input->xMaximum = TouchInput_axisMaximum(input, ABS_MT_POSITION_X, 1403);
+	input->yMaximum = TouchInput_axisMaximum(input, ABS_MT_POSITION_Y, 1871);
+	input->pressureMaximum = TouchInput_axisMaximum(input, ABS_MT_PRESSURE, 255);
+
+	TouchInput_clearSlots(input);
+	input->slot = 0;
+	input->changed = 0;
+	input->dropped = 0;
+	input->frameCount = 0;
+	input->frameTaken = 0;
+}
+
+void TouchInput_free(TouchInput *input)
+{
+	if (input->fileDescriptor >= 0)
+	{
+		close(input->fileDescriptor);
+	}
+	input->fileDescriptor = -1;
+}
+
+/// Reads the value of `code` for every slot back from the device.
+/// RETURNS nonzero if the device couldn't report them.
+static int TouchInput_readSlots(TouchInput *input, unsigned code, size_t field)
+{
+	struct
+	{
+		uint32_t code;
+		int32_t values[TOUCH_SLOTS];
+	} request;
+	request.code = code;
+
+	// The device only fills in the slots it has.
+	for (int i = 0; i < TOUCH_SLOTS; i++)
+	{
+		memcpy(&request.values[i], (char const *)&input->slots[i] + field, sizeof(int32_t));
+	}
+	if (ioctl(input->fileDescriptor, EVIOCGMTSLOTS(sizeof(request)), &request) != 0)
+	{
+		return 1;
+	}
+	for (int i = 0; i < TOUCH_SLOTS; i++)
+	{
+		memcpy((char *)&input->slots[i] + field, &request.values[i], sizeof(int32_t));
+	}
+	return 0;
+}
+
+/// Replaces the slots with the device's current state, after events were
+/// dropped.
+static void TouchInput_resync(TouchInput *input)
+{
+	int failed = TouchInput_readSlots(input, ABS_MT_TRACKING_ID, offsetof(TouchContact, id));
+	failed |= TouchInput_readSlots(input, ABS_MT_POSITION_X, offsetof(TouchContact, x));
+	failed |= TouchInput_readSlots(input, ABS_MT_POSITION_Y, offsetof(TouchContact, y));
+	failed |= TouchInput_readSlots(input, ABS_MT_PRESSURE, offsetof(TouchContact, pressure));
+	failed |= TouchInput_readSlots(input, ABS_MT_TOUCH_MAJOR, offsetof(TouchContact, major));
+	failed |= TouchInput_readSlots(input, ABS_MT_TOUCH_MINOR, offsetof(TouchContact, minor));
+	if (failed)
+	{
+		// Start again from no contacts, which is right once every finger lifts.
+		TouchInput_clearSlots(input);
+	}
+	input->changed = 1;
+}
+
+/// Appends the contacts to the ring of frames.
+static void TouchInput_record(TouchInput *input, struct input_event const *event)
+{
+	TouchFrame *frame = &input->frames[input->frameCount % TOUCH_FRAME_CAPACITY];
+	frame->seconds = event->time.tv_sec + 1.0e-6 * event->time.tv_usec;
+	frame->count = 0;
+	for (int i = 0; i < TOUCH_SLOTS; i++)
+	{
+		if (input->slots[i].id >= 0)
+		{
+			frame->contacts[frame->count++] = input->slots[i];
+		}
+	}
+	input->frameCount += 1;
+}
+
+/// RETURNS whether the event ended a frame which was recorded.
+static int TouchInput_processEvent(TouchInput *input, struct input_event const *event)
+{
+	if (event->type == EV_SYN)
+	{
+		if (event->code == SYN_DROPPED)
+		{
+			input->dropped = 1;
+		}
+		else if (event->code == SYN_REPORT)
+		{
+			if (input->dropped)
+			{
+				input->dropped = 0;
+				TouchInput_resync(input);
+			}
+			if (input->changed)
+			{
+				input->changed = 0;
+				TouchInput_record(input, event);
+				return 1;
+			}
+		}
+		return 0;
+	}
+	if (event->type != EV_ABS || input->dropped)
+	{
+		return 0;
+	}
+
+	if (event->code == ABS_MT_SLOT)
+	{
+		input->slot = event->value;
+		return 0;
+	}
+
+	// Ignore contacts in slots beyond those tracked.
+	if (input->slot < 0 || input->slot >= TOUCH_SLOTS)
+	{
+		return 0;
+	}
+	TouchContact *contact = &input->slots[input->slot];
+	if (event->code == ABS_MT_TRACKING_ID)
+	{
+		contact->id = event->value;
+	}
+	else if (event->code == ABS_MT_POSITION_X)
+	{
+		contact->x = event->value;
+	}
+	else if (event->code == ABS_MT_POSITION_Y)
+	{
+		contact->y = event->value;
+	}
+	else if (event->code == ABS_MT_PRESSURE)
+	{
+		contact->pressure = event->value;
+	}
+	else if (event->code == ABS_MT_TOUCH_MAJOR)
+	{
+		contact->major = event->value;
+	}
+	else if (event->code == ABS_MT_TOUCH_MINOR)
+	{
+		contact->minor = event->value;
+	}
+	else
+	{
+		return 0;
+	}
+	input->changed = 1;
+	return 0;
+}
+
+int TouchInput_read(TouchInput *input)
+{
+	if (input->fileDescriptor < 0)
+	{
+		return 0;
+	}
+	uint64_t began = Profile_begin();
+
+	// Read as many events as are available, in batches of up to a page.
+	struct input_event events[4096 / sizeof(struct input_event)];
+	int frames = 0;
+	while (1)
+	{
+		ssize_t r = read(input->fileDescriptor, events, sizeof(events));
+		if (r < 0)
+		{
+			if (errno == EINTR)
+			{
+				continue;
+			}
+			else if (errno != EAGAIN)
+			{
+				fprintf(stderr, "TouchInput_read: unexpected error %d from read.\n", errno);
+			}
+			break;
+		}
+
+		size_t count = (size_t)r / sizeof(struct input_event);
+		for (size_t i = 0; i < count; i++)
+		{
+			frames += TouchInput_processEvent(input, &events[i]);
+		}
+
+		if ((size_t)r < sizeof(events))
+		{
+			break;
+		}
+	}
+	Profile_end("TouchInput_read", began);
+	return frames;
+}
+
+size_t TouchInput_takeFrames(TouchInput *input, TouchFrame *out, size_t capacity)
+{
+	uint32_t waiting = input->frameCount - input->frameTaken;
+	if (waiting > TOUCH_FRAME_CAPACITY)
+	{
+		waiting = TOUCH_FRAME_CAPACITY;
+	}
+	if (waiting > capacity)
+	{
+		waiting = (uint32_t)capacity;
+	}
+
+	uint32_t first = input->frameCount - waiting;
+	for (uint32_t i = 0; i < waiting; i++)
+	{
+		out[i] = input->frames[(first + i) % TOUCH_FRAME_CAPACITY];
+	}
+	input->frameTaken = input->frameCount;
+	return waiting;
+}
@@ -0,0 +1,88 @@
+#ifndef _CF_TOUCH
+#define _CF_TOUCH
+
+#include "stddef.h"
+#include "stdint.h"
+
+// A TouchInput decodes the touchscreen (the reMarkable 2's `cyttsp5_mt`, on
+// /dev/input/event2), which reports each finger in a slot using the Linux
+// multitouch protocol (type B): ABS_MT_SLOT selects a slot, whose contact's
+// ABS_MT_TRACKING_ID, ABS_MT_POSITION_X/Y and ABS_MT_PRESSURE follow, and
+// SYN_REPORT ends a frame. A tracking ID of -1 lifts the slot's contact.
+//
+// Each frame in which a contact changed is recorded with the state of every
+// contact, so frames can be read in batches.
+
+// The most contacts tracked at once; the touchscreen has 32 slots.
+#define TOUCH_SLOTS 32
+
+// The number of recent frames a TouchInput retains. The touchscreen reports
+// about 100 frames per second while touched.
+#define TOUCH_FRAME_CAPACITY 64
+
+typedef struct
+{
+	// The kernel's tracking ID, which stays the same from when the finger
+	// touches down until it lifts.
+	int32_t id;
+
+	int32_t x;
+	int32_t y;
+	int32_t pressure;
+	int32_t major;
+	int32_t minor;
+} TouchContact;
+
+// Every contact at one sync packet.
+typedef struct
+{
+	// The kernel's timestamp of the sync, in seconds on the monotonic clock.
+	double seconds;
+
+	size_t count;
+	TouchContact contacts[TOUCH_SLOTS];
+} TouchFrame;
+
+typedef struct
+{
+	int fileDescriptor;
+
+	// The largest values of the axes, as reported by the device.
+	int32_t xMaximum;
+	int32_t yMaximum;
+	int32_t pressureMaximum;
+
+	// The contact in each slot, whose ID is -1 when the slot is empty.
+	TouchContact slots[TOUCH_SLOTS];
+	int slot;
+
+	// Whether a slot has changed since the previous frame.
+	int changed;
+
+	// Events are ignored after SYN_DROPPED until the next SYN_REPORT, when the
+	// slots are read back from the device.
+	int dropped;
+
+	// A ring of the most recent frames, like `PenInput.history`.
+	TouchFrame frames[TOUCH_FRAME_CAPACITY];
+	uint32_t frameCount;
+	uint32_t frameTaken;
+} TouchInput;
+
+/// Opens the touchscreen at `device`. When `device` is `NULL` or can't be
+/// opened, `fileDescriptor` is -1 and there are never any frames.
+void TouchInput_init(TouchInput *input, char const *device);
+
+/// Closes the device.
+void TouchInput_free(TouchInput *input);
+
+/// Processes all of the data available from the device without waiting.
+/// RETURNS the number of frames recorded.
+int TouchInput_read(TouchInput *input);
+
+/// Copies the frames recorded since the previous call, oldest first, into
+/// `out`, discarding the oldest when more than `capacity` are waiting.
+/// RETURNS the number of frames copied.
+size_t TouchInput_takeFrames(TouchInput *input, TouchFrame *out, size_t capacity);
+
+#endif
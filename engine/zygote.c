@@ -0,0 +1,475 @@
+#define _GNU_SOURCE
+
+#include "zygote.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <sys/prctl.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// A launch's standard input, output and error, which are passed to the app.
+#define STREAMS 3
+
+// How often an app's watcher checks whether the client is stopped, in
+// nanoseconds.
+#define WATCH_INTERVAL 20000000
+
+typedef struct
+{
+	// The client's working directory and the script, each terminated by '\0'.
+	char text[2 * PATH_MAX];
+	size_t length;
+
+	int streams[STREAMS];
+	int streamCount;
+} Launch;
+
+/// Fills `address` with the path of a unix socket.
+/// RETURNS nonzero if the path is too long.
+static int Zygote_address(char const *path, struct sockaddr_un *address)
+{
+	memset(address, 0, sizeof(*address));
+	address->sun_family = AF_UNIX;
+	if (strlen(path) >= sizeof(address->sun_path))
+	{
+		fprintf(stderr, "Zygote: the socket path `%s` is too long.\n", path);
+		return 1;
+	}
+	strcpy(address->sun_path, path);
+	return 0;
+}
+
+/// Writes all of `length` bytes, retrying after signals.
+/// RETURNS nonzero if the connection failed.
+static int Zygote_send(int connection, void const *data, size_t length)
+{
+	char const *bytes = data;
+	while (length > 0)
+	{
+		ssize_t sent = send(connection, bytes, length, MSG_NOSIGNAL);
+		if (sent < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (sent <= 0)
+		{
+			return 1;
+		}
+		bytes += sent;
+		length -= (size_t)sent;
+	}
+	return 0;
+}
+
+/// Reads all of `length` bytes, retrying after signals.
+/// RETURNS nonzero if the connection failed or was closed first.
+static int Zygote_receive(int connection, void *data, size_t length)
+{
+	char *bytes = data;
+	while (length > 0)
+	{
+		ssize_t received = recv(connection, bytes, length, 0);
+		if (received < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (received <= 0)
+		{
+			return 1;
+		}
+		bytes += received;
+		length -= (size_t)received;
+	}
+	return 0;
+}
+
+static void Zygote_closeStreams(Launch *launch)
+{
+	for (int i = 0; i < launch->streamCount; i++)
+	{
+		close(launch->streams[i]);
+	}
+	launch->streamCount = 0;
+}
+
+/// Reads a launch: text (with the streams attached to its first byte) up to the
+/// second '\0'.
+/// RETURNS nonzero, having closed any streams received, if the launch was
+/// malformed or the client was too slow.
+static int Zygote_receiveLaunch(int connection, Launch *launch)
+{
+	launch->length = 0;
+	launch->streamCount = 0;
+
+	int terminators = 0;
+	while (terminators < 2)
+	{
+		if (launch->length == sizeof(launch->text))
+		{
+			Zygote_closeStreams(launch);
+			return 1;
+		}
+
+		struct iovec iov = {launch->text + launch->length, sizeof(launch->text) - launch->length};
+		union
+		{
+			char buffer[CMSG_SPACE(STREAMS * sizeof(int))];
+			struct cmsghdr align;
+		} control;
+		struct msghdr message = {0};
+		message.msg_iov = &iov;
+		message.msg_iovlen = 1;
+		message.msg_control = control.buffer;
+		message.msg_controllen = sizeof(control.buffer);
+
+		ssize_t received = recvmsg(connection, &message, MSG_CMSG_CLOEXEC);
+		if (received < 0 && errno == EINTR)
+		{
+			continue;
+		}
+		if (received <= 0)
+		{
+			Zygote_closeStreams(launch);
+			return 1;
+		}
+
+		for (struct cmsghdr *header = CMSG_FIRSTHDR(&message); header != NULL; header = CMSG_NXTHDR(&message, header))
+		{
+			if (header->cmsg_level == SOL_SOCKET && header->cmsg_type == SCM_RIGHTS)
+			{
+				int count = (int)((header->cmsg_len - CMSG_LEN(0)) / sizeof(int));
+				int *streams = (int *)CMSG_DATA(header);
+				for (int i = 0; i < count; i++)
+				{
+					if (launch->streamCount < STREAMS)
+					{
+						launch->streams[launch->streamCount++] = streams[i];
+					}
+					else
+					{
+						close(streams[i]);
+					}
+				}
+			}
+		}
+
+		for (ssize_t i = 0; i < received; i++)
+		{
+			terminators += launch->text[launch->length + i] == '\0';
+		}
+		launch->length += (size_t)received;
+	}
+
+	if (launch->streamCount != STREAMS)
+	{
+		Zygote_closeStreams(launch);
+		return 1;
+	}
+	return 0;
+}
+
+/// RETURNS whether the process `pid` is stopped, or -1 if it no longer exists.
+static int Zygote_isStopped(pid_t pid)
+{
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%d/stat", (int)pid);
+	FILE *file = fopen(path, "r");
+	if (file == NULL)
+	{
+		return -1;
+	}
+	char stat[512];
+	size_t length = fread(stat, 1, sizeof(stat) - 1, file);
+	fclose(file);
+	stat[length] = '\0';
+
+	// The state follows the command name, which is in parentheses and may
+	// itself contain them.
+	char const *end = strrchr(stat, ')');
+	if (end == NULL || end[1] != ' ')
+	{
+		return -1;
+	}
+	return end[2] == 'T';
+}
+
+/// Stops and continues the app, which is this process's parent, whenever the
+/// client is stopped and continued, since launchers suspend apps with SIGSTOP
+/// which the client can't forward. Exits along with the app or the client.
+static void Zygote_watch(pid_t client, pid_t app)
+{
+	prctl(PR_SET_PDEATHSIG, SIGKILL);
+	if (getppid() != app)
+	{
+		_exit(0);
+	}
+
+	int stopped = 0;
+	struct timespec interval = {0, WATCH_INTERVAL};
+	for (;;)
+	{
+		int clientStopped = Zygote_isStopped(client);
+		if (clientStopped < 0)
+		{
+			_exit(0);
+		}
+		if (clientStopped != stopped)
+		{
+			kill(app, clientStopped ? SIGSTOP : SIGCONT);
+			stopped = clientStopped;
+		}
+		nanosleep(&interval, NULL);
+	}
+}
+
+/// Runs a launch in a process forked from the zygote.
+/// RETURNS the exit status of the app.
+static int Zygote_run(int connection, Launch *launch, Interpreter *interpreter, PenInput *penInput, char const *penDevice, TouchInput *touchInput, char const *touchDevice)
+{
+	signal(SIGCHLD, SIG_DFL);
+
+	for (int i = 0; i < STREAMS; i++)
+	{
+		dup2(launch->streams[i], i);
+	}
+	Zygote_closeStreams(launch);
+
+	char const *directory = launch->text;
+	char const *script = directory + strlen(directory) + 1;
+	if (chdir(directory) != 0)
+	{
+		fprintf(stderr, "Zygote: could not change to the directory `%s`.\n", directory);
+		return 1;
+	}
+
+	// Nothing more is sent by the client, so the connection only becomes
+	// readable when it closes, and SIGIO's default action ends the app.
+	fcntl(connection, F_SETOWN, getpid());
+	fcntl(connection, F_SETFL, fcntl(connection, F_GETFL) | O_ASYNC);
+
+	struct ucred client;
+	socklen_t clientLength = sizeof(client);
+	if (getsockopt(connection, SOL_SOCKET, SO_PEERCRED, &client, &clientLength) != 0)
+	{
+		fprintf(stderr, "Zygote: could not identify the client.\n");
+		return 1;
+	}
+	pid_t app = getpid();
+	pid_t watcher = fork();
+	if (watcher == 0)
+	{
+		close(connection);
+		Zygote_watch(client.pid, app);
+	}
+	else if (watcher < 0)
+	{
+		fprintf(stderr, "Zygote: could not start watching the client.\n");
+		return 1;
+	}
+
+	// The zygote's evdev clients are shared with every other app; new ones
+	// receive every event themselves.
+	if (penDevice != NULL)
+	{
+		PenInput_free(penInput);
+		if (PenInput_init(penInput, penDevice))
+		{
+			return 1;
+		}
+	}
+	if (touchDevice != NULL)
+	{
+		TouchInput_free(touchInput);
+		TouchInput_init(touchInput, touchDevice);
+	}
+	if (Interpreter_reopen(interpreter))
+	{
+		return 1;
+	}
+
+	int32_t pid = (int32_t)getpid();
+	if (Zygote_send(connection, &pid, sizeof(pid)))
+	{
+		return 1;
+	}
+
+	int32_t status = Interpreter_run(interpreter, script) ? 1 : 0;
+	Zygote_send(connection, &status, sizeof(status));
+	return status;
+}
+
+int Zygote_serve(char const *path, Interpreter *interpreter, PenInput *penInput, char const *penDevice, TouchInput *touchInput, char const *touchDevice)
+{
+	struct sockaddr_un address;
+	if (Zygote_address(path, &address))
+	{
+		return 1;
+	}
+
+	int server = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	unlink(path);
+	if (server < 0 || bind(server, (struct sockaddr *)&address, sizeof(address)) != 0 || listen(server, 8) != 0)
+	{
+		fprintf(stderr, "Zygote_serve: could not listen on `%s`.\n", path);
+		return 1;
+	}
+
+	// Apps report their own exit status, so they need not be waited for.
+	signal(SIGCHLD, SIG_IGN);
+
+	for (;;)
+	{
+		int connection = accept4(server, NULL, NULL, SOCK_CLOEXEC);
+		if (connection < 0)
+		{
+			if (errno == EINTR || errno == ECONNABORTED)
+			{
+				continue;
+			}
+			fprintf(stderr, "Zygote_serve: unexpected error %d from accept.\n", errno);
+			close(server);
+			return 1;
+		}
+
+		// Don't let a client which never finishes its launch hold up the others.
+		struct timeval timeout = {1, 0};
+		setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+		Launch launch;
+		if (Zygote_receiveLaunch(connection, &launch))
+		{
+			close(connection);
+			continue;
+		}
+
+		// Buffered output would otherwise be written again by the app.
+		fflush(stdout);
+		fflush(stderr);
+
+		pid_t pid = fork();
+		if (pid == 0)
+		{
+			close(server);
+			timeout = (struct timeval){0, 0};
+			setsockopt(connection, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+			exit(Zygote_run(connection, &launch, interpreter, penInput, penDevice, touchInput, touchDevice));
+		}
+		if (pid < 0)
+		{
+			fprintf(stderr, "Zygote_serve: could not fork.\n");
+		}
+		Zygote_closeStreams(&launch);
+		close(connection);
+	}
+}
+
+// The app of the launch in progress, to which signals are forwarded.
+static volatile pid_t s_app = 0;
+
+static void Zygote_forward(int signal)
+{
+	int saved = errno;
+	if (s_app > 0)
+	{
+		kill(s_app, signal == SIGTSTP ? SIGSTOP : signal);
+	}
+	if (signal == SIGTSTP)
+	{
+		raise(SIGSTOP);
+	}
+	errno = saved;
+}
+
+int Zygote_launch(char const *path, char const *script)
+{
+	struct sockaddr_un address;
+	if (Zygote_address(path, &address))
+	{
+		return -1;
+	}
+
+	int connection = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (connection < 0 || connect(connection, (struct sockaddr *)&address, sizeof(address)) != 0)
+	{
+		if (connection >= 0)
+		{
+			close(connection);
+		}
+		return -1;
+	}
+
+	Launch launch;
+	if (getcwd(launch.text, PATH_MAX) == NULL || strlen(script) >= PATH_MAX)
+	{
+		fprintf(stderr, "Zygote_launch: the path of `%s` is too long.\n", script);
+		close(connection);
+		return 1;
+	}
+	size_t directoryLength = strlen(launch.text) + 1;
+	strcpy(launch.text + directoryLength, script);
+	launch.length = directoryLength + strlen(script) + 1;
+
+	int streams[STREAMS] = {0, 1, 2};
+	struct iovec iov = {launch.text, launch.length};
+	union
+	{
+		char buffer[CMSG_SPACE(sizeof(streams))];
+		struct cmsghdr align;
+	} control;
+	struct msghdr message = {0};
+	message.msg_iov = &iov;
+	message.msg_iovlen = 1;
+	message.msg_control = control.buffer;
+	message.msg_controllen = sizeof(control.buffer);
+	struct cmsghdr *header = CMSG_FIRSTHDR(&message);
+	header->cmsg_level = SOL_SOCKET;
+	header->cmsg_type = SCM_RIGHTS;
+	header->cmsg_len = CMSG_LEN(sizeof(streams));
+	memcpy(CMSG_DATA(header), streams, sizeof(streams));
+
+	// The launch is small enough to be sent whole.
+	if (sendmsg(connection, &message, MSG_NOSIGNAL) != (ssize_t)launch.length)
+	{
+		fprintf(stderr, "Zygote_launch: could not send the launch to `%s`.\n", path);
+		close(connection);
+		return 1;
+	}
+
+	int32_t pid;
+	if (Zygote_receive(connection, &pid, sizeof(pid)))
+	{
+		fprintf(stderr, "Zygote_launch: the zygote at `%s` did not start `%s`.\n", path, script);
+		close(connection);
+		return 1;
+	}
+	s_app = (pid_t)pid;
+
+	struct sigaction action = {0};
+	action.sa_handler = Zygote_forward;
+	sigemptyset(&action.sa_mask);
+	int const forwarded[] = {SIGINT, SIGTERM, SIGHUP, SIGTSTP, SIGCONT};
+	for (size_t i = 0; i < sizeof(forwarded) / sizeof(forwarded[0]); i++)
+	{
+		sigaction(forwarded[i], &action, NULL);
+	}
+
+	// The connection closes without a status if the app is killed.
+	int32_t status;
+	if (Zygote_receive(connection, &status, sizeof(status)))
+	{
+		status = 1;
+	}
+	close(connection);
+	return (int)status;
+}
@@ -0,0 +1,31 @@
+#ifndef _CF_ZYGOTE
+#define _CF_ZYGOTE
+
+#include "input.h"
+#include "touch.h"
+#include "interpreter.h"
+
+// A zygote is a resident engine which has already opened the devices, created
+// an Interpreter and preloaded the common library modules. It listens on a
+// unix socket, and forks a copy of itself to run each script it is sent, so
+// that an app starts without waiting on any of that setup.
+//
+// A launch sends the client's working directory, script and standard streams;
+// the forked app runs in that directory with those streams, and reports its
+// process ID and then its exit status back over the connection. The app exits
+// when the client's end of the connection is closed, and is stopped whenever
+// the client is.
+
+/// Serves launches on the socket at `path` until there is an error. Each app
+/// reopens `penDevice` and `touchDevice` (those which aren't `NULL`) so that it
+/// reads them independently of the zygote and of other apps.
+/// RETURNS nonzero if the socket could not be created or accepting failed.
+int Zygote_serve(char const *path, Interpreter *interpreter, PenInput *penInput, char const *penDevice, TouchInput *touchInput, char const *touchDevice);
+
+/// Asks the zygote listening at `path` to run `script`, and waits for it to
+/// exit. SIGINT, SIGTERM and SIGHUP are forwarded to the app, and SIGTSTP and
+/// SIGCONT stop and continue it along with the client.
+/// RETURNS the app's exit status, or -1 if no zygote is listening at `path`.
+int Zygote_launch(char const *path, char const *script);
+
+#endif
@@ -0,0 +1,27 @@
+-- Benchmark scenario for `engine/built/bench`: drags a point of the CAD sketch
+-- around a circle, rendering and flushing after every move the way
+-- `cad/main.lua` does for a pen drag.
+
+local SketchWidget = (require "cad/sketchwidget").SketchWidget
+
+-- The widget logs every repaint; keep that out of the timings.
+print = function() end
+
+local SCREEN_WIDTH, SCREEN_HEIGHT = rm_fb:size()
+local sketch = SketchWidget.new({
+	left = 0,
+	top = 0,
+	width = math.floor(0.75 * SCREEN_WIDTH),
+	height = math.floor(0.75 * SCREEN_HEIGHT),
+})
+sketch:render(rm_sb)
+
+local MOVES = 500
+local x, y = sketch:toScreen(sketch.objects.b.x, sketch.objects.b.y)
+sketch:touchStart(nil, x, y, "pen")
+for i = 1, MOVES do
+	local angle = 2 * math.pi * i / MOVES
+	sketch:touchDrag(nil, x + 200 * math.sin(angle), y + 200 * (1 - math.cos(angle)), "pen")
+	sketch:render(rm_sb)
+end
+sketch:touchEnd(nil, x, y, "pen")
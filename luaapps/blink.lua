@@ -8,22 +8,17 @@ local center_y = math.floor(height / 2)
 
 local radius = math.floor(math.min(width, height) / 6)
 
-function busySleep(seconds)
+function sleep(seconds)
         local start = rm_monotonic:getSeconds()
-        local elapsed
-        repeat
-                elapsed = rm_monotonic:getSeconds() - start
-        until elapsed > seconds
-        return elapsed
+        rm_events:wait(seconds)
+        return rm_monotonic:getSeconds() - start
 end
 
-busySleep(1)
+sleep(1)
 
 local STRIP = 128
 rm_fb:setRect(0, 0, width, STRIP * 2, 0)
-rm_fb:flush(0, 0, width, STRIP * 2, 1)
-
-busySleep(0.25)
+rm_fb:wait(rm_fb:flushAsync(0, 0, width, STRIP * 2, 1))
 
 for x = 0, width - 1 do
     for y = 0, STRIP - 1 do
@@ -38,9 +33,9 @@ for x = 0, width - 1 do
     end
 end
 rm_fb:flush(0, 0, width, STRIP, 1)
-print(busySleep(1.5))
+print(sleep(1.5))
 rm_fb:flush(0, STRIP, width, STRIP + STRIP, 3)
-print(busySleep(1.5))
+print(sleep(1.5))
 
 function drawCheck(b)
         local color1 = math.random(0, 2 ^ 16 - 1) -- b and 0 or 2 ^ 16 - 1
@@ -59,9 +54,9 @@ local PAUSE = 1.5
 
 for i = 1, 10 do
         drawCheck(true)
-        busySleep(PAUSE)
+        sleep(PAUSE)
         drawCheck(false)
-        busySleep(PAUSE)
+        sleep(PAUSE)
 end
 
 -- Waveform 3:
@@ -131,30 +131,27 @@ local function main()
 		penState = newState
 	end
 
-	local function busySleep(seconds)
+	local function sleep(seconds)
 		local start = rm_monotonic:getSeconds()
-		local elapsed
-		repeat
-			elapsed = rm_monotonic:getSeconds() - start
-		until elapsed > seconds
-		return elapsed
+		rm_events:wait(seconds)
+		return rm_monotonic:getSeconds() - start
 	end
 
 	local block = 32
 
-	busySleep(1)
+	sleep(1)
 
 	rm_sb:setRect(0, 0, block * 4, block * 4, 0)
 
 	rm_sb:flush(0, 0, block * 4, block * 4, 1)
 
-	busySleep(1)
+	sleep(1)
 	
 	rm_sb:setRect(0, 0, block * 4, block * 4, 31)
 
 	rm_sb:flush(0, 0, block * 4, block * 4, 1)
 
-	busySleep(1)
+	sleep(1)
 
 	for u = 0, 3 do
 		for v = 0, 3 do
@@ -168,7 +165,7 @@ local function main()
 	local stopTime = rm_monotonic:getSeconds() + 2 * 60
 	while rm_monotonic:getSeconds() < stopTime do
 		local before = rm_monotonic:getSeconds()
-		rm_pen:poll(handlePen)
+		rm_events:wait(1, handlePen)
 		local pollingTime = rm_monotonic:getSeconds() - before
 		appWidget:render(rm_sb)
 		rm_sb:flush(0, 0, 1, 1)
@@ -240,6 +240,28 @@ function SketchWidget:toScreen(wx, wy)
 	return math.floor(wx), math.floor(wy)
 end
 
+-- RETURNS the offscreen layer behind the objects, which covers the whole
+-- widget, rendering it the first time.
+function SketchWidget:background()
+	if not self.backgroundLayer then
+		local layer = rm_surface.new(self.placement.width, self.placement.height, 8)
+		layer:setRect(0, 0, self.placement.width, self.placement.height, 31)
+		self.backgroundLayer = layer
+	end
+	return self.backgroundLayer
+end
+
+-- Point markers are 1-bit masks, stamped centered on each point.
+local pointMarkers = {}
+local function pointMarker(radius)
+	if not pointMarkers[radius] then
+		local marker = rm_surface.new(2 * radius + 1, 2 * radius + 1, 1)
+		marker:fillCircle(radius, radius, radius, 1)
+		pointMarkers[radius] = marker
+	end
+	return pointMarkers[radius]
+end
+
 function SketchWidget:repaintObject(fb, rectangle, k, object)
 	if object.tag == "point" then
 		local radius = POINT_RADIUS_PX
@@ -247,13 +269,13 @@ function SketchWidget:repaintObject(fb, rectangle, k, object)
 			radius = POINT_HIGHLIGHT_RADIUS_PX
 		end
 		local sx, sy = self:toScreen(object.x, object.y)
-		fb:setRect(sx - radius, sy - radius, sx + radius, sy + radius, 0)
+		fb:stamp(pointMarker(radius), sx - radius, sy - radius, 0)
 		print("painting point", k, "at", sx, sy, "radius", radius)
 	end
 end
 
 function SketchWidget:repaint(fb, rectangle)
-	fb:setRect(rectangle.left, rectangle.top, rectangle.right, rectangle.bottom, 31)
+	fb:blit(self:background(), rectangle.left, rectangle.top, rectangle.right, rectangle.bottom, rectangle.left, rectangle.top)
 
 	-- Draw the frame.
 	-- fb:setRect(self.placement.left, self.placement.top, 1, self.placement.height, 0)
@@ -1,7 +1,6 @@
 package.path = "/home/root/luaapps/?.lua"
 
 local font = require "library/font"
-local ui = require "library/ui"
 
 setmetatable(_G, {
 	__index = function(_, var)
@@ -14,25 +13,21 @@ local width, height = rm_fb:size()
 local WHITE = 2 ^ 16 - 1
 local BLACK = 0
 
-local background = ui.Box.new({left = 0, top = 0, right = width, bottom = height}, WHITE)
-local title = ui.TextBox.new(font.CMU32, {left = 500, right = 600, top = 500, bottom = 532}, "")
-local cursor = ui.Box.new({left = 32, top = 32, right = 80, bottom = 100}, BLACK)
+-- The scene is retained by the engine, which repaints only what changes.
+local scene = rm_scene.new(width, height, WHITE)
+local title = scene:text(font.CMU32.atlas, 500, 524, "", BLACK)
+local cursor = scene:box(32, 32, 80, 100, BLACK)
 
 local lines = {}
-local scene = {background, cursor}
 for i = 1, 16 do
-	table.insert(lines, ui.Line.new(1, 1, math.random(500), math.random(500)))
-	table.insert(scene, lines[i])
+	table.insert(lines, scene:line(1, 1, math.random(500), math.random(500), BLACK))
 end
 
--- local page = ui.VisualStack.new({background, title, cursor})
-local page = ui.VisualStack.new(scene)
-
 local wasTapped = false
 
 print("Initialized.");
 while true do
-	ui.renderFrame(rm_fb, page)
+	scene:render(rm_fb, 1)
 
 	local r = width / 4
 	local cube = {}
@@ -46,22 +41,22 @@ while true do
 		end
 	end
 	for i = 1, 4 do
-		lines[i]:set(cube[i][1], cube[i][2], cube[i % 4 + 1][1], cube[i % 4 + 1][2])
+		scene:set(lines[i], cube[i][1], cube[i][2], cube[i % 4 + 1][1], cube[i % 4 + 1][2], BLACK)
 	end
 	for i = 5, 8 do
-		lines[i]:set(cube[i][1], cube[i][2], cube[i % 4 + 5][1], cube[i % 4 + 5][2])
+		scene:set(lines[i], cube[i][1], cube[i][2], cube[i % 4 + 5][1], cube[i % 4 + 5][2], BLACK)
 	end
 
 	rm_pen:poll(function(pen)
 		if pen.touching then
 			if not wasTapped then
 				wasTapped = true
-				cursor:setArea({
-					left = pen.xPos - math.random(5, 100),
-					right = pen.xPos + math.random(5, 100),
-					top = pen.yPos - math.random(5, 100),
-					bottom = pen.yPos + math.random(5, 100),
-				})
+				scene:set(cursor,
+					pen.xPos - math.random(5, 100),
+					pen.yPos - math.random(5, 100),
+					pen.xPos + math.random(5, 100),
+					pen.yPos + math.random(5, 100),
+					BLACK)
 			end
 		else
 			wasTapped = false
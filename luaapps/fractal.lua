@@ -0,0 +1,37 @@
+-- Renders the Mandelbrot set with the engine's native kernel, refining from
+-- coarse squares down to single pixels, then zooms in on the pen's taps.
+
+local width, height = rm_fb:size()
+
+local WHITE = 2 ^ 16 - 1
+local ITERATIONS = 256
+
+local centerX, centerY = -0.5, 0
+local scale = 3 / math.min(width, height)
+
+local function render()
+	local chunk = 32
+	while chunk >= 1 do
+		rm_fractal:render(rm_fb, centerX, centerY, scale, ITERATIONS, chunk)
+		chunk = chunk // 2
+	end
+end
+
+rm_fb:setRect(0, 0, width, height, WHITE)
+rm_fb:flush(0, 0, width, height, 2)
+render()
+
+-- Only run for 2 minutes.
+local stopTime = rm_monotonic:getSeconds() + 2 * 60
+local wasContacting = false
+while rm_monotonic:getSeconds() < stopTime do
+	rm_events:wait(1, function(pen)
+		if pen.contacting and not wasContacting then
+			centerX = centerX + (pen.xPos - width / 2) * scale
+			centerY = centerY + (pen.yPos - height / 2) * scale
+			scale = scale / 4
+			render()
+		end
+		wasContacting = pen.contacting
+	end)
+end
@@ -0,0 +1,45 @@
+-- A freehand drawing app: the engine rasterizes each batch of pen samples, so
+-- Lua only has to flush what changed. The stroke is drawn a little ahead of the
+-- pen by prediction, and corrected as the pen catches up.
+
+local width, height = rm_fb:size()
+
+local WHITE = 2 ^ 16 - 1
+local BLACK = 0
+
+-- The waveform for quick black-and-white updates.
+local WAVEFORM_FAST = 1
+
+rm_fb:setRect(0, 0, width, height, WHITE)
+rm_fb:flush(0, 0, width, height, 0)
+
+-- How far ahead of the pen to draw, in seconds, to make up for the time the
+-- display takes to show the ink.
+local LOOKAHEAD = 0.03
+
+-- The predicted ink, which is taken back once the real samples arrive.
+local ghost = rm_provisional.new()
+
+-- RETURNS the bounding box of two rectangles, either of which may be nil.
+local function union(left, top, right, bottom, l, t, r, b)
+	if not left then
+		return l, t, r, b
+	elseif not l then
+		return left, top, right, bottom
+	end
+	return math.min(left, l), math.min(top, t), math.max(right, r), math.max(bottom, b)
+end
+
+-- Only run for 2 minutes.
+local stopTime = rm_monotonic:getSeconds() + 2 * 60
+while rm_monotonic:getSeconds() < stopTime do
+	rm_events:wait(1, true)
+	local samples = rm_pen:samples()
+	local left, top, right, bottom = ghost:restore()
+	left, top, right, bottom = union(left, top, right, bottom, rm_fb:stroke(samples, BLACK, 1, 4, 0.5))
+	local prediction = rm_pen:predict(LOOKAHEAD)
+	left, top, right, bottom = union(left, top, right, bottom, rm_fb:stroke(prediction, BLACK, 1, 4, 0.5, ghost))
+	if left then
+		rm_fb:flushAsync(left, top, right, bottom, WAVEFORM_FAST)
+	end
+end
@@ -1,663 +1,37 @@
--- Each character is encoded as 32-bit unsigned integers.
--- Each integer represents one row in the character. 
--- The first integer represents the top row.
--- The text baseline row is indicated.
--- The least-significant-bit is the leftmost pixel in that row.
--- This raster font is derived from "CMU Serif", which is licensed under the
--- Open SIL Font license.
-local fontDataCMU16 = {
-	width = 32,
-	height = 32,
-	baseline = 17,
-	glyphs = {
-		["A"] = {
-			0, 0, 0, 0, 0, 0, 98304, 98304, 147456, 147456, 147456, 270336, 516096, 270336, 528384, 1849344, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["B"] = {
-			0, 0, 0, 0, 0, 520192, 532480, 532480, 532480, 532480, 516096, 532480, 532480, 532480, 532480, 520192, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["C"] = {
-			0, 0, 0, 0, 0, 1556480, 1581056, 1052672, 2048, 2048, 2048, 2048, 2048, 1052672, 532480, 507904, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["D"] = {
-			0, 0, 0, 0, 0, 260096, 266240, 528384, 1052672, 1052672, 1052672, 1052672, 1052672, 528384, 266240, 260096, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["E"] = {
-			0, 0, 0, 0, 0, 1044480, 532480, 8192, 8192, 139264, 253952, 139264, 8192, 8192, 532480, 1044480, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["F"] = {
-			0, 0, 0, 0, 0, 1044480, 532480, 8192, 8192, 139264, 253952, 139264, 8192, 8192, 8192, 28672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["G"] = {
-			0, 0, 0, 0, 0, 1556480, 1581056, 1052672, 2048, 2048, 2048, 3672064, 1050624, 1052672, 532480, 507904, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["H"] = {
-			0, 0, 0, 0, 0, 1863680, 532480, 532480, 532480, 532480, 1040384, 532480, 532480, 532480, 532480, 1863680, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["I"] = {
-			0, 0, 0, 0, 0, 114688, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["J"] = {
-			0, 0, 0, 0, 0, 458752, 131072, 131072, 131072, 131072, 131072, 131072, 143360, 139264, 139264, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["K"] = {
-			0, 0, 0, 0, 0, 1849344, 528384, 266240, 135168, 69632, 53248, 77824, 135168, 266240, 528384, 1849344, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["L"] = {
-			0, 0, 0, 0, 0, 28672, 8192, 8192, 8192, 8192, 8192, 8192, 8192, 8192, 532480, 1044480, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["M"] = {
-			0, 0, 0, 0, 0, 6294528, 3151872, 3151872, 2631680, 2631680, 2377728, 2377728, 2263040, 2263040, 2164736, 7347200, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["N"] = {
-			0, 0, 0, 0, 0, 931840, 274432, 282624, 282624, 299008, 299008, 331776, 331776, 397312, 266240, 276480, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["O"] = {
-			0, 0, 0, 0, 0, 245760, 270336, 528384, 1050624, 1050624, 1050624, 1050624, 1050624, 528384, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["P"] = {
-			0, 0, 0, 0, 0, 520192, 532480, 532480, 532480, 532480, 516096, 8192, 8192, 8192, 8192, 28672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["Q"] = {
-			0, 0, 0, 0, 0, 245760, 270336, 528384, 1050624, 1050624, 1050624, 1050624, 1050624, 626688, 401408, 245760, 2359296, 2359296, 1572864, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["R"] = {
-			0, 0, 0, 0, 0, 260096, 266240, 266240, 266240, 266240, 258048, 266240, 266240, 266240, 2363392, 1587200, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["S"] = {
-			0, 0, 0, 0, 0, 376832, 401408, 266240, 4096, 8192, 245760, 262144, 524288, 528384, 274432, 249856, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["T"] = {
-			0, 0, 0, 0, 0, 2093056, 1118208, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["U"] = {
-			0, 0, 0, 0, 0, 1849344, 528384, 528384, 528384, 528384, 528384, 528384, 528384, 528384, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["V"] = {
-			0, 0, 0, 0, 0, 3684352, 1052672, 1052672, 532480, 532480, 278528, 278528, 163840, 163840, 65536, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["W"] = {
-			0, 0, 0, 0, 0, 29478400, 8422400, 8422400, 4261888, 4261888, 2232320, 2297856, 1351680, 1351680, 540672, 540672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["X"] = {
-			0, 0, 0, 0, 0, 931840, 266240, 139264, 81920, 81920, 32768, 81920, 81920, 139264, 266240, 931840, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["Y"] = {
-			0, 0, 0, 0, 0, 1863680, 532480, 278528, 278528, 163840, 163840, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["Z"] = {
-			0, 0, 0, 0, 0, 1040384, 532480, 262144, 262144, 131072, 65536, 32768, 16384, 16384, 532480, 1040384, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["a"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 114688, 139264, 229376, 147456, 139264, 139264, 376832, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["b"] = {
-			0, 0, 0, 0, 0, 12288, 8192, 8192, 8192, 237568, 286720, 532480, 532480, 532480, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["c"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 229376, 278528, 8192, 8192, 8192, 278528, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["d"] = {
-			0, 0, 0, 0, 0, 393216, 262144, 262144, 262144, 376832, 401408, 266240, 266240, 266240, 270336, 770048, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["e"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 229376, 278528, 516096, 8192, 8192, 278528, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["f"] = {
-			0, 0, 0, 0, 0, 458752, 294912, 32768, 32768, 114688, 32768, 32768, 32768, 32768, 32768, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["g"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 393216, 114688, 139264, 139264, 139264, 114688, 8192, 245760, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["h"] = {
-			0, 0, 0, 0, 0, 12288, 8192, 8192, 8192, 237568, 286720, 270336, 270336, 270336, 270336, 946176, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["i"] = {
-			0, 0, 0, 0, 0, 0, 65536, 0, 0, 98304, 65536, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["j"] = {
-			0, 0, 0, 0, 0, 0, 65536, 0, 0, 98304, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 73728, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["k"] = {
-			0, 0, 0, 0, 0, 12288, 8192, 8192, 8192, 401408, 73728, 57344, 73728, 139264, 270336, 946176, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["l"] = {
-			0, 0, 0, 0, 0, 98304, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["m"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 977920, 1120256, 1116160, 1116160, 1116160, 1116160, 3906560, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["n"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 241664, 286720, 270336, 270336, 270336, 270336, 946176, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["o"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 229376, 278528, 532480, 532480, 532480, 278528, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["p"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 241664, 286720, 532480, 532480, 532480, 286720, 237568, 8192, 8192, 28672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["q"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 901120, 401408, 266240, 266240, 266240, 401408, 376832, 262144, 262144, 917504, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["r"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 221184, 294912, 32768, 32768, 32768, 32768, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["s"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 245760, 139264, 8192, 114688, 131072, 139264, 122880, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["t"] = {
-			0, 0, 0, 0, 0, 0, 0, 32768, 32768, 114688, 32768, 32768, 32768, 32768, 294912, 196608, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["u"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 405504, 270336, 270336, 270336, 270336, 401408, 901120, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["v"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 946176, 270336, 270336, 147456, 147456, 98304, 98304, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["w"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 3913728, 1118208, 1118208, 696320, 696320, 278528, 278528, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["x"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 946176, 147456, 98304, 98304, 147456, 270336, 946176, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["y"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 974848, 278528, 278528, 163840, 163840, 65536, 65536, 65536, 32768, 28672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["z"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 516096, 270336, 131072, 65536, 32768, 278528, 516096, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["0"] = {
-			0, 0, 0, 0, 0, 245760, 270336, 270336, 270336, 270336, 270336, 270336, 270336, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["1"] = {
-			0, 0, 0, 0, 0, 65536, 114688, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["2"] = {
-			0, 0, 0, 0, 0, 114688, 139264, 266240, 266240, 262144, 131072, 65536, 32768, 16384, 270336, 520192, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["3"] = {
-			0, 0, 0, 0, 0, 114688, 139264, 270336, 262144, 131072, 98304, 131072, 262144, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["4"] = {
-			0, 0, 0, 0, 0, 131072, 196608, 163840, 147456, 147456, 139264, 135168, 520192, 131072, 131072, 458752, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["5"] = {
-			0, 0, 0, 0, 0, 516096, 8192, 8192, 8192, 122880, 131072, 262144, 262144, 266240, 139264, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["6"] = {
-			0, 0, 0, 0, 0, 229376, 278528, 8192, 8192, 237568, 286720, 270336, 270336, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["7"] = {
-			0, 0, 0, 0, 0, 0, 1040384, 270336, 131072, 131072, 65536, 65536, 65536, 65536, 65536, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["8"] = {
-			0, 0, 0, 0, 0, 245760, 270336, 270336, 270336, 147456, 98304, 147456, 270336, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["9"] = {
-			0, 0, 0, 0, 0, 245760, 270336, 270336, 270336, 270336, 401408, 376832, 262144, 262144, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["~"] = {
-			0, 0, 0, 0, 0, 581632, 462848, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["`"] = {
-			0, 0, 0, 0, 0, 0, 16384, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["!"] = {
-			0, 0, 0, 0, 0, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 0, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["@"] = {
-			0, 0, 0, 0, 516096, 528384, 1148928, 2245632, 2368512, 2368512, 2368512, 2368512, 2376704, 755712, 3149824, 1040384, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["#"] = {
-			0, 0, 0, 0, 0, 0, 1114112, 1114112, 557056, 557056, 4192256, 278528, 278528, 4192256, 139264, 139264, 69632, 69632, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["$"] = {
-			0, 0, 0, 0, 65536, 229376, 344064, 598016, 73728, 81920, 229376, 327680, 589824, 598016, 344064, 229376, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["%"] = {
-			0, 0, 0, 1077248, 559104, 559104, 296960, 159744, 131072, 65536, 32768, 1867776, 2244608, 2236416, 2236416, 1839104, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["^"] = {
-			0, 0, 0, 0, 0, 0, 98304, 147456, 270336, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["&"] = {
-			0, 0, 0, 0, 0, 57344, 69632, 69632, 69632, 1875968, 540672, 303104, 331776, 135168, 2428928, 1630208, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["*"] = {
-			0, 0, 0, 0, 32768, 299008, 172032, 114688, 172032, 299008, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["("] = {
-			0, 0, 131072, 65536, 65536, 32768, 32768, 16384, 16384, 16384, 16384, 16384, 16384, 32768, 32768, 65536, 65536, 131072, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[")"] = {
-			0, 0, 16384, 32768, 32768, 65536, 65536, 131072, 131072, 131072, 131072, 131072, 131072, 65536, 65536, 32768, 32768, 16384, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["-"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["_"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2095104, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["="] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 1044480, 0, 0, 0, 1044480, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["+"] = {
-			0, 0, 0, 0, 0, 0, 65536, 65536, 65536, 65536, 2093056, 65536, 65536, 65536, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["["] = {
-			0, 0, 229376, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["]"] = {
-			0, 0, 114688, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["{"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["}"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["<"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[">"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[","] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65536, 65536, 65536, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["."] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["/"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["?"] = {
-			0, 0, 0, 0, 0, 245760, 270336, 270336, 131072, 131072, 65536, 65536, 0, 0, 0, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[":"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65536, 0, 0, 0, 0, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[";"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65536, 0, 0, 0, 0, 65536, 65536, 65536, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["\""] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["'"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[" "] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-	}
-}
-
-local fontDataCMU32 = {
-	width = 30,
-	height = 36,
-	baseline = 27,
-	glyphs = {
-		["A"] = {
-			0, 0, 0, 49152, 122880, 122880, 122880, 258048, 258048, 233472, 497664, 497664, 460800, 986112, 986112, 918528, 1967616, 1967616, 2096640, 3932928, 3932928, 3670272, 7864704, 7864704, 7865280, 66979824, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["B"] = {
-			0, 0, 0, 0, 1048544, 3933952, 7866112, 7341824, 15730432, 15730432, 7341824, 7341824, 3671808, 1836800, 1048320, 3671808, 7341824, 14681856, 14681856, 31459072, 31459072, 14681856, 14681856, 7341824, 3933952, 2097120, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["C"] = {
-			0, 0, 0, 17293312, 26769408, 31464960, 29363968, 29361920, 25166720, 25166784, 25166272, 16777696, 480, 480, 480, 480, 480, 480, 480, 16777664, 16778176, 25166720, 8390528, 12586752, 6299136, 3700736, 1040384, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["D"] = {
-			0, 0, 0, 0, 524272, 1966976, 3670912, 7340928, 14680960, 14680960, 31458176, 29361024, 29361024, 62915456, 62915456, 62915456, 62915456, 62915456, 29361024, 31458176, 31458176, 14680960, 7340928, 3670912, 1966976, 524272, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["E"] = {
-			0, 0, 0, 0, 8388576, 15732480, 12584704, 12584704, 8390400, 8390400, 8390400, 263936, 395008, 395008, 524032, 395008, 395008, 17041152, 16779008, 16779008, 25167616, 25167616, 8390400, 12584704, 15732480, 16777184, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["F"] = {
-			0, 0, 0, 0, 16777152, 15732224, 12586496, 8392192, 8392192, 8392192, 8392192, 265728, 265728, 396800, 523776, 396800, 265728, 265728, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 65472, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["G"] = {
-			0, 0, 0, 8908800, 13384704, 15732480, 14680960, 14681024, 12583360, 12583392, 12583136, 8388848, 240, 240, 240, 240, 240, 66978032, 15728864, 14680544, 14680544, 14680512, 14680960, 15730560, 15732480, 14433280, 520192, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["H"] = {
-			0, 0, 0, 0, 67059696, 7866240, 7340928, 7340928, 7340928, 7340928, 7340928, 7340928, 7340928, 7340928, 8388480, 7340928, 7340928, 7340928, 7340928, 7340928, 7340928, 7340928, 7340928, 7340928, 7866240, 67059696, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["I"] = {
-			0, 0, 0, 0, 1047552, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 1047552, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["J"] = {
-			0, 0, 0, 0, 4190208, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 983040, 984832, 986880, 462592, 493312, 247296, 64512, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["K"] = {
-			0, 0, 0, 0, 66592752, 15729536, 3146624, 1573760, 787328, 394112, 197504, 99200, 50048, 58240, 127872, 252800, 231296, 459648, 983936, 918400, 1835904, 3933056, 3670912, 7340928, 16253824, 66854896, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["L"] = {
-			0, 0, 0, 0, 131008, 7680, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 8392192, 12586496, 12586496, 4197888, 6295040, 6295040, 7872000, 8388544, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["M"] = {
-			0, 0, 0, 0, 532676860, 62915056, 65012192, 60817888, 59769760, 59769760, 59770656, 59246368, 59246368, 59510304, 58986016, 58989600, 58858528, 58858528, 58865696, 58800160, 58798112, 58781728, 58781728, 58777632, 62939248, 536371708, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["N"] = {
-			0, 0, 0, 0, 66848752, 14681984, 6295424, 4202368, 4201856, 4210048, 4225408, 4223360, 4256128, 4317568, 4440448, 4424064, 4686208, 5177728, 5112192, 6160768, 8126848, 7864704, 7864704, 7340416, 6292416, 6295536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["O"] = {
-			0, 0, 0, 520192, 1973248, 3671808, 7340800, 14680960, 14680512, 29360576, 29360352, 29360352, 62914784, 62914800, 62914800, 62914800, 62914800, 62914784, 62914784, 29360352, 31457728, 14680512, 14680960, 7340928, 3671808, 1973248, 520192, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["P"] = {
-			0, 0, 0, 0, 1048544, 3936000, 7341568, 15730176, 14681600, 14681600, 14681600, 14681600, 15730176, 7341568, 3933696, 1048064, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 3840, 32736, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["Q"] = {
-			0, 0, 0, 520192, 1973248, 3671808, 7340928, 14680960, 14680512, 29360608, 29360352, 29360352, 62914784, 62914800, 62914800, 62914800, 62914800, 62914784, 29360352, 29360352, 29360576, 14795200, 6497152, 7475968, 3938048, 932864, 34598912, 34340864, 52166656, 33030144, 33030144, 15728640, 0, 0, 0, 0
-		},
-		["R"] = {
-			0, 0, 0, 0, 524272, 1968000, 3933952, 7866112, 7866112, 7866112, 7866112, 7866112, 3933952, 919296, 261888, 460544, 919296, 1836800, 1836800, 3933952, 3933952, 3933952, 3933952, 71042816, 74975104, 108543984, 65011712, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["S"] = {
-			0, 0, 0, 1177600, 1182720, 1836544, 1573376, 1049344, 1049344, 1049344, 1792, 1792, 7680, 130560, 523264, 1044480, 2064384, 3932160, 3670016, 3145728, 3145984, 3145984, 3145984, 1573632, 1574656, 793344, 520448, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["T"] = {
-			0, 0, 0, 0, 33554400, 29483232, 25288800, 16900128, 16900128, 50454560, 50454576, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 2096640, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["U"] = {
-			0, 0, 0, 0, 66863088, 15730560, 6292352, 6292352, 6292352, 6292352, 6292352, 6292352, 6292352, 6292352, 6292352, 6292352, 6292352, 6292352, 6292352, 6292352, 6293376, 6293248, 2098944, 3149312, 1576448, 932864, 258048, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["V"] = {
-			0, 0, 0, 0, 133697528, 31458240, 12583808, 6292352, 6293376, 2098944, 3149568, 3149568, 1052160, 1580544, 531456, 793600, 801792, 276480, 423936, 161792, 225280, 258048, 122880, 122880, 122880, 49152, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["W"] = {
-			0, 0, 0, 1073741824, 1058011391, 469884990, 134332444, 134332444, 67338296, 67354680, 67354680, 34029680, 34021488, 34021488, 51257568, 17699040, 17699040, 27136448, 10226112, 10226112, 12323712, 7866240, 7866240, 7866112, 3146496, 3146496, 3146240, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["X"] = {
-			0, 0, 0, 0, 33431536, 8130432, 1574656, 528128, 794112, 400384, 211968, 227328, 126976, 61440, 122880, 122880, 258048, 503808, 464896, 986112, 1967104, 1836544, 3932928, 7865088, 16253888, 134090736, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["Y"] = {
-			0, 0, 0, 0, 133173240, 31459264, 6293376, 6293376, 3149568, 1052160, 1580544, 801792, 801792, 423936, 159744, 258048, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 122880, 1047552, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["Z"] = {
-			0, 0, 0, 0, 8388352, 7868160, 3670912, 3932544, 1966464, 917888, 983424, 491520, 229376, 245760, 114688, 122880, 61440, 28672, 4225024, 4209664, 4201472, 4201984, 6295040, 6295296, 7866240, 8388480, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["a"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 129024, 494592, 396800, 925184, 921088, 917504, 1040384, 948224, 924672, 921088, 5113600, 5113600, 5113600, 7179776, 3996672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["b"] = {
-			0, 0, 0, 3584, 3968, 3584, 3584, 3584, 3584, 3584, 3584, 3584, 519680, 933376, 1576448, 3673600, 3149312, 7343616, 7343616, 7343616, 7343616, 3149312, 3673600, 1576448, 931328, 517632, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["c"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 516096, 815104, 1841152, 1842176, 1838592, 3584, 3584, 3584, 3584, 3584, 3584, 1055744, 1054720, 815104, 516096, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["d"] = {
-			0, 0, 0, 1835008, 2031616, 1835008, 1835008, 1835008, 1835008, 1835008, 1835008, 1835008, 1961984, 2038784, 1836544, 1836800, 1835776, 1835904, 1835904, 1835904, 1835904, 1835776, 1836800, 1967616, 2038784, 8255488, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["e"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 253952, 931840, 793600, 1838080, 1576448, 1576448, 2096640, 3584, 3584, 3584, 3584, 1051648, 1580032, 800768, 516096, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["f"] = {
-			0, 0, 0, 983040, 1671168, 3719168, 1622016, 49152, 49152, 49152, 49152, 49152, 1046528, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 57344, 522240, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["g"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3670016, 8255488, 236544, 462336, 396800, 921088, 396800, 462336, 236544, 128000, 1536, 1536, 1536, 1047552, 1836544, 3146496, 3146496, 3146496, 3671808, 1973760, 522240, 0, 0, 0, 0
-		},
-		["h"] = {
-			0, 0, 0, 3968, 3584, 3072, 3072, 3072, 3072, 3072, 3072, 3072, 510976, 814080, 1842176, 1842176, 1575936, 1575936, 1575936, 1575936, 1575936, 1575936, 1575936, 1575936, 1838592, 8339328, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["i"] = {
-			0, 0, 0, 0, 0, 57344, 57344, 57344, 0, 0, 0, 0, 61440, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 114688, 520192, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["j"] = {
-			0, 0, 0, 0, 114688, 122880, 114688, 0, 0, 0, 0, 0, 126976, 114688, 98304, 98304, 98304, 98304, 98304, 98304, 98304, 98304, 98304, 98304, 98304, 98304, 98304, 98304, 118272, 52736, 58880, 31744, 0, 0, 0, 0
-		},
-		["k"] = {
-			0, 0, 0, 3584, 3968, 3072, 3072, 3072, 3072, 3072, 3072, 3072, 4131840, 1969152, 396288, 199680, 101376, 52224, 130048, 105472, 232448, 461824, 396288, 920576, 1838080, 8290176, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["l"] = {
-			0, 0, 0, 61440, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 114688, 520192, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["m"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16547448, 29811680, 25412064, 25280736, 25280736, 25215072, 25215072, 25215072, 25215072, 25215072, 25215072, 25215072, 58835168, 267908088, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["n"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 511872, 818688, 1842176, 1842176, 1575936, 1575936, 1575936, 1575936, 1575936, 1575936, 1575936, 1575936, 1838592, 8339328, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["o"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 258048, 400384, 789504, 1836544, 3671808, 3671808, 3671808, 3671808, 3671808, 3671808, 3671808, 1836544, 1838592, 990208, 258048, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["p"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 520064, 933376, 1576448, 3673600, 7343616, 7343616, 7343616, 7343616, 7343616, 3149312, 3673600, 1842688, 933376, 519680, 3584, 3584, 3584, 3584, 3584, 16256, 0, 0, 0, 0
-		},
-		["q"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1175552, 1186816, 1838592, 1836544, 1574656, 1574656, 1574656, 1574656, 1574656, 1574656, 1836544, 1838592, 2038784, 1699840, 1572864, 1572864, 1572864, 1572864, 1835008, 16711680, 0, 0, 0, 0
-		},
-		["r"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 998912, 2093056, 847872, 28672, 28672, 28672, 12288, 12288, 12288, 12288, 12288, 12288, 28672, 261632, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["s"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 389120, 399360, 265216, 263168, 3072, 15360, 260096, 520192, 983040, 786432, 787456, 525312, 789504, 400384, 254976, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["t"] = {
-			0, 0, 0, 0, 0, 0, 24576, 24576, 24576, 24576, 28672, 30720, 523776, 28672, 28672, 28672, 28672, 28672, 28672, 28672, 815104, 815104, 815104, 290816, 450560, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["u"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2035584, 1838592, 1575936, 1575936, 1575936, 1575936, 1575936, 1575936, 1575936, 1838080, 1838080, 1838080, 2038784, 7993344, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["v"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8142720, 3673600, 1575936, 531456, 530432, 268288, 276480, 143360, 159744, 155648, 122880, 122880, 49152, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["w"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 66320368, 29483456, 12698048, 4309376, 4309888, 6538112, 2351872, 2303744, 3614464, 1523200, 1973760, 1973760, 789504, 789504, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["x"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8273792, 1842688, 269312, 145408, 208896, 122880, 57344, 114688, 122880, 208896, 397312, 919552, 1838592, 8265600, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["y"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 8142720, 3673600, 1575936, 531456, 792576, 276480, 274432, 143360, 159744, 221184, 122880, 114688, 49152, 49152, 49152, 16384, 24576, 9088, 13184, 3840, 0, 0, 0, 0
-		},
-		["z"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2096640, 921088, 919040, 460288, 229888, 114688, 114688, 57344, 28672, 1060864, 1062912, 1580032, 1838592, 1048064, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["0"] = {
-			0, 0, 0, 0, 0, 258048, 473088, 789504, 1838592, 1838592, 1574400, 3671808, 3671808, 3671808, 3671808, 3671808, 3671808, 3671808, 3671808, 3671808, 3671808, 1574400, 1838592, 1838592, 789504, 473088, 258048, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["1"] = {
-			0, 0, 0, 0, 0, 98304, 122880, 130048, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 114688, 122880, 2096128, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["2"] = {
-			0, 0, 0, 0, 0, 258048, 990208, 1967616, 1835520, 3936000, 3936000, 3935744, 3932160, 1835008, 1966080, 917504, 458752, 229376, 114688, 49152, 24576, 3158016, 1054720, 1051648, 2096640, 2096896, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["3"] = {
-			0, 0, 0, 0, 0, 258048, 990208, 1967104, 1838592, 1842688, 1838592, 1966080, 917504, 393216, 229376, 258048, 983040, 1966080, 1835008, 3932160, 3935744, 3936000, 3936000, 1838848, 1967616, 990208, 258048, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["4"] = {
-			0, 0, 0, 0, 262144, 393216, 458752, 458752, 491520, 507904, 475136, 483328, 471040, 462848, 464896, 461824, 459776, 460288, 459520, 459008, 4194048, 458752, 458752, 458752, 458752, 4186112, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["5"] = {
-			0, 0, 0, 0, 0, 793600, 1047552, 523264, 130048, 3072, 3072, 3072, 3072, 257024, 924672, 789504, 1835008, 1835008, 3932160, 3935744, 3936000, 1838848, 1835520, 1836544, 918528, 465920, 126976, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["6"] = {
-			0, 0, 0, 0, 0, 507904, 552960, 1849344, 1842176, 1838080, 3584, 3584, 257792, 474880, 794368, 1838848, 1838848, 3936000, 3936000, 3936000, 3935744, 3935744, 1838592, 1838080, 793600, 473088, 258048, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["7"] = {
-			0, 0, 0, 0, 0, 3072, 8387584, 4193792, 1050112, 1573376, 786944, 393216, 131072, 196608, 98304, 98304, 98304, 114688, 49152, 57344, 57344, 57344, 57344, 57344, 57344, 57344, 57344, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["8"] = {
-			0, 0, 0, 0, 0, 258048, 923648, 789504, 1574400, 1574400, 1576448, 1580544, 801792, 457728, 260096, 520192, 1038336, 2034688, 4064768, 3671808, 3146496, 3146496, 3146496, 1574400, 1576448, 924672, 258048, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["9"] = {
-			0, 0, 0, 0, 0, 258048, 473088, 924672, 1838592, 1838592, 1838848, 3936000, 3936000, 3936000, 3936000, 3935744, 3935744, 4066304, 4143104, 4059136, 1835008, 1835008, 790016, 921088, 462336, 232448, 129024, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["~"] = {
-			0, 0, 0, 0, 0, 2128896, 3269120, 2031872, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["`"] = {
-			0, 0, 0, 0, 0, 7168, 15360, 30720, 57344, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["!"] = {
-			0, 0, 0, 57344, 122880, 122880, 122880, 122880, 122880, 57344, 57344, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 0, 0, 0, 57344, 122880, 57344, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["@"] = {
-			0, 0, 0, 258048, 1838080, 3146496, 6291840, 12705920, 8796224, 17046624, 20450336, 20450848, 37226016, 37226000, 37226000, 37226000, 37226016, 37228064, 37227552, 20716640, 20330560, 14803072, 384, 58721024, 16256000, 2093056, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["#"] = {
-			0, 0, 0, 0, 4210688, 4210688, 2113536, 2113536, 2105344, 2105344, 1056768, 1052672, 1052672, 1576960, 67108856, 526336, 526336, 264192, 265216, 263168, 67108856, 132096, 131584, 131584, 197120, 66048, 65792, 65792, 33024, 33152, 32896, 0, 0, 0, 0, 0
-		},
-		["$"] = {
-			0, 0, 49152, 258048, 972800, 1625088, 1099264, 1885696, 1885696, 1885696, 50688, 52736, 65024, 523264, 1046528, 2080768, 2080768, 1884160, 1625600, 1625600, 1625600, 1622528, 1623552, 836608, 449536, 258048, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["%"] = {
-			0, 0, 12583872, 6293088, 7879728, 4188208, 1050672, 1574968, 788536, 264248, 395312, 198704, 68656, 99936, 50112, 15745024, 18374656, 35139584, 34344960, 34347008, 67898368, 67896320, 67896832, 34341632, 34341120, 35127680, 18350272, 15728704, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["^"] = {
-			0, 0, 0, 0, 0, 0, 49152, 122880, 473088, 789504, 1574400, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["&"] = {
-			0, 0, 0, 15360, 26112, 17152, 17152, 17152, 17152, 8960, 8960, 5888, 66588416, 14681600, 6295040, 2100992, 1056128, 1055936, 538688, 798816, 290928, 188528, 114800, 33652848, 50577632, 26112448, 16523136, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["*"] = {
-			0, 0, 49152, 49152, 49152, 49152, 1623552, 973824, 258048, 49152, 258048, 973824, 1623552, 49152, 49152, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["("] = {
-			0, 0, 786432, 393216, 196608, 98304, 98304, 49152, 49152, 24576, 24576, 24576, 28672, 12288, 12288, 12288, 12288, 12288, 12288, 12288, 12288, 12288, 12288, 28672, 24576, 24576, 24576, 49152, 49152, 98304, 98304, 196608, 393216, 786432, 0, 0
-		},
-		[")"] = {
-			0, 0, 2048, 6144, 12288, 24576, 24576, 49152, 49152, 98304, 98304, 229376, 229376, 196608, 196608, 196608, 196608, 196608, 196608, 196608, 196608, 196608, 196608, 229376, 229376, 98304, 98304, 49152, 49152, 24576, 24576, 12288, 6144, 2048, 0, 0
-		},
-		["-"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 261120, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["_"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 33554400, 0, 0, 0
-		},
-		["="] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 67108848, 0, 0, 0, 0, 0, 67108848, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["+"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 67108848, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["["] = {
-			0, 0, 507904, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 507904, 0, 0
-		},
-		["]"] = {
-			0, 0, 63488, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 63488, 0, 0
-		},
-		["{"] = {
-			0, 0, 1966080, 491520, 114688, 114688, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 57344, 28672, 15360, 15360, 28672, 57344, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 114688, 114688, 491520, 1966080, 0, 0
-		},
-		["}"] = {
-			0, 0, 7680, 30720, 57344, 57344, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 114688, 229376, 983040, 983040, 229376, 114688, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 49152, 57344, 57344, 30720, 7680, 0, 0
-		},
-		["<"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 25165824, 6291456, 1835008, 458752, 114688, 28672, 3072, 896, 224, 224, 896, 3072, 28672, 114688, 458752, 1835008, 6291456, 25165824, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[">"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 96, 384, 1536, 14336, 57344, 196608, 786432, 3145728, 12582912, 12582912, 3145728, 786432, 229376, 57344, 14336, 1536, 384, 96, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[","] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 49152, 122880, 114688, 65536, 65536, 65536, 32768, 32768, 16384, 0, 0, 0, 0
-		},
-		["."] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 57344, 122880, 57344, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["/"] = {
-			0, 0, 1048576, 1048576, 1572864, 524288, 524288, 786432, 262144, 262144, 131072, 131072, 196608, 65536, 65536, 98304, 32768, 32768, 16384, 16384, 24576, 8192, 8192, 12288, 4096, 4096, 2048, 2048, 3072, 1024, 1024, 1536, 512, 512, 0, 0
-		},
-		["?"] = {
-			0, 0, 0, 520192, 924672, 1836032, 1838592, 1838592, 1838592, 917504, 458752, 196608, 98304, 32768, 49152, 49152, 16384, 16384, 16384, 0, 0, 0, 0, 57344, 122880, 57344, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[":"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 49152, 122880, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 49152, 122880, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[";"] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 57344, 122880, 57344, 0, 0, 0, 0, 0, 0, 0, 57344, 122880, 122880, 65536, 65536, 65536, 32768, 49152, 16384, 0, 0, 0, 0
-		},
-		["\""] = {
-			0, 0, 0, 473088, 473088, 473088, 473088, 473088, 473088, 473088, 399360, 399360, 399360, 135168, 135168, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		["'"] = {
-			0, 0, 0, 49152, 122880, 122880, 57344, 57344, 49152, 49152, 49152, 49152, 49152, 49152, 16384, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-		[" "] = {
-			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
-		},
-	},
-}
-
-local function rasterizeGlyph(glyph, width, height, baseline)
-	local colors = {}
-	local minX = width
-	local maxX = 1
-	for y = 1, height do
-		local n = glyph[y]
-		for x = 1, width do
-			local b = n % 2
-			if b == 1 then
-				minX = math.min(minX, x)
-				maxX = math.max(maxX, x)
-			end
-			table.insert(colors, b == 1)
-			n = n // 2
-		end
-	end
-
-	return {
-		width = width,
-		height = height,
-		left = minX,
-		right = maxX,
-		baseline = baseline,
-		colors = colors,
-	}
+-- The fonts are binary font files (see engine/font.h) next to their Lua
+-- sources in library/fonts/. The engine maps each file and decodes glyphs the
+-- first time they are drawn.
+
+-- RETURNS the C-Font for the font file `library/fonts/<name>.rmf`, found along
+-- `package.path`.
+local function loadFont(name)
+	local path = assert(package.searchpath("library/fonts/" .. name, (package.path:gsub("%.lua", ".rmf"))))
+	return assert(rm_font.load(path))
 end
 
-local function rasterizeFontData(fontData)
-	local glyphs = {}
-	for k, v in pairs(fontData.glyphs) do
-		glyphs[k] = rasterizeGlyph(v, fontData.width, fontData.height, fontData.baseline)
-	end
-	return {
-		glyphs = glyphs,
-	}
-end
+local CMU16 = {
+	atlas = loadFont("cmu16"),
+	size = 16,
+	kern = 1,
+}
 
-local CMU16 = rasterizeFontData(fontDataCMU16)
-CMU16.size = 16
-CMU16.kern = 1
-CMU16.glyphs[" "].left = 1
-CMU16.glyphs[" "].right = 5
+local CMU32 = {
+	atlas = loadFont("cmu32"),
+	size = 32,
+	kern = 2,
+}
 
-local CMU32 = rasterizeFontData(fontDataCMU32)
-CMU32.size = 32
-CMU32.kern = 2
-CMU32.glyphs[" "].left = 1
-CMU32.glyphs[" "].right = 9
+local BLACK = 0
 
 -- RETURNS the amount to advance x for the next character.
 local function renderCharacter(fb, font, bx, by, character)
-	local z = font.glyphs[character]
-	if not z then
-		return font.size
-	end
-
-	local BLACK = 0
-
-	local width = z.right - z.left + 1
-	for y = 1, z.height do
-		for x = z.left, z.right do
-			local c = z.colors[(y - 1) * z.width + x]
-			if c then 
-				fb:setPixel(bx + x - z.left, by + y - z.baseline, BLACK)
-			end
-		end
-	end
-
-	return width + font.kern
+	return (fb:drawString(font.atlas, bx, by, character, BLACK))
 end
 
 -- RETURNS the amount to advance x to draw a string as though it were 
 -- concatenated to this one.
 local function renderString(fb, font, bx, by, str)
-	local w = 0
-	for i = 1, #str do
-		w = w + renderCharacter(fb, font, bx + w, by, str:sub(i, i))
-	end
-	return w
+	return (fb:drawString(font.atlas, bx, by, str, BLACK))
 end
 
 return {
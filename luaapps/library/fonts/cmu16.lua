@@ -0,0 +1,305 @@
+-- Each character is encoded as 32-bit unsigned integers.
+-- Each integer represents one row in the character. 
+-- The first integer represents the top row.
+-- The text baseline row is indicated.
+-- The least-significant-bit is the leftmost pixel in that row.
+-- `kern` is the space between glyphs, and `missingAdvance` is the space left for
+-- a character without a glyph. `extents` overrides the columns (counting from 1)
+-- which are drawn for a glyph; otherwise, they are the columns with ink.
+-- This raster font is derived from "CMU Serif", which is licensed under the
+-- Open SIL Font license.
+--
+-- This is the source of the binary font file next to it; the engine loads that
+-- file instead. After editing, regenerate it with `tools/fontconvert.lua`.
+return {
+	width = 32,
+	height = 32,
+	baseline = 17,
+	kern = 1,
+	missingAdvance = 16,
+	extents = {
+		-- Spaces have no ink, so are given their width explicitly.
+		[" "] = {1, 5},
+	},
+	glyphs = {
+		["A"] = {
+			0, 0, 0, 0, 0, 0, 98304, 98304, 147456, 147456, 147456, 270336, 516096, 270336, 528384, 1849344, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["B"] = {
+			0, 0, 0, 0, 0, 520192, 532480, 532480, 532480, 532480, 516096, 532480, 532480, 532480, 532480, 520192, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["C"] = {
+			0, 0, 0, 0, 0, 1556480, 1581056, 1052672, 2048, 2048, 2048, 2048, 2048, 1052672, 532480, 507904, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["D"] = {
+			0, 0, 0, 0, 0, 260096, 266240, 528384, 1052672, 1052672, 1052672, 1052672, 1052672, 528384, 266240, 260096, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["E"] = {
+			0, 0, 0, 0, 0, 1044480, 532480, 8192, 8192, 139264, 253952, 139264, 8192, 8192, 532480, 1044480, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["F"] = {
+			0, 0, 0, 0, 0, 1044480, 532480, 8192, 8192, 139264, 253952, 139264, 8192, 8192, 8192, 28672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["G"] = {
+			0, 0, 0, 0, 0, 1556480, 1581056, 1052672, 2048, 2048, 2048, 3672064, 1050624, 1052672, 532480, 507904, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["H"] = {
+			0, 0, 0, 0, 0, 1863680, 532480, 532480, 532480, 532480, 1040384, 532480, 532480, 532480, 532480, 1863680, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["I"] = {
+			0, 0, 0, 0, 0, 114688, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["J"] = {
+			0, 0, 0, 0, 0, 458752, 131072, 131072, 131072, 131072, 131072, 131072, 143360, 139264, 139264, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["K"] = {
+			0, 0, 0, 0, 0, 1849344, 528384, 266240, 135168, 69632, 53248, 77824, 135168, 266240, 528384, 1849344, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["L"] = {
+			0, 0, 0, 0, 0, 28672, 8192, 8192, 8192, 8192, 8192, 8192, 8192, 8192, 532480, 1044480, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["M"] = {
+			0, 0, 0, 0, 0, 6294528, 3151872, 3151872, 2631680, 2631680, 2377728, 2377728, 2263040, 2263040, 2164736, 7347200, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["N"] = {
+			0, 0, 0, 0, 0, 931840, 274432, 282624, 282624, 299008, 299008, 331776, 331776, 397312, 266240, 276480, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["O"] = {
+			0, 0, 0, 0, 0, 245760, 270336, 528384, 1050624, 1050624, 1050624, 1050624, 1050624, 528384, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["P"] = {
+			0, 0, 0, 0, 0, 520192, 532480, 532480, 532480, 532480, 516096, 8192, 8192, 8192, 8192, 28672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["Q"] = {
+			0, 0, 0, 0, 0, 245760, 270336, 528384, 1050624, 1050624, 1050624, 1050624, 1050624, 626688, 401408, 245760, 2359296, 2359296, 1572864, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["R"] = {
+			0, 0, 0, 0, 0, 260096, 266240, 266240, 266240, 266240, 258048, 266240, 266240, 266240, 2363392, 1587200, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["S"] = {
+			0, 0, 0, 0, 0, 376832, 401408, 266240, 4096, 8192, 245760, 262144, 524288, 528384, 274432, 249856, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["T"] = {
+			0, 0, 0, 0, 0, 2093056, 1118208, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["U"] = {
+			0, 0, 0, 0, 0, 1849344, 528384, 528384, 528384, 528384, 528384, 528384, 528384, 528384, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["V"] = {
+			0, 0, 0, 0, 0, 3684352, 1052672, 1052672, 532480, 532480, 278528, 278528, 163840, 163840, 65536, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["W"] = {
+			0, 0, 0, 0, 0, 29478400, 8422400, 8422400, 4261888, 4261888, 2232320, 2297856, 1351680, 1351680, 540672, 540672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["X"] = {
+			0, 0, 0, 0, 0, 931840, 266240, 139264, 81920, 81920, 32768, 81920, 81920, 139264, 266240, 931840, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["Y"] = {
+			0, 0, 0, 0, 0, 1863680, 532480, 278528, 278528, 163840, 163840, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["Z"] = {
+			0, 0, 0, 0, 0, 1040384, 532480, 262144, 262144, 131072, 65536, 32768, 16384, 16384, 532480, 1040384, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["a"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 114688, 139264, 229376, 147456, 139264, 139264, 376832, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["b"] = {
+			0, 0, 0, 0, 0, 12288, 8192, 8192, 8192, 237568, 286720, 532480, 532480, 532480, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["c"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 229376, 278528, 8192, 8192, 8192, 278528, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["d"] = {
+			0, 0, 0, 0, 0, 393216, 262144, 262144, 262144, 376832, 401408, 266240, 266240, 266240, 270336, 770048, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["e"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 229376, 278528, 516096, 8192, 8192, 278528, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["f"] = {
+			0, 0, 0, 0, 0, 458752, 294912, 32768, 32768, 114688, 32768, 32768, 32768, 32768, 32768, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["g"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 393216, 114688, 139264, 139264, 139264, 114688, 8192, 245760, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["h"] = {
+			0, 0, 0, 0, 0, 12288, 8192, 8192, 8192, 237568, 286720, 270336, 270336, 270336, 270336, 946176, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["i"] = {
+			0, 0, 0, 0, 0, 0, 65536, 0, 0, 98304, 65536, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["j"] = {
+			0, 0, 0, 0, 0, 0, 65536, 0, 0, 98304, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 73728, 49152, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["k"] = {
+			0, 0, 0, 0, 0, 12288, 8192, 8192, 8192, 401408, 73728, 57344, 73728, 139264, 270336, 946176, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["l"] = {
+			0, 0, 0, 0, 0, 98304, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["m"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 977920, 1120256, 1116160, 1116160, 1116160, 1116160, 3906560, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["n"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 241664, 286720, 270336, 270336, 270336, 270336, 946176, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["o"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 229376, 278528, 532480, 532480, 532480, 278528, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["p"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 241664, 286720, 532480, 532480, 532480, 286720, 237568, 8192, 8192, 28672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["q"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 901120, 401408, 266240, 266240, 266240, 401408, 376832, 262144, 262144, 917504, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["r"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 221184, 294912, 32768, 32768, 32768, 32768, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["s"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 245760, 139264, 8192, 114688, 131072, 139264, 122880, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["t"] = {
+			0, 0, 0, 0, 0, 0, 0, 32768, 32768, 114688, 32768, 32768, 32768, 32768, 294912, 196608, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["u"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 405504, 270336, 270336, 270336, 270336, 401408, 901120, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["v"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 946176, 270336, 270336, 147456, 147456, 98304, 98304, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["w"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 3913728, 1118208, 1118208, 696320, 696320, 278528, 278528, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["x"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 946176, 147456, 98304, 98304, 147456, 270336, 946176, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["y"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 974848, 278528, 278528, 163840, 163840, 65536, 65536, 65536, 32768, 28672, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["z"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 516096, 270336, 131072, 65536, 32768, 278528, 516096, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["0"] = {
+			0, 0, 0, 0, 0, 245760, 270336, 270336, 270336, 270336, 270336, 270336, 270336, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["1"] = {
+			0, 0, 0, 0, 0, 65536, 114688, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["2"] = {
+			0, 0, 0, 0, 0, 114688, 139264, 266240, 266240, 262144, 131072, 65536, 32768, 16384, 270336, 520192, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["3"] = {
+			0, 0, 0, 0, 0, 114688, 139264, 270336, 262144, 131072, 98304, 131072, 262144, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["4"] = {
+			0, 0, 0, 0, 0, 131072, 196608, 163840, 147456, 147456, 139264, 135168, 520192, 131072, 131072, 458752, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["5"] = {
+			0, 0, 0, 0, 0, 516096, 8192, 8192, 8192, 122880, 131072, 262144, 262144, 266240, 139264, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["6"] = {
+			0, 0, 0, 0, 0, 229376, 278528, 8192, 8192, 237568, 286720, 270336, 270336, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["7"] = {
+			0, 0, 0, 0, 0, 0, 1040384, 270336, 131072, 131072, 65536, 65536, 65536, 65536, 65536, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["8"] = {
+			0, 0, 0, 0, 0, 245760, 270336, 270336, 270336, 147456, 98304, 147456, 270336, 270336, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["9"] = {
+			0, 0, 0, 0, 0, 245760, 270336, 270336, 270336, 270336, 401408, 376832, 262144, 262144, 270336, 245760, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["~"] = {
+			0, 0, 0, 0, 0, 581632, 462848, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["`"] = {
+			0, 0, 0, 0, 0, 0, 16384, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["!"] = {
+			0, 0, 0, 0, 0, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 0, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["@"] = {
+			0, 0, 0, 0, 516096, 528384, 1148928, 2245632, 2368512, 2368512, 2368512, 2368512, 2376704, 755712, 3149824, 1040384, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["#"] = {
+			0, 0, 0, 0, 0, 0, 1114112, 1114112, 557056, 557056, 4192256, 278528, 278528, 4192256, 139264, 139264, 69632, 69632, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["$"] = {
+			0, 0, 0, 0, 65536, 229376, 344064, 598016, 73728, 81920, 229376, 327680, 589824, 598016, 344064, 229376, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["%"] = {
+			0, 0, 0, 1077248, 559104, 559104, 296960, 159744, 131072, 65536, 32768, 1867776, 2244608, 2236416, 2236416, 1839104, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["^"] = {
+			0, 0, 0, 0, 0, 0, 98304, 147456, 270336, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["&"] = {
+			0, 0, 0, 0, 0, 57344, 69632, 69632, 69632, 1875968, 540672, 303104, 331776, 135168, 2428928, 1630208, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["*"] = {
+			0, 0, 0, 0, 32768, 299008, 172032, 114688, 172032, 299008, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["("] = {
+			0, 0, 131072, 65536, 65536, 32768, 32768, 16384, 16384, 16384, 16384, 16384, 16384, 32768, 32768, 65536, 65536, 131072, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		[")"] = {
+			0, 0, 16384, 32768, 32768, 65536, 65536, 131072, 131072, 131072, 131072, 131072, 131072, 65536, 65536, 32768, 32768, 16384, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["-"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["_"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 2095104, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["="] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 1044480, 0, 0, 0, 1044480, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["+"] = {
+			0, 0, 0, 0, 0, 0, 65536, 65536, 65536, 65536, 2093056, 65536, 65536, 65536, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["["] = {
+			0, 0, 229376, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 32768, 229376, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["]"] = {
+			0, 0, 114688, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 65536, 114688, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["{"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["}"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["<"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		[">"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		[","] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65536, 65536, 65536, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["."] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["/"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["?"] = {
+			0, 0, 0, 0, 0, 245760, 270336, 270336, 131072, 131072, 65536, 65536, 0, 0, 0, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		[":"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65536, 0, 0, 0, 0, 65536, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		[";"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 65536, 0, 0, 0, 0, 65536, 65536, 65536, 32768, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["\""] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		["'"] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+		[" "] = {
+			0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0
+		},
+	}
+}
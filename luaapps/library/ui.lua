@@ -1,63 +1,57 @@
-local font = require "library/font"
-
 -- Defines a basic "visual element protocol" for making efficient use of screen
 -- flushes, as well as some basic controls that implement that protocol.
-
+-- Each element is backed by nodes of an engine `rm_scene`, which tracks the
+-- damage of every change and repaints (and flushes) only the damaged tiles.
 
 -- Rectangle :: {left = int, right = int, top = int, bottom = int}
 
--- A VisualElement has several methods:
-
--- :plan(): old []Rectangle, new []Rectangle
--- RETURNS the old and new portions of the screen this element
--- renders on.
--- `old` is the portion of the area that was rendered by the last :plan(), but
--- which is not covered by the new plan.
--- MODIFIES the underlying VisualElement so that subsequent
--- calls to :plan() may return results reflecting the 
--- render.
--- (TODO: Indicate the needed waveform in these render regions)
+-- A VisualElement has a method:
 
--- :render(fb, regions)
--- Renders to the framebuffer ONLY within the given regions.
--- A bounding left/right/top/bottom is also added to the regions list.
--- This should NOT modify the state of the underlying VisualElement.
+-- :attach(scene)
+-- Adds the nodes of the element to the scene, above those already there.
+-- MODIFIES the element so that its setters change those nodes; an element can
+-- only be attached once.
 
+-- Spans are recorded when the engine is run with `--profile <trace.json>`.
 local clockStack = {}
 local function clockOpen(name)
-	-- print(string.rep("\t", #clockStack) .. "< " .. name .. " >")
-	table.insert(clockStack, {name, os.clock()})
+	table.insert(clockStack, {name, rm_profile.begin()})
 end
 
 local function clockClose()
 	local entry = table.remove(clockStack)
-	-- print(string.format("%s</ %s = %.3f >", string.rep("\t", #clockStack), entry[1], os.clock() - entry[2]))
+	rm_profile.finish(entry[1], entry[2])
 end
 
+local WHITE = 2 ^ 16 - 1
+local BLACK = 0
+
 --------------------------------------------------------------------------------
 
+-- An element with a single node, made by the scene method named `_kind` with
+-- the values returned by `:_node()`.
 local VisualElement = {}
 VisualElement.__index = VisualElement
 
-function VisualElement:plan()
-	if self._stale == false then
-		return {}, {}
-	end
+function VisualElement:attach(scene)
+	assert(self._scene == nil, "element is already attached to a scene")
+	self._scene = scene
+	self._id = scene[self._kind](scene, self:_node())
+end
 
-	local new = self:bounds()
-	local old = self._lastPlan or {}
-	self._lastPlan = new
-	self._stale = false
-	return old, new
+-- Updates the node after the element has changed.
+function VisualElement:_changed()
+	if self._scene then
+		self._scene:set(self._id, self:_node())
+	end
 end
 
 --------------------------------------------------------------------------------
 
-local ZERO_RECT = {type = "rect", left = 0, right = 0, top = 0, bottom = 0}
-
--- Implements VisualElement protocol.
 local Box = setmetatable({}, VisualElement)
 Box.__index = Box
+Box._kind = "box"
+
 function Box.new(area, color)
 	assert(type(area.left) == "number")
 	assert(type(area.top) == "number")
@@ -72,34 +66,22 @@ function Box.new(area, color)
 	return setmetatable(instance, Box)
 end
 
-function Box:bounds()
-	return {self._area}
+function Box:_node()
+	return self._area.left, self._area.top, self._area.right, self._area.bottom, self._color
 end
 
 function Box:setArea(area)
 	self._area = area
-	self._stale = true
+	self:_changed()
 end
 
 function Box:setColor(color)
 	if color ~= self._color then
 		self._color = color
-
-		-- The current area must be repainted, but no space is uncovered.
-		self._stale = true
+		self:_changed()
 	end
 end
 
-function Box:render(fb, rect)
-	clockOpen("Box:render")
-	local lowY = math.max(rect.top, self._area.top)
-	local highY = math.min(rect.bottom, self._area.bottom) - 1
-	local lowX = math.max(rect.left, self._area.left)
-	local highX = math.min(rect.right, self._area.right) - 1
-	fb:setRect(lowX, lowY, highX + 1, highY + 1, self._color)
-	clockClose()
-end
-
 --------------------------------------------------------------------------------
 
 local VisualStack = {}
@@ -112,26 +94,10 @@ function VisualStack.new(elements)
 	return setmetatable(instance, VisualStack)
 end
 
-function VisualStack:plan()
-	clockOpen("VisualStack:plan()")
-	local olds = {}
-	local news = {}
-	for _, v in ipairs(self._elements) do
-		local va, vb = v:plan()
-		for i = 1, #va do
-			olds[#olds + 1] = va[i]
-		end
-		for i = 1, #vb do
-			news[#news + 1] = vb[i]
-		end
-	end
-	clockClose()
-	return olds, news
-end
-
-function VisualStack:render(fb, regions)
+-- The elements are stacked in order, so later ones are drawn over earlier ones.
+function VisualStack:attach(scene)
 	for _, v in ipairs(self._elements) do
-		v:render(fb, regions)
+		v:attach(scene)
 	end
 end
 
@@ -179,6 +145,92 @@ function Window:setRect(left, top, right, bottom, color)
 	self._fb:setRect(self._tx + left, self._ty + top, self._tx + right, self._ty + bottom, color)
 end
 
+-- RETURNS the clipping rectangle of this Window, intersected with the given
+-- one, in the coordinates of the underlying FrameBuffer.
+function Window:_clip(left, top, right, bottom)
+	local clipLeft, clipTop = self._tx, self._ty
+	local clipRight, clipBottom = self._tx + self._width, self._ty + self._height
+	if left then
+		clipLeft = math.max(clipLeft, left - self._originLeft + self._tx)
+		clipTop = math.max(clipTop, top - self._originTop + self._ty)
+		clipRight = math.min(clipRight, right - self._originLeft + self._tx)
+		clipBottom = math.min(clipBottom, bottom - self._originTop + self._ty)
+	end
+	return clipLeft, clipTop, clipRight, clipBottom
+end
+
+-- RETURNS a dirty rectangle of the underlying FrameBuffer in the coordinates
+-- of this Window.
+function Window:_fromTarget(left, top, right, bottom)
+	if not left then
+		return
+	end
+	local dx = self._originLeft - self._tx
+	local dy = self._originTop - self._ty
+	return left + dx, top + dy, right + dx, bottom + dy
+end
+
+function Window:line(x1, y1, x2, y2, color, width, ...)
+	local dx = self._tx - self._originLeft
+	local dy = self._ty - self._originTop
+	return self:_fromTarget(self._fb:line(x1 + dx, y1 + dy, x2 + dx, y2 + dy, color, width or 1, self:_clip(...)))
+end
+
+function Window:polyline(coordinates, color, width, ...)
+	local dx = self._tx - self._originLeft
+	local dy = self._ty - self._originTop
+	local translated = {}
+	for i = 1, #coordinates, 2 do
+		translated[i] = coordinates[i] + dx
+		translated[i + 1] = coordinates[i + 1] + dy
+	end
+	return self:_fromTarget(self._fb:polyline(translated, color, width or 1, self:_clip(...)))
+end
+
+function Window:fillCircle(cx, cy, radius, color, ...)
+	local dx = self._tx - self._originLeft
+	local dy = self._ty - self._originTop
+	return self:_fromTarget(self._fb:fillCircle(cx + dx, cy + dy, radius, color, self:_clip(...)))
+end
+
+function Window:circle(cx, cy, radius, color, width, ...)
+	local dx = self._tx - self._originLeft
+	local dy = self._ty - self._originTop
+	return self:_fromTarget(self._fb:circle(cx + dx, cy + dy, radius, color, width or 1, self:_clip(...)))
+end
+
+function Window:rectangle(left, top, right, bottom, color, width, ...)
+	local dx = self._tx - self._originLeft
+	local dy = self._ty - self._originTop
+	return self:_fromTarget(self._fb:rectangle(left + dx, top + dy, right + dx, bottom + dy, color, width or 1, self:_clip(...)))
+end
+
+function Window:drawString(font, x, y, text, color, ...)
+	local dx = self._tx - self._originLeft
+	local dy = self._ty - self._originTop
+	local advance, left, top, right, bottom = self._fb:drawString(font, x + dx, y + dy, text, color, self:_clip(...))
+	return advance, self:_fromTarget(left, top, right, bottom)
+end
+
+-- `source` is `rm_fb`, `rm_sb`, or a surface, in its own coordinates.
+function Window:blit(source, left, top, right, bottom, x, y, mask, ...)
+	local dx = self._tx - self._originLeft
+	local dy = self._ty - self._originTop
+	return self:_fromTarget(self._fb:blit(source, left, top, right, bottom, x + dx, y + dy, mask, self:_clip(...)))
+end
+
+function Window:copyRect(left, top, right, bottom, x, y, ...)
+	local dx = self._tx - self._originLeft
+	local dy = self._ty - self._originTop
+	return self:_fromTarget(self._fb:copyRect(left + dx, top + dy, right + dx, bottom + dy, x + dx, y + dy, self:_clip(...)))
+end
+
+function Window:stamp(mask, x, y, color, ...)
+	local dx = self._tx - self._originLeft
+	local dy = self._ty - self._originTop
+	return self:_fromTarget(self._fb:stamp(mask, x + dx, y + dy, color, self:_clip(...)))
+end
+
 function Window:flush(x1, y1, x2, y2, mode)
 	x1 = x1 - self._originLeft
 	x2 = x2 - self._originLeft
@@ -204,8 +256,10 @@ end
 
 --------------------------------------------------------------------------------
 
-local TextBox = {}
+-- Draws `text` with its baseline at `baseline`, clipped to `rect`.
+local TextBox = setmetatable({}, VisualElement)
 TextBox.__index = TextBox
+TextBox._kind = "text"
 
 function TextBox.new(font, rect, text, baseline)
 	local instance = {
@@ -213,43 +267,28 @@ function TextBox.new(font, rect, text, baseline)
 		_rect = rect,
 		_text = text,
 		_baseline = baseline,
-
-		_lastPlan = {},
-		_stale = true,
 	}
 
 	return setmetatable(instance, TextBox)
 end
 
-function TextBox:plan()
-	if not self._stale then
-		return {}, {}
-	end
-
-	local old = self._lastPlan
-	local new = {self._rect}
-
-	self._lastPlan = new
-	self._stale = false
-	return old, new
+function TextBox:_node()
+	local rect = self._rect
+	return self._font.atlas, rect.left, self._baseline, self._text, BLACK, rect.left, rect.top, rect.right, rect.bottom
 end
 
-function TextBox:render(fb, regions)
-	local left = math.max(region.left, self._rect.left)
-	local top = math.max(region.top, self._rect.top)
-	local right = math.min(region.right, self._rect.right)
-	local bottom = math.min(region.bottom, self._rect.bottom)
-	local filter = {left = left, top = top, right = right, bottom = bottom}
-	local window = Window.new(fb, filter)
-	local bx = self._rect.left
-	local by = self._baseline
-	font.renderString(window, self._font, bx - filter.left, by - filter.top, self._text)
+function TextBox:setText(text)
+	if text ~= self._text then
+		self._text = text
+		self:_changed()
+	end
 end
 
 --------------------------------------------------------------------------------
 
-local Line = {}
+local Line = setmetatable({}, VisualElement)
 Line.__index = Line
+Line._kind = "line"
 
 function Line.new(x1, y1, x2, y2)
 	local instance = {
@@ -257,30 +296,12 @@ function Line.new(x1, y1, x2, y2)
 		_y1 = y1,
 		_x2 = x2,
 		_y2 = y2,
-
-		_stale = true,
-		_lastPlan = {},
 	}
 	return setmetatable(instance, Line)
 end
 
-function Line:plan()
-	if not self._stale then
-		return {}, {}
-	end
-
-	local old = self._lastPlan
-	local new = {
-		{
-			left = math.min(self._x1, self._x2) - 1,
-			top = math.min(self._y1, self._y2) - 1,
-			right = math.max(self._x1, self._x2) + 1,
-			bottom = math.max(self._y1, self._y2) + 1,
-		},
-	}
-	self._lastPlan = new
-	self._stale = false
-	return old, new
+function Line:_node()
+	return self._x1, self._y1, self._x2, self._y2, BLACK
 end
 
 function Line:set(x1, y1, x2, y2)
@@ -288,77 +309,60 @@ function Line:set(x1, y1, x2, y2)
 	self._y1 = y1
 	self._x2 = x2
 	self._y2 = y2
-	self._stale = true
+	self:_changed()
 end
 
 local function renderLine(fb, x1, y1, x2, y2, color)
-	if x1 == x2 and y1 == y2 then
-		fb:setPixel(x1, y1)
-		return
-	end
-	
-	if math.abs(y1 - y2) >= math.abs(x1 - x2) then
-		for y = math.min(y1, y2), math.max(y1, y2) do
-			local p = (y - y1) / (y2 - y1)
-			local tx = p * x2 + (1 - p) * x1
-			local x = math.floor(tx + 0.5)
-			fb:setPixel(x, y, 0)
-		end
-	else
-		for x = math.min(x1, x2), math.max(x1, x2) do
-			local p = (x - x1) / (x2 - x1)
-			local ty = p * y2 + (1 - p) * y1
-			local y = math.floor(ty + 0.5)
-			fb:setPixel(x, y, 0)
-		end
-	end
+	fb:line(x1, y1, x2, y2, color)
 end
 
-function Line:render(fb, regions)
-	clockOpen("Line:render()")
-	renderLine(fb, self._x1, self._y1, self._x2, self._y2, 0)
-	clockClose("Line:render()")
+--------------------------------------------------------------------------------
+
+-- Draws a surface (see `rm_surface`) with its top left at (x, y). When `mask`
+-- is given, only the pixels where it is nonzero are drawn.
+local Image = setmetatable({}, VisualElement)
+Image.__index = Image
+Image._kind = "image"
+
+function Image.new(surface, x, y, mask)
+	local instance = {
+		_surface = surface,
+		_x = x,
+		_y = y,
+		_mask = mask,
+	}
+	return setmetatable(instance, Image)
 end
 
---------------------------------------------------------------------------------
+function Image:_node()
+	return self._surface, self._x, self._y, self._mask
+end
 
-local function renderFrame(fb, element)
-	clockOpen("renderFrame")
+function Image:setPosition(x, y)
+	self._x = x
+	self._y = y
+	self:_changed()
+end
 
-	local olds, news = element:plan()
+--------------------------------------------------------------------------------
 
-	if #olds == 0 and #news == 0 then
-		clockClose()
-		return
-	end
-	local begin = os.clock()
-
-	local width, height = fb:size()
-	local regions = {left = width, right = 0, top = height, bottom = 0}
-	for _, r in ipairs(olds) do
-		regions.left = math.min(regions.left, r.left)
-		regions.top = math.min(regions.top, r.top)
-		regions.right = math.max(regions.right, r.right)
-		regions.bottom = math.max(regions.bottom, r.bottom)
-		table.insert(regions, r)
-	end
-	for _, r in ipairs(news) do
-		regions.left = math.min(regions.left, r.left)
-		regions.top = math.min(regions.top, r.top)
-		regions.right = math.max(regions.right, r.right)
-		regions.bottom = math.max(regions.bottom, r.bottom)
-		table.insert(regions, r)
-	end
+-- The scene each element passed to `renderFrame` is attached to.
+local frameScenes = setmetatable({}, {__mode = "k"})
 
-	element:render(fb, regions)
+-- Repaints and flushes whatever has changed about `element` since the last
+-- frame; the first frame attaches it to a scene the size of `fb` over a white
+-- background, and paints the whole of it.
+local function renderFrame(fb, element)
+	clockOpen("renderFrame")
 
-	for _, region in ipairs(regions) do
-		local left = math.max(0, region.left)
-		local right = math.min(width, region.right)
-		local top = math.max(0, region.top)
-		local bottom = math.min(height, region.bottom)
-		fb:flush(left, top, right, bottom, 1)
+	local scene = frameScenes[element]
+	if not scene then
+		local width, height = fb:size()
+		scene = rm_scene.new(width, height, WHITE)
+		element:attach(scene)
+		frameScenes[element] = scene
 	end
+	scene:render(fb, 1)
 
 	clockClose()
 end
@@ -367,6 +371,7 @@ return {
 	VisualStack = VisualStack,
 	Box = Box,
 	TextBox = TextBox,
+	Image = Image,
 	Window = Window,
 	Line = Line,
 	renderFrame = renderFrame,
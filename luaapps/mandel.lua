@@ -8,6 +8,11 @@ setmetatable(_G, {
 
 local width, height = rm_fb:size()
 
+-- The kernel runs on every core, each with its own Lua state, so it can only
+-- see the values passed to it.
+local KERNEL = [[
+local width, height, scale = ...
+
 local function mandel(a, b)
 	local x = 0
 	local y = 0
@@ -26,23 +31,20 @@ local function mandel(a, b)
 	return true
 end
 
+return function(left, top, size)
+	local u = (left + 0.5 * size - width / 2) * scale
+	local v = (top + 0.5 * size - height / 2) * scale
+	return mandel(v - 0.5, u) and 0 or 2 ^ 16 - 1
+end
+]]
+
 local scale = 4 * 0.5 / math.min(width, height)
 
+-- Refine progressively, from 32x32 squares down to single pixels.
 local chunk = 32
 while chunk >= 1 do
-	for x = 0, width, chunk do
-		for y = 0, height, chunk do
-			local u = x + 0.5 * chunk - width / 2
-			local v = y + 0.5 * chunk - height / 2
-			u = u * scale
-			v = v * scale
-			local color = mandel(v - 0.5, u) and 0 or 2 ^ 16 - 1
-			rm_fb:setRect(x, y, x + chunk, y + chunk, color)
-			-- print(x, y, "=>", color, "at", chunk .. "x" .. chunk)
-		end
-		rm_fb:flush(x, 0, math.min(width, x + chunk), height, 1)
-	end
-	chunk = chunk / 2
+	rm_tiles:render(rm_fb, KERNEL, {width, height, scale}, chunk, 1)
+	chunk = chunk // 2
 end
 
 print("Done!")
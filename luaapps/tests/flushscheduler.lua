@@ -0,0 +1,28 @@
+-- Checks that waiting for a queued update which was merged over an update in
+-- flight blocks on the display, rather than spinning until that update's
+-- estimated completion. Run it headless from `luaapps/`:
+--   ../engine/built/engine --headless tests/flushscheduler.lua
+
+local WAVEFORM_FAST = 1
+local WAVEFORM_FULL = 0
+local WAVEFORM_GRAY = 2
+
+-- A is in flight, and Q is queued behind it.
+local a = rm_fb:flushAsync(0, 0, 100, 100, WAVEFORM_GRAY)
+local q = rm_fb:flushAsync(50, 50, 150, 150, WAVEFORM_FAST)
+assert(not rm_fb:isComplete(q), "Q should be queued behind A")
+
+-- B is sent beside them, and C (which overlaps both Q and B) is merged into Q,
+-- growing Q over B.
+rm_fb:flushAsync(300, 0, 400, 100, WAVEFORM_FULL)
+local c = rm_fb:flushAsync(140, 50, 310, 100, WAVEFORM_FAST)
+assert(c == q, "C should be merged into Q")
+
+-- Once A retires, Q is blocked only by B, which is after it.
+rm_fb:wait(a)
+
+local began = os.clock()
+rm_fb:wait(q)
+local busy = os.clock() - began
+assert(busy < 0.1, string.format("waiting for Q kept the CPU busy for %.2f s", busy))
+print("ok")
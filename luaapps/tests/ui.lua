@@ -0,0 +1,45 @@
+-- Checks that the elements of library/ui repaint what they uncover and clip
+-- text to its box, rendering into a surface. Run it headless from `luaapps/`:
+--   ../engine/built/engine --headless tests/ui.lua
+
+local font = require "library/font"
+local ui = require "library/ui"
+
+local WHITE = 2 ^ 16 - 1
+local BLACK = 0
+local GRAY = 0x8410
+
+local target = rm_surface.new(200, 100)
+
+local box = ui.Box.new({left = 10, top = 10, right = 30, bottom = 30}, GRAY)
+local line = ui.Line.new(0, 50, 199, 50)
+local text = ui.TextBox.new(font.CMU32, {left = 100, top = 0, right = 110, bottom = 40}, "MMMM", 30)
+local stack = ui.VisualStack.new({box, line, text})
+
+ui.renderFrame(target, stack)
+assert(target:getPixel(20, 20) == GRAY, "the box should be drawn")
+assert(target:getPixel(60, 50) == BLACK, "the line should be drawn")
+assert(target:getPixel(60, 60) == WHITE, "the background should be white")
+
+local inked = false
+for y = 0, 99 do
+	for x = 0, 199 do
+		if target:getPixel(x, y) == BLACK and y ~= 50 then
+			assert(100 <= x and x < 110 and y < 40, string.format("text drawn outside its box at (%d, %d)", x, y))
+			inked = true
+		end
+	end
+end
+assert(inked, "the text should be drawn")
+
+-- Moving the box uncovers its old area, which is repainted with the background.
+box:setArea({left = 150, top = 60, right = 170, bottom = 80})
+ui.renderFrame(target, stack)
+assert(target:getPixel(20, 20) == WHITE, "the old area of the box should be repainted")
+assert(target:getPixel(160, 70) == GRAY, "the box should be drawn in its new area")
+
+line:set(0, 90, 199, 90)
+ui.renderFrame(target, stack)
+assert(target:getPixel(60, 50) == WHITE, "the old line should be repainted")
+assert(target:getPixel(60, 90) == BLACK, "the line should be drawn in its new place")
+print("ok")
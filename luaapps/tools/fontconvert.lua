@@ -0,0 +1,97 @@
+-- Converts a Lua font table (like library/fonts/cmu16.lua) into the binary font
+-- format which the engine's `rm_font.load` maps. The format is described in
+-- engine/font.h.
+--
+-- usage: lua fontconvert.lua <font.lua> <font.rmf>
+--
+-- This needs only the standard Lua 5.3 libraries, so it can be run with the
+-- engine or with any Lua 5.3 interpreter.
+
+local input, output = ...
+if not input or not output then
+	io.stderr:write("usage: lua fontconvert.lua <font.lua> <font.rmf>\n")
+	os.exit(1)
+end
+
+local font = dofile(input)
+assert(font.width <= 32, "glyphs must be at most 32 pixels wide")
+assert(font.height <= 255, "glyphs must be at most 255 pixels high")
+
+-- RETURNS the columns `left` to `right` (counting from 1) which have ink.
+local function inkExtent(rows)
+	local ink = 0
+	for y = 1, font.height do
+		ink = ink | rows[y]
+	end
+	ink = ink & ((1 << font.width) - 1)
+	if ink == 0 then
+		return 1, 0
+	end
+
+	local left, right = 1, 0
+	for x = 1, font.width do
+		if ink & (1 << (x - 1)) ~= 0 then
+			if right == 0 then
+				left = x
+			end
+			right = x
+		end
+	end
+	return left, right
+end
+
+local characters = {}
+for character in pairs(font.glyphs) do
+	assert(#character == 1, "glyph keys must be single characters")
+	table.insert(characters, character)
+end
+table.sort(characters)
+
+local kerning = {}
+for pair, adjustment in pairs(font.kerning or {}) do
+	assert(#pair == 2, "kerning keys must be pairs of characters")
+	table.insert(kerning, {pair = pair, adjustment = adjustment})
+end
+table.sort(kerning, function(a, b)
+	return a.pair < b.pair
+end)
+
+local HEADER_BYTES = 16
+local GLYPH_BYTES = 8
+local KERNING_BYTES = 4
+
+local records = {}
+local bitmaps = {}
+local offset = HEADER_BYTES + #characters * GLYPH_BYTES + #kerning * KERNING_BYTES
+for _, character in ipairs(characters) do
+	local rows = font.glyphs[character]
+	local left, right
+	if font.extents and font.extents[character] then
+		left, right = table.unpack(font.extents[character])
+	else
+		left, right = inkExtent(rows)
+	end
+	local width = right - left + 1
+	local rowBytes = (width + 7) // 8
+
+	table.insert(records, string.pack("<BBBBI4", character:byte(), left - 1, width, 0, offset))
+	for y = 1, font.height do
+		local row = (rows[y] >> (left - 1)) & ((1 << width) - 1)
+		for b = 0, rowBytes - 1 do
+			table.insert(bitmaps, string.char((row >> (8 * b)) & 0xff))
+		end
+	end
+	offset = offset + font.height * rowBytes
+end
+
+local out = assert(io.open(output, "wb"))
+out:write("RMF1")
+out:write(string.pack("<BBbBi2I2I2I2", font.height, font.baseline, font.kern, 0, font.missingAdvance, #characters, #kerning, 0))
+out:write(table.concat(records))
+for _, k in ipairs(kerning) do
+	out:write(string.pack("<BBbB", k.pair:byte(1), k.pair:byte(2), k.adjustment, 0))
+end
+out:write(table.concat(bitmaps))
+out:close()
+
+print(string.format("%s: %d glyphs, %d kerning pairs, %d bytes", output, #characters, #kerning, offset))
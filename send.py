@@ -8,3 +8,10 @@ for lua_file in glob.glob("luaapps/**/*.lua", recursive=True):
 
 subprocess.run(["scp", "engine/built/engine",
                 "root@remarkable:/home/root/engine"])
+
+# Bytecode depends on the interpreter's build, so the engine on the reMarkable
+# precompiles the apps after they are copied (which also changes their
+# modification times, making any older caches stale).
+subprocess.run(["ssh", "root@remarkable",
+                "cd /home/root && ./engine --compile "
+                + " ".join(glob.glob("luaapps/**/*.lua", recursive=True))])